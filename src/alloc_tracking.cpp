@@ -0,0 +1,194 @@
+/*
+ * Mini-projet 3 : heap allocation tracking
+ */
+#include "alloc_tracking.hpp"
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    // plain data, so reading them never allocates
+    thread_local int trackingDepth = 0;
+    thread_local AllocationCounters threadCounters = {0, 0, 0};
+
+    void *allocate(std::size_t size)
+    {
+        if (trackingDepth > 0)
+        {
+            threadCounters.allocations++;
+            threadCounters.bytes += size;
+        }
+        return std::malloc(size == 0 ? 1 : size);
+    }
+
+    void *allocate_or_throw(std::size_t size)
+    {
+        void *memory = allocate(size);
+        if (!memory)
+        {
+            throw std::bad_alloc();
+        }
+        return memory;
+    }
+
+    void release(void *memory)
+    {
+        if (memory)
+        {
+            if (trackingDepth > 0)
+            {
+                threadCounters.deallocations++;
+            }
+            std::free(memory);
+        }
+    }
+}
+
+AllocationScope::AllocationScope() : start(threadCounters)
+{
+    trackingDepth++;
+}
+
+AllocationScope::~AllocationScope()
+{
+    trackingDepth--;
+}
+
+AllocationCounters AllocationScope::counters() const
+{
+    return {threadCounters.allocations - start.allocations,
+            threadCounters.deallocations - start.deallocations,
+            threadCounters.bytes - start.bytes};
+}
+
+//==================================================================
+//                  GLOBAL OPERATOR REPLACEMENTS
+//==================================================================
+
+void *operator new(std::size_t size)
+{
+    return allocate_or_throw(size);
+}
+
+void *operator new[](std::size_t size)
+{
+    return allocate_or_throw(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    return allocate(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    return allocate(size);
+}
+
+void operator delete(void *memory) noexcept
+{
+    release(memory);
+}
+
+void operator delete[](void *memory) noexcept
+{
+    release(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept
+{
+    release(memory);
+}
+
+void operator delete[](void *memory, std::size_t) noexcept
+{
+    release(memory);
+}
+
+void operator delete(void *memory, const std::nothrow_t &) noexcept
+{
+    release(memory);
+}
+
+void operator delete[](void *memory, const std::nothrow_t &) noexcept
+{
+    release(memory);
+}
+
+#ifdef __cpp_aligned_new
+namespace
+{
+    void *allocate_aligned(std::size_t size, std::align_val_t alignment)
+    {
+        if (trackingDepth > 0)
+        {
+            threadCounters.allocations++;
+            threadCounters.bytes += size;
+        }
+        void *memory = nullptr;
+        size_t bytes = size == 0 ? 1 : size;
+        size_t align = static_cast<size_t>(alignment) < sizeof(void *) ? sizeof(void *) : static_cast<size_t>(alignment);
+        return posix_memalign(&memory, align, bytes) == 0 ? memory : nullptr;
+    }
+
+    void *allocate_aligned_or_throw(std::size_t size, std::align_val_t alignment)
+    {
+        void *memory = allocate_aligned(size, alignment);
+        if (!memory)
+        {
+            throw std::bad_alloc();
+        }
+        return memory;
+    }
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment)
+{
+    return allocate_aligned_or_throw(size, alignment);
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return allocate_aligned_or_throw(size, alignment);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return allocate_aligned(size, alignment);
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return allocate_aligned(size, alignment);
+}
+
+void operator delete(void *memory, std::align_val_t) noexcept
+{
+    release(memory);
+}
+
+void operator delete[](void *memory, std::align_val_t) noexcept
+{
+    release(memory);
+}
+
+void operator delete(void *memory, std::size_t, std::align_val_t) noexcept
+{
+    release(memory);
+}
+
+void operator delete[](void *memory, std::size_t, std::align_val_t) noexcept
+{
+    release(memory);
+}
+
+void operator delete(void *memory, std::align_val_t, const std::nothrow_t &) noexcept
+{
+    release(memory);
+}
+
+void operator delete[](void *memory, std::align_val_t, const std::nothrow_t &) noexcept
+{
+    release(memory);
+}
+#endif
@@ -0,0 +1,35 @@
+/*
+ * Mini-projet 3 : heap allocation tracking
+ */
+#pragma once
+#include <cstdint>
+
+/*-----------------  TYPES AND DATA STRUCTURES    ------------*/
+
+struct AllocationCounters
+{
+    uint64_t allocations;
+    uint64_t deallocations;
+    uint64_t bytes; // requested by the allocations
+};
+
+/*!
+ * Counts the operator new / delete calls of the current thread while alive.
+ * The global operators are replaced in alloc_tracking.cpp, but they only
+ * count on threads inside a scope, so the rest of the program pays one
+ * thread-local test per allocation. Scopes nest.
+ */
+class AllocationScope
+{
+public:
+    AllocationScope();
+    ~AllocationScope();
+    AllocationScope(const AllocationScope &) = delete;
+    AllocationScope &operator=(const AllocationScope &) = delete;
+
+    // counts since this scope was opened
+    AllocationCounters counters() const;
+
+private:
+    AllocationCounters start;
+};
@@ -0,0 +1,334 @@
+/*
+ * Mini-projet 3 : deadline-bounded fastest path queries
+ */
+#include "anytime.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+#include "kinetics.hpp"
+
+namespace
+{
+    // Euler steps between two looks at the clock and the cancellation token
+    const size_t CHECK_INTERVAL = 4096;
+
+    class BudgetWatch
+    {
+    public:
+        BudgetWatch(const QueryBudget &budget) : budget(budget), start(std::chrono::steady_clock::now()), iterations(0) {}
+
+        // STOP_COMPLETED while the query may go on
+        StopReason check() const
+        {
+            if (budget.cancellation && budget.cancellation->cancelled())
+            {
+                return STOP_CANCELLED;
+            }
+            if (budget.max_total_iterations && iterations >= budget.max_total_iterations)
+            {
+                return STOP_ITERATION_BUDGET;
+            }
+            if (std::chrono::steady_clock::now() >= budget.deadline)
+            {
+                return STOP_DEADLINE;
+            }
+            return STOP_COMPLETED;
+        }
+
+        // steps the next solve chunk may take
+        size_t allowance(size_t done) const
+        {
+            size_t steps = std::min(CHECK_INTERVAL, budget.max_path_iterations - done);
+            if (budget.max_total_iterations)
+            {
+                steps = (size_t)std::min<uint64_t>(steps, budget.max_total_iterations - iterations);
+            }
+            return steps;
+        }
+
+        double seconds() const
+        {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        const QueryBudget &budget;
+        std::chrono::steady_clock::time_point start;
+        uint64_t iterations;
+    };
+
+    struct Evaluator
+    {
+        CompiledPath compiled;
+        PathState state, scratch;
+    };
+
+    enum Outcome
+    {
+        PATH_CONVERGED,
+        PATH_UNCONVERGED,
+        PATH_INTERRUPTED
+    };
+
+    // steady state of evaluator.compiled under the budget, rate set if converged
+    Outcome evaluate(Evaluator &evaluator, const Concentrations &initial_concentrations, double dt, BudgetWatch &watch,
+                     StopReason &stop, double &rate)
+    {
+        initial_path_state(evaluator.compiled, initial_concentrations, evaluator.state);
+        size_t done = 0;
+        bool converged = false;
+        while (!converged && done < watch.budget.max_path_iterations)
+        {
+            stop = watch.check();
+            if (stop != STOP_COMPLETED)
+            {
+                return PATH_INTERRUPTED;
+            }
+            size_t steps = solve_ss_state_bounded(evaluator.compiled, evaluator.state, evaluator.scratch, dt,
+                                                  watch.allowance(done), watch.budget.zero_concentration, converged);
+            done += steps;
+            watch.iterations += steps;
+        }
+        if (!converged)
+        {
+            return PATH_UNCONVERGED;
+        }
+        rate = compute_path_rate(evaluator.compiled, evaluator.state);
+        return PATH_CONVERGED;
+    }
+
+    // winner so far, equal rates settled by rank
+    struct Best
+    {
+        double rate = INT_MIN;
+        uint64_t rank = UINT64_MAX;
+        Path path;
+
+        void offer(double candidateRate, uint64_t candidateRank, const Path &candidate)
+        {
+            if (candidateRate > rate || (candidateRate == rate && candidateRank < rank))
+            {
+                rate = candidateRate;
+                rank = candidateRank;
+                path = candidate;
+            }
+        }
+    };
+
+    AnytimeResult make_result(const Best &best, AnytimeStats stats, double openBound, const BudgetWatch &watch)
+    {
+        stats.iterations = watch.iterations;
+        stats.seconds = watch.seconds();
+        // rates stay strictly below their V_plus bound
+        return {best.path, best.rate, openBound <= best.rate, stats};
+    }
+}
+
+QueryBudget budget_for(std::chrono::steady_clock::duration timeout)
+{
+    QueryBudget budget;
+    budget.deadline = std::chrono::steady_clock::now() + timeout;
+    return budget;
+}
+
+std::string to_string(StopReason reason)
+{
+    switch (reason)
+    {
+    case STOP_COMPLETED:
+        return "completed";
+    case STOP_DEADLINE:
+        return "deadline";
+    case STOP_ITERATION_BUDGET:
+        return "iteration budget";
+    case STOP_CANCELLED:
+        return "cancelled";
+    }
+    return "";
+}
+
+AnytimeResult find_fastest_path_anytime(const Network &network, const ShortestPathDag &dag, const Concentrations &initial_concentrations,
+                                        double dt, const QueryBudget &budget)
+{
+    BudgetWatch watch(budget);
+    AnytimeStats stats = {count_paths(dag), 0, 0, 0, 0, 0.0, STOP_COMPLETED};
+    Best best;
+    if (dag.nodes.empty())
+    {
+        return make_result(best, stats, -DBL_MAX, watch);
+    }
+    size_t length = path_length(dag);
+    size_t size = dag.nodes.size();
+
+    // same bounds as find_fastest_path on a DAG
+    std::vector<double> bound(dag.edges.size());
+    for (size_t e = 0; e < dag.edges.size(); ++e)
+    {
+        bound[e] = network.reactions[dag.edges[e].reaction].V_plus;
+    }
+    std::vector<double> widest(size, DBL_MAX);
+    for (size_t v = 1; v < size; ++v)
+    {
+        widest[v] = -DBL_MAX;
+        for (size_t e = dag.parent_start[v]; e < dag.parent_start[v + 1]; ++e)
+        {
+            widest[v] = std::max(widest[v], std::min(bound[e], widest[dag.edges[e].parent]));
+        }
+    }
+    // per node: parent edges by decreasing bound, and the rank offset each edge adds
+    std::vector<size_t> visitOrder(dag.edges.size());
+    std::vector<uint64_t> rankOffset(dag.edges.size());
+    for (size_t v = 0; v < size; ++v)
+    {
+        uint64_t offset = 0;
+        for (size_t e = dag.parent_start[v]; e < dag.parent_start[v + 1]; ++e)
+        {
+            visitOrder[e] = e;
+            rankOffset[e] = offset;
+            offset += dag.paths_from_source[dag.edges[e].parent];
+        }
+        auto higherBound = [&](size_t a, size_t b)
+        {
+            return std::min(bound[a], widest[dag.edges[a].parent]) > std::min(bound[b], widest[dag.edges[b].parent]);
+        };
+        std::stable_sort(visitOrder.begin() + dag.parent_start[v], visitOrder.begin() + dag.parent_start[v + 1], higherBound);
+    }
+
+    Evaluator evaluator;
+    Path current(length);
+    std::vector<size_t> stackNode(length + 1), stackNext(length + 1);
+    std::vector<double> bottleneck(length + 1);
+    std::vector<uint64_t> rank(length + 1);
+    double openBound = -DBL_MAX; // best bound among paths given up
+    long depth = 0;
+    stackNode[0] = size - 1;
+    stackNext[0] = dag.parent_start[size - 1];
+    bottleneck[0] = DBL_MAX;
+    rank[0] = 0;
+    while (depth >= 0)
+    {
+        size_t v = stackNode[depth];
+        if ((size_t)depth == length)
+        {
+            compile_path(network, current.data(), length, evaluator.compiled);
+            double pathRate = 0;
+            Outcome outcome = evaluate(evaluator, initial_concentrations, dt, watch, stats.stop, pathRate);
+            if (outcome == PATH_INTERRUPTED)
+            {
+                break;
+            }
+            if (outcome == PATH_UNCONVERGED)
+            {
+                stats.unconverged++;
+                openBound = std::max(openBound, bottleneck[depth]);
+            }
+            else
+            {
+                stats.evaluated++;
+                best.offer(pathRate, rank[depth], current);
+            }
+            depth--;
+        }
+        else if (stackNext[depth] < dag.parent_start[v + 1])
+        {
+            size_t e = visitOrder[stackNext[depth]++];
+            const DagEdge &edge = dag.edges[e];
+            double reachable = std::min(bottleneck[depth], std::min(bound[e], widest[edge.parent]));
+            if (reachable <= best.rate)
+            {
+                // siblings come by decreasing bound, none of them can win either
+                for (size_t i = stackNext[depth] - 1; i < dag.parent_start[v + 1]; ++i)
+                {
+                    stats.pruned += dag.paths_from_source[dag.edges[visitOrder[i]].parent];
+                }
+                stackNext[depth] = dag.parent_start[v + 1];
+                continue;
+            }
+            current[length - 1 - depth] = edge.reaction;
+            depth++;
+            stackNode[depth] = edge.parent;
+            stackNext[depth] = dag.parent_start[edge.parent];
+            bottleneck[depth] = std::min(bottleneck[depth - 1], bound[e]);
+            rank[depth] = rank[depth - 1] + rankOffset[e];
+        }
+        else
+        {
+            depth--;
+        }
+    }
+
+    // stopped early: the interrupted path and the unvisited siblings on the stack stay open
+    if (depth >= 0)
+    {
+        openBound = std::max(openBound, bottleneck[depth]);
+        for (long d = 0; d < depth; ++d)
+        {
+            size_t v = stackNode[d];
+            if (stackNext[d] < dag.parent_start[v + 1])
+            {
+                size_t e = visitOrder[stackNext[d]];
+                openBound = std::max(openBound, std::min(bottleneck[d], std::min(bound[e], widest[dag.edges[e].parent])));
+            }
+        }
+    }
+    return make_result(best, stats, openBound, watch);
+}
+
+AnytimeResult find_fastest_path_anytime(const Network &network, const Paths &paths, const Concentrations &initial_concentrations,
+                                        double dt, const QueryBudget &budget)
+{
+    BudgetWatch watch(budget);
+    AnytimeStats stats = {paths.size(), 0, 0, 0, 0, 0.0, STOP_COMPLETED};
+    Best best;
+
+    std::vector<double> bound(paths.size(), DBL_MAX);
+    std::vector<size_t> visitOrder(paths.size());
+    for (size_t i = 0; i < paths.size(); ++i)
+    {
+        for (ReactionID reaction : paths[i])
+        {
+            bound[i] = std::min(bound[i], network.reactions[reaction].V_plus);
+        }
+        visitOrder[i] = i;
+    }
+    auto higherBound = [&](size_t a, size_t b)
+    {
+        return bound[a] > bound[b];
+    };
+    std::stable_sort(visitOrder.begin(), visitOrder.end(), higherBound);
+
+    Evaluator evaluator;
+    double openBound = -DBL_MAX;
+    size_t next = 0;
+    for (; next < visitOrder.size(); ++next)
+    {
+        size_t i = visitOrder[next];
+        if (bound[i] <= best.rate)
+        {
+            stats.pruned += visitOrder.size() - next;
+            next = visitOrder.size();
+            break;
+        }
+        compile_path(network, paths[i].data(), paths[i].size(), evaluator.compiled);
+        double pathRate = 0;
+        Outcome outcome = evaluate(evaluator, initial_concentrations, dt, watch, stats.stop, pathRate);
+        if (outcome == PATH_INTERRUPTED)
+        {
+            break;
+        }
+        if (outcome == PATH_UNCONVERGED)
+        {
+            stats.unconverged++;
+            openBound = std::max(openBound, bound[i]);
+        }
+        else
+        {
+            stats.evaluated++;
+            best.offer(pathRate, i, paths[i]);
+        }
+    }
+    if (next < visitOrder.size())
+    {
+        openBound = std::max(openBound, bound[visitOrder[next]]);
+    }
+    return make_result(best, stats, openBound, watch);
+}
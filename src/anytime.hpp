@@ -0,0 +1,91 @@
+/*
+ * Mini-projet 3 : deadline-bounded fastest path queries
+ */
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include "dag.hpp"
+
+/*-----------------  TYPES AND DATA STRUCTURES    ------------*/
+
+/*!
+ * Set by any thread to stop the queries watching it at their next check
+ * (between paths, and every few thousand Euler steps).
+ */
+class CancellationToken
+{
+public:
+    CancellationToken() : flag(false) {}
+    void cancel() { flag.store(true); }
+    bool cancelled() const { return flag.load(); }
+
+private:
+    std::atomic<bool> flag;
+};
+
+// Limits of one query; the defaults only cap a single steady-state solve
+struct QueryBudget
+{
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    // Euler steps over the whole query, 0 for no limit
+    uint64_t max_total_iterations = 0;
+    // a path not converged after this many steps is given up
+    size_t max_path_iterations = 10000000;
+    // concentrations below this are tested in absolute terms, see checkStable
+    double zero_concentration = 1e-12;
+    const CancellationToken *cancellation = nullptr;
+};
+
+enum StopReason
+{
+    STOP_COMPLETED,
+    STOP_DEADLINE,
+    STOP_ITERATION_BUDGET,
+    STOP_CANCELLED
+};
+
+struct AnytimeStats
+{
+    uint64_t paths;       // candidates of the query
+    uint64_t evaluated;   // steady state reached
+    uint64_t pruned;      // skipped because their rate bound could not beat the best
+    uint64_t unconverged; // given up after max_path_iterations
+    uint64_t iterations;  // Euler steps
+    double seconds;
+    StopReason stop;
+};
+
+struct AnytimeResult
+{
+    Path path;   // best path so far, empty if none was evaluated
+    double rate; // its rate, INT_MIN if none
+    // no path left out could be faster: the search completed, or the best
+    // rate reached the bound of everything not evaluated
+    bool optimal;
+    AnytimeStats stats;
+};
+
+/*!
+ * @brief a budget with a deadline after timeout
+ */
+QueryBudget budget_for(std::chrono::steady_clock::duration timeout);
+
+std::string to_string(StopReason reason);
+
+/*!
+ * @brief find_fastest_path on the DAG, stopping when the budget runs out
+ * Children are visited by decreasing rate bound (V_plus bottleneck), so good
+ * paths come early; equal rates are settled by rank in
+ * find_all_shortest_paths order. Given enough budget the answer is the one
+ * of find_fastest_path.
+ */
+AnytimeResult find_fastest_path_anytime(const Network &network, const ShortestPathDag &dag, const Concentrations &initial_concentrations,
+                                        double dt, const QueryBudget &budget);
+
+/*!
+ * @brief same for an explicit list of paths (rank == index in the list)
+ */
+AnytimeResult find_fastest_path_anytime(const Network &network, const Paths &paths, const Concentrations &initial_concentrations,
+                                        double dt, const QueryBudget &budget);
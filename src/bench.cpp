@@ -0,0 +1,1189 @@
+/*
+ * Mini-projet 3 : benchmarks
+ */
+#include "bench.hpp"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include "alloc_tracking.hpp"
+#include "anytime.hpp"
+#include "compact_bfs.hpp"
+#include "comparative.hpp"
+#include "dag.hpp"
+#include "directed.hpp"
+#include "fuzz.hpp"
+#include "graph_view.hpp"
+#include "kernels.hpp"
+#include "near_shortest.hpp"
+#include "kinetics.hpp"
+#include "ratelaw.hpp"
+#include "oracle.hpp"
+#include "parallel.hpp"
+#include "parallel_bfs.hpp"
+#include "parallel_paths.hpp"
+#include "partition.hpp"
+#include "pathset.hpp"
+#include "random.hpp"
+#include "reorder.hpp"
+#include "screening.hpp"
+#include "shard.hpp"
+#include "stream_io.hpp"
+#include "topk.hpp"
+#include "utils.hpp"
+#ifdef __linux__
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    double seconds_since(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // linear chain 0 -> 1 -> ... -> length with random kinetics in the range of the bundled data
+    Network make_chain_network(size_t length, SplitMix64 &rng)
+    {
+        Network network;
+        for (size_t i = 0; i <= length; ++i)
+        {
+            network.compounds.push_back("C" + std::to_string(i));
+        }
+        for (size_t i = 0; i < length; ++i)
+        {
+            network.reactions.push_back({{(CompoundID)i, (CompoundID)i + 1},
+                                         rng.next_double(1.0, 10.0),
+                                         rng.next_double(1.0, 10.0),
+                                         rng.next_double(0.1, 1.0),
+                                         rng.next_double(0.1, 1.0)});
+        }
+        return network;
+    }
+
+    // metabolic-like graph: each new compound reacts with existing ones chosen by
+    // preferential attachment, so a few cofactor-like hubs get most of the reactions
+    Network make_hub_network(size_t compounds, size_t reactionsPerCompound, SplitMix64 &rng)
+    {
+        Network network;
+        std::vector<CompoundID> endpoints; // one entry per reaction end, sampling it favours hubs
+        for (size_t i = 0; i < compounds; ++i)
+        {
+            network.compounds.push_back("C" + std::to_string(i));
+            for (size_t k = 0; i > 0 && k < reactionsPerCompound; ++k)
+            {
+                CompoundID other = endpoints.empty() || rng.next_double() < 0.2
+                                       ? (CompoundID)(rng.next() % i)
+                                       : endpoints[rng.next() % endpoints.size()];
+                network.reactions.push_back({{other, (CompoundID)i},
+                                             rng.next_double(1.0, 10.0),
+                                             rng.next_double(1.0, 10.0),
+                                             rng.next_double(0.1, 1.0),
+                                             rng.next_double(0.1, 1.0)});
+                endpoints.push_back(other);
+                endpoints.push_back((CompoundID)i);
+            }
+        }
+        network.kinetics = build_kinetic_table(network);
+        return network;
+    }
+
+    // source -> layers of width compounds -> destination, each compound reacting with fanout
+    // compounds of the next layer: the number of shortest paths grows like fanout^layers
+    Network make_layered_network(size_t layers, size_t width, size_t fanout, SplitMix64 &rng)
+    {
+        Network network;
+        size_t size = layers * width + 2;
+        for (size_t i = 0; i < size; ++i)
+        {
+            network.compounds.push_back("C" + std::to_string(i));
+        }
+        auto react = [&](size_t a, size_t b)
+        {
+            network.reactions.push_back({{(CompoundID)a, (CompoundID)b},
+                                         rng.next_double(1.0, 10.0),
+                                         rng.next_double(1.0, 10.0),
+                                         rng.next_double(0.1, 1.0),
+                                         rng.next_double(0.1, 1.0)});
+        };
+        for (size_t j = 0; j < width; ++j)
+        {
+            react(0, 1 + j);
+            react(1 + (layers - 1) * width + j, size - 1);
+        }
+        for (size_t layer = 0; layer + 1 < layers; ++layer)
+        {
+            for (size_t j = 0; j < width; ++j)
+            {
+                for (size_t k = 0; k < fanout; ++k)
+                {
+                    react(1 + layer * width + j, 1 + (layer + 1) * width + rng.next() % width);
+                }
+            }
+        }
+        network.kinetics = build_kinetic_table(network);
+        return network;
+    }
+
+    // hardware cache-miss counter of this thread; reports -1 where perf events are not allowed
+    class CacheMissCounter
+    {
+    public:
+        CacheMissCounter()
+        {
+#ifdef __linux__
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof(attr);
+            attr.config = PERF_COUNT_HW_CACHE_MISSES;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fd = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+        }
+
+        ~CacheMissCounter()
+        {
+#ifdef __linux__
+            if (fd >= 0)
+            {
+                close(fd);
+            }
+#endif
+        }
+
+        bool available() const { return fd >= 0; }
+
+        void start()
+        {
+#ifdef __linux__
+            if (fd >= 0)
+            {
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+#endif
+        }
+
+        long long stop()
+        {
+            long long count = -1;
+#ifdef __linux__
+            if (fd >= 0)
+            {
+                ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+                if (read(fd, &count, sizeof(count)) != sizeof(count))
+                {
+                    count = -1;
+                }
+            }
+#endif
+            return count;
+        }
+
+    private:
+        int fd = -1;
+    };
+
+    // the generators number compounds in creation order, which is already local; files are not
+    Network shuffle_compounds(const Network &network, SplitMix64 &rng)
+    {
+        std::vector<CompoundID> position(network.compounds.size());
+        for (size_t i = 0; i < position.size(); ++i)
+        {
+            position[i] = (CompoundID)i;
+        }
+        for (size_t i = position.size(); i > 1; --i)
+        {
+            std::swap(position[i - 1], position[rng.next() % i]);
+        }
+        Network shuffled;
+        shuffled.compounds.resize(network.compounds.size());
+        for (size_t i = 0; i < position.size(); ++i)
+        {
+            shuffled.compounds[position[i]] = network.compounds[i];
+        }
+        for (Reaction reaction : network.reactions)
+        {
+            reaction.compounds = {position[reaction.compounds.first], position[reaction.compounds.second]};
+            shuffled.reactions.push_back(reaction);
+        }
+        shuffled.kinetics = build_kinetic_table(shuffled);
+        return shuffled;
+    }
+
+    void bench_fixed_length_kernels()
+    {
+        std::cout << " ======= fixed length kernels vs dynamic solvers ======= " << std::endl;
+        std::cout << "N\tmaps_us\tcompiled_us\tfixed_us\tvs_maps\tvs_compiled" << std::endl;
+        const size_t chains = 50;
+        SplitMix64 rng(30);
+        for (size_t n = 1; n <= MAX_FIXED_PATH_LENGTH; ++n)
+        {
+            std::vector<Network> networks;
+            std::vector<Concentrations> starts;
+            Path path;
+            for (size_t i = 0; i < n; ++i)
+            {
+                path.push_back((ReactionID)i);
+            }
+            for (size_t k = 0; k < chains; ++k)
+            {
+                networks.push_back(make_chain_network(n, rng));
+                Concentrations start;
+                for (size_t i = 0; i <= n; ++i)
+                {
+                    start[(CompoundID)i] = rng.next_double();
+                }
+                starts.push_back(start);
+            }
+
+            double reference = 0.0, compiled = 0.0, fixed = 0.0;
+            auto start = std::chrono::steady_clock::now();
+            for (size_t k = 0; k < chains; ++k)
+            {
+                Concentrations ss = compute_ss_concentration(networks[k], path, starts[k], 1e-2);
+                reference += compute_path_rate(networks[k], path, ss);
+            }
+            double mapsTime = seconds_since(start);
+
+            std::vector<CompiledPath> paths;
+            for (size_t k = 0; k < chains; ++k)
+            {
+                paths.push_back(compile_path(networks[k], path));
+            }
+            start = std::chrono::steady_clock::now();
+            for (size_t k = 0; k < chains; ++k)
+            {
+                PathState state = initial_path_state(paths[k], starts[k]);
+                solve_ss_state(paths[k], state, 1e-2);
+                compiled += compute_path_rate(paths[k], state);
+            }
+            double compiledTime = seconds_since(start);
+
+            start = std::chrono::steady_clock::now();
+            for (size_t k = 0; k < chains; ++k)
+            {
+                PathState state = initial_path_state(paths[k], starts[k]);
+                solve_ss_state_fixed(paths[k], state, 1e-2);
+                fixed += compute_path_rate_fixed(paths[k], state);
+            }
+            double fixedTime = seconds_since(start);
+
+            std::cout << n << "\t" << std::fixed << std::setprecision(1)
+                      << mapsTime * 1e6 / chains << "\t" << compiledTime * 1e6 / chains << "\t" << fixedTime * 1e6 / chains << "\t"
+                      << std::setprecision(2) << mapsTime / fixedTime << "x\t" << compiledTime / fixedTime << "x"
+                      << (reference == compiled && compiled == fixed ? "" : "\t(results differ!)") << std::endl;
+            std::cout.unsetf(std::ios::floatfield);
+        }
+    }
+
+    void bench_rate_law_batch()
+    {
+        std::cout << " ======= batched rate law kernels ======= " << std::endl;
+        SplitMix64 rng(31);
+        Network network = make_chain_network(1000, rng);
+        network.kinetics = build_kinetic_table(network);
+        const size_t count = 1 << 20;
+        std::vector<ReactionID> ids(count);
+        std::vector<double> S(count), P(count), rates(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            ids[i] = (ReactionID)(rng.next() % network.reactions.size());
+            S[i] = rng.next_double();
+            P[i] = rng.next_double();
+        }
+
+        double checksum = 0.0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; ++i)
+        {
+            rates[i] = michaelis_reversible_rate(network.reactions[ids[i]], S[i], P[i]);
+        }
+        double perCall = seconds_since(start);
+        checksum += rates[count / 2];
+
+        start = std::chrono::steady_clock::now();
+        michaelis_reversible_rate_batch_scalar(network.kinetics, ids.data(), S.data(), P.data(), rates.data(), count);
+        double scalar = seconds_since(start);
+        checksum += rates[count / 2];
+
+        std::cout << "kernel\tns_per_rate\tspeedup" << std::endl;
+        std::cout << "per call\t" << perCall * 1e9 / count << "\t1x" << std::endl;
+        std::cout << "scalar batch\t" << scalar * 1e9 / count << "\t" << perCall / scalar << "x" << std::endl;
+        if (has_avx2_rate_kernel())
+        {
+            start = std::chrono::steady_clock::now();
+            michaelis_reversible_rate_batch_avx2(network.kinetics, ids.data(), S.data(), P.data(), rates.data(), count);
+            double avx2 = seconds_since(start);
+            checksum += rates[count / 2];
+            std::cout << "avx2 batch\t" << avx2 * 1e9 / count << "\t" << perCall / avx2 << "x" << std::endl;
+        }
+        std::cout << "(checksum " << checksum << ")" << std::endl;
+    }
+
+    void bench_distance_oracle()
+    {
+        std::cout << " ======= distance oracle vs bfs ======= " << std::endl;
+        SplitMix64 rng(33);
+        Network network = make_hub_network(20000, 2, rng);
+        AdjacencyGraph graph = build_adjacency_graph(network);
+
+        auto start = std::chrono::steady_clock::now();
+        DistanceOracle oracle = DistanceOracle::build(graph);
+        double buildTime = seconds_since(start);
+
+        const size_t queries = 100000, traversals = 50;
+        long checksum = 0;
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < queries; ++i)
+        {
+            checksum += oracle.distance((CompoundID)(rng.next() % graph.size()), (CompoundID)(rng.next() % graph.size()));
+        }
+        double oracleTime = seconds_since(start);
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < traversals; ++i)
+        {
+            checksum += bfs(graph, (CompoundID)(rng.next() % graph.size())).distances[rng.next() % graph.size()];
+        }
+        double bfsTime = seconds_since(start);
+
+        std::cout << graph.size() << " compounds, " << network.reactions.size() << " reactions, "
+                  << (double)oracle.label_entries() / graph.size() << " label entries per compound, built in "
+                  << buildTime << " s" << std::endl;
+        std::cout << "oracle distance\t" << oracleTime * 1e6 / queries << " us" << std::endl;
+        std::cout << "bfs distance\t" << bfsTime * 1e6 / traversals << " us" << std::endl;
+        std::cout << "(checksum " << checksum << ")" << std::endl;
+    }
+
+    void bench_parallel_bfs()
+    {
+        std::cout << " ======= level-synchronous parallel bfs ======= " << std::endl;
+        SplitMix64 rng(35);
+        Network network = make_hub_network(1000000, 3, rng);
+        AdjacencyGraph graph = build_adjacency_graph(network);
+        CompoundID start = (CompoundID)(rng.next() % graph.size());
+        std::cout << graph.size() << " compounds, " << network.reactions.size() << " reactions, "
+                  << default_thread_count() << " hardware threads" << std::endl;
+
+        auto begin = std::chrono::steady_clock::now();
+        BFS expected = bfs(graph, start);
+        double sequentialTime = seconds_since(begin);
+        std::cout << "threads\tms\tspeedup\tidentical" << std::endl;
+        std::cout << "bfs\t" << sequentialTime * 1e3 << "\t1\tyes" << std::endl;
+        for (unsigned threads = 1; threads <= 32; threads *= 2)
+        {
+            begin = std::chrono::steady_clock::now();
+            BFS result = parallel_bfs(graph, start, threads);
+            double time = seconds_since(begin);
+            bool identical = result.distances == expected.distances && result.parents == expected.parents;
+            std::cout << threads << "\t" << time * 1e3 << "\t" << sequentialTime / time << "\t"
+                      << (identical ? "yes" : "NO") << std::endl;
+        }
+    }
+
+    void bench_reordering()
+    {
+        std::cout << " ======= compound renumbering ======= " << std::endl;
+        SplitMix64 rng(36);
+        Network base = make_hub_network(300000, 3, rng);
+        Network network = shuffle_compounds(base, rng);
+        std::vector<CompoundID> starts;
+        for (size_t i = 0; i < 10; ++i)
+        {
+            starts.push_back((CompoundID)(rng.next() % network.compounds.size()));
+        }
+        CacheMissCounter counter;
+        std::cout << network.compounds.size() << " compounds, " << network.reactions.size() << " reactions, "
+                  << starts.size() << " bfs per ordering" << std::endl;
+        if (!counter.available())
+        {
+            std::cout << "(perf_event_open not permitted here: cache misses reported as -1)" << std::endl;
+        }
+        std::cout << "ordering\tmean_id_gap\tbfs_ms\tcache_misses" << std::endl;
+        for (CompoundOrdering ordering : {ORDER_IDENTITY, ORDER_BFS, ORDER_RCM, ORDER_DEGREE})
+        {
+            ReorderedNetwork reordered = reorder_network(network, ordering);
+            long checksum = 0;
+            counter.start();
+            auto begin = std::chrono::steady_clock::now();
+            for (CompoundID start : starts)
+            {
+                BFS result = bfs(reordered.graph, reordered.mapping.compound_to_internal[start]);
+                checksum += result.distances[reordered.mapping.compound_to_internal[starts[0]]];
+            }
+            double time = seconds_since(begin);
+            long long misses = counter.stop();
+            std::cout << to_string(ordering) << "\t" << mean_id_gap(reordered.network) << "\t"
+                      << time * 1e3 / starts.size() << "\t" << misses << "\t(checksum " << checksum << ")" << std::endl;
+        }
+    }
+
+    void bench_compact_bfs()
+    {
+        std::cout << " ======= compact bfs results ======= " << std::endl;
+        SplitMix64 rng(37);
+        Network network = make_hub_network(1000000, 3, rng);
+        AdjacencyGraph graph = build_adjacency_graph(network);
+        const size_t traversals = 5;
+
+        double bfsTime = 0, compactTime = 0;
+        size_t bfsBytes = 0, compactBytes = 0, reached = 0;
+        bool identical = true;
+        CompactBFS compact;
+        for (size_t i = 0; i < traversals; ++i)
+        {
+            CompoundID start = (CompoundID)(rng.next() % graph.size());
+            auto begin = std::chrono::steady_clock::now();
+            BFS result = bfs(graph, start);
+            bfsTime += seconds_since(begin);
+            begin = std::chrono::steady_clock::now();
+            compact_bfs(graph, start, compact);
+            compactTime += seconds_since(begin);
+
+            // vector headers, then one heap block (16 bytes of malloc overhead at least) per non-empty parent list
+            bfsBytes = result.distances.size() * sizeof(int) + result.parents.size() * sizeof(std::vector<CompoundID>);
+            reached = 0;
+            for (const std::vector<CompoundID> &parents : result.parents)
+            {
+                if (!parents.empty())
+                {
+                    bfsBytes += parents.capacity() * sizeof(CompoundID) + 16;
+                    reached++;
+                }
+            }
+            compactBytes = compact.memory_bytes();
+            identical = identical && compact.to_bfs().parents == result.parents;
+        }
+        std::cout << graph.size() << " compounds, " << reached << " reached, "
+                  << compact.distance_bits() << " bit distances" << std::endl;
+        std::cout << "result\tms\tMB\theap_blocks" << std::endl;
+        std::cout << "BFS\t" << bfsTime * 1e3 / traversals << "\t" << bfsBytes / 1e6 << "\t" << reached + 2 << std::endl;
+        std::cout << "CompactBFS\t" << compactTime * 1e3 / traversals << "\t" << compactBytes / 1e6 << "\t0 (reused)" << std::endl;
+        std::cout << "identical parents: " << (identical ? "yes" : "NO") << std::endl;
+    }
+
+    void bench_parallel_enumeration()
+    {
+        std::cout << " ======= work-stealing path enumeration ======= " << std::endl;
+        SplitMix64 rng(38);
+        Network network = make_layered_network(7, 12, 3, rng);
+        AdjacencyGraph graph = build_adjacency_graph(network);
+        Concentrations initial;
+        for (size_t c = 0; c < graph.size(); ++c)
+        {
+            initial[(CompoundID)c] = rng.next_double(0.1, 1.0);
+        }
+        ShortestPathDag dag = build_shortest_path_dag(graph, 0, (CompoundID)graph.size() - 1);
+        std::cout << count_paths(dag) << " shortest paths of " << path_length(dag) << " reactions, "
+                  << default_thread_count() << " hardware threads" << std::endl;
+
+        auto begin = std::chrono::steady_clock::now();
+        Paths expected = to_paths(dag);
+        double enumerateTime = seconds_since(begin);
+        // one thread, same compiled solver as the workers
+        begin = std::chrono::steady_clock::now();
+        double maxPathRate = INT_MIN;
+        Path sequentialBest;
+        CompiledPath compiled;
+        PathState state, scratch;
+        for (const Path &path : expected)
+        {
+            compile_path(network, path.data(), path.size(), compiled);
+            initial_path_state(compiled, initial, state);
+            solve_ss_state(compiled, state, scratch, 1e-2);
+            double pathRate = compute_path_rate(compiled, state);
+            if (pathRate > maxPathRate)
+            {
+                maxPathRate = pathRate;
+                sequentialBest = path;
+            }
+        }
+        double rankTime = seconds_since(begin);
+        Path expectedBest = find_fastest_path(network, dag, initial, 1e-2);
+        std::cout << "threads\tenumerate_ms\tfastest_ms\tidentical" << std::endl;
+        std::cout << "sequential\t" << enumerateTime * 1e3 << "\t" << rankTime * 1e3 << "\t"
+                  << (sequentialBest == expectedBest ? "yes" : "NO") << std::endl;
+        for (unsigned threads = 1; threads <= 8; threads *= 2)
+        {
+            begin = std::chrono::steady_clock::now();
+            Paths paths = to_paths_parallel(dag, threads);
+            double parallelEnumerate = seconds_since(begin);
+            begin = std::chrono::steady_clock::now();
+            Path best = find_fastest_path_parallel(network, dag, initial, 1e-2, threads);
+            double parallelRank = seconds_since(begin);
+            std::cout << threads << "\t" << parallelEnumerate * 1e3 << "\t" << parallelRank * 1e3 << "\t"
+                      << (paths == expected && best == expectedBest ? "yes" : "NO") << std::endl;
+        }
+    }
+
+    void bench_anytime_queries()
+    {
+        std::cout << " ======= deadline-bounded fastest path ======= " << std::endl;
+        SplitMix64 rng(39);
+        Network network = make_layered_network(7, 12, 3, rng);
+        AdjacencyGraph graph = build_adjacency_graph(network);
+        Concentrations initial;
+        for (size_t c = 0; c < graph.size(); ++c)
+        {
+            initial[(CompoundID)c] = rng.next_double(0.1, 1.0);
+        }
+        ShortestPathDag dag = build_shortest_path_dag(graph, 0, (CompoundID)graph.size() - 1);
+        AnytimeResult full = find_fastest_path_anytime(network, dag, initial, 1e-2, QueryBudget());
+        std::cout << count_paths(dag) << " shortest paths, best rate " << full.rate << " after "
+                  << full.stats.seconds * 1e3 << " ms" << std::endl;
+        std::cout << "deadline_ms\tstop\tevaluated\tpruned\trate/best\toptimal" << std::endl;
+        for (double deadline : {1.0, 10.0, 100.0, 1000.0})
+        {
+            QueryBudget budget = budget_for(std::chrono::microseconds((long)(deadline * 1e3)));
+            AnytimeResult result = find_fastest_path_anytime(network, dag, initial, 1e-2, budget);
+            std::cout << deadline << "\t" << to_string(result.stats.stop) << "\t" << result.stats.evaluated << "\t"
+                      << result.stats.pruned << "\t" << (result.path.empty() ? 0.0 : result.rate / full.rate) << "\t"
+                      << (result.optimal ? "yes" : "no") << std::endl;
+        }
+    }
+
+    void bench_top_k()
+    {
+        std::cout << " ======= top-k fastest paths ======= " << std::endl;
+        SplitMix64 rng(40);
+        Network network = make_layered_network(7, 12, 3, rng);
+        AdjacencyGraph graph = build_adjacency_graph(network);
+        Concentrations initial;
+        for (size_t c = 0; c < graph.size(); ++c)
+        {
+            initial[(CompoundID)c] = rng.next_double(0.1, 1.0);
+        }
+        ShortestPathDag dag = build_shortest_path_dag(graph, 0, (CompoundID)graph.size() - 1);
+        std::cout << count_paths(dag) << " shortest paths" << std::endl;
+        std::cout << "k\tevaluated\tpruned\tms\tk-th rate" << std::endl;
+        for (size_t k : {1, 5, 20, 100})
+        {
+            DagSearchStats stats;
+            auto begin = std::chrono::steady_clock::now();
+            PathRanking ranking = find_fastest_paths(network, dag, initial, 1e-2, k, &stats);
+            double time = seconds_since(begin);
+            std::cout << k << "\t" << stats.evaluated << "\t" << stats.pruned << "\t" << time * 1e3 << "\t"
+                      << ranking.back().rate << std::endl;
+        }
+    }
+
+    // depth-bounded simple path DFS without distance pruning; gives up after budget expansions
+    uint64_t naive_near_shortest(const AdjacencyGraph &graph, CompoundID node, CompoundID dest, size_t depthLeft,
+                                 std::vector<bool> &onPath, uint64_t &expanded, uint64_t budget)
+    {
+        if (node == dest)
+        {
+            return 1;
+        }
+        if (depthLeft == 0 || expanded > budget)
+        {
+            return 0;
+        }
+        uint64_t paths = 0;
+        onPath[node] = true;
+        for (const std::pair<const CompoundID, ReactionID> &pair : graph[node])
+        {
+            if (!onPath[pair.first])
+            {
+                expanded++;
+                paths += naive_near_shortest(graph, pair.first, dest, depthLeft - 1, onPath, expanded, budget);
+            }
+        }
+        onPath[node] = false;
+        return paths;
+    }
+
+    void bench_near_shortest_paths()
+    {
+        std::cout << " ======= near-shortest path enumeration ======= " << std::endl;
+        SplitMix64 rng(41);
+        Network network = make_hub_network(20000, 2, rng);
+        AdjacencyGraph graph = build_adjacency_graph(network);
+        const uint64_t budget = 20000000;
+        std::cout << graph.size() << " compounds, naive search stops after " << budget << " expansions" << std::endl;
+        std::cout << "slack\td\tpaths\tkept\texpanded\tms\tnaive_expanded\tnaive_ms" << std::endl;
+        for (size_t query = 0; query < 3; ++query)
+        {
+            CompoundID src = (CompoundID)(rng.next() % graph.size());
+            CompoundID dest = (CompoundID)(rng.next() % graph.size());
+            int distance = bfs(graph, src).distances[dest];
+            for (size_t slack = 0; slack <= 2; ++slack)
+            {
+                NearShortestStats stats;
+                auto count = [](const Path &)
+                {
+                    return true;
+                };
+                auto begin = std::chrono::steady_clock::now();
+                for_each_near_shortest_path(graph, src, dest, slack, count, &stats);
+                double time = seconds_since(begin);
+
+                std::vector<bool> onPath(graph.size(), false);
+                uint64_t expanded = 0;
+                begin = std::chrono::steady_clock::now();
+                uint64_t naivePaths = naive_near_shortest(graph, src, dest, distance + slack, onPath, expanded, budget);
+                double naiveTime = seconds_since(begin);
+                std::cout << slack << "\t" << distance << "\t" << stats.paths << "\t" << stats.compounds << "\t"
+                          << stats.expanded << "\t" << time * 1e3 << "\t"
+                          << (expanded > budget ? ">" : "") << expanded << "\t" << naiveTime * 1e3
+                          << (expanded > budget || naivePaths == stats.paths ? "" : "\tMISMATCH") << std::endl;
+            }
+        }
+    }
+
+    void bench_hub_filtering()
+    {
+        std::cout << " ======= hub-filtered graph views ======= " << std::endl;
+        SplitMix64 rng(42);
+        Network network = make_hub_network(20000, 3, rng);
+        AdjacencyGraph graph = build_adjacency_graph(network);
+        std::cout << "max_degree\tmasked\tmean_distance\tmean_paths\tmax_paths\tbfs_ms" << std::endl;
+        std::vector<std::pair<CompoundID, CompoundID>> queries;
+        for (size_t i = 0; i < 50; ++i)
+        {
+            queries.push_back({(CompoundID)(rng.next() % graph.size()), (CompoundID)(rng.next() % graph.size())});
+        }
+        for (size_t maxDegree : {SIZE_MAX, (size_t)200, (size_t)50, (size_t)20})
+        {
+            CompoundMask mask = mask_by_degree(graph, maxDegree);
+            GraphView view = {&graph, &mask};
+            double distance = 0, paths = 0, maxPaths = 0;
+            size_t reached = 0;
+            auto begin = std::chrono::steady_clock::now();
+            for (const std::pair<CompoundID, CompoundID> &query : queries)
+            {
+                ShortestPathDag dag = build_shortest_path_dag(view, query.first, query.second);
+                if (!dag.nodes.empty())
+                {
+                    reached++;
+                    distance += path_length(dag);
+                    paths += count_paths(dag);
+                    maxPaths = std::max(maxPaths, (double)count_paths(dag));
+                }
+            }
+            double time = seconds_since(begin);
+            std::cout << (maxDegree == SIZE_MAX ? std::string("none") : std::to_string(maxDegree)) << "\t" << mask.count() << "\t"
+                      << distance / reached << "\t" << paths / reached << "\t" << maxPaths << "\t"
+                      << time * 1e3 / queries.size() << std::endl;
+        }
+    }
+
+    void bench_allocations()
+    {
+        std::cout << " ======= heap allocations per query ======= " << std::endl;
+        SplitMix64 rng(43);
+        Network network = make_layered_network(5, 8, 2, rng);
+        AdjacencyGraph graph = build_adjacency_graph(network);
+        Concentrations initial;
+        for (size_t c = 0; c < graph.size(); ++c)
+        {
+            initial[(CompoundID)c] = rng.next_double(0.1, 1.0);
+        }
+        std::vector<std::pair<CompoundID, CompoundID>> queries;
+        while (queries.size() < 200)
+        {
+            CompoundID src = (CompoundID)(rng.next() % graph.size());
+            CompoundID dest = (CompoundID)(rng.next() % graph.size());
+            // the reference solver does not accept the empty path of src == dest
+            if (src != dest)
+            {
+                queries.push_back({src, dest});
+            }
+        }
+
+        // a warm workspace has already served every query once
+        QueryWorkspace workspace;
+        size_t paths = 0;
+        for (const std::pair<CompoundID, CompoundID> &query : queries)
+        {
+            find_fastest_path(graph, network, query.first, query.second, initial, 1e-2, workspace);
+            paths += workspace.paths.size();
+        }
+        std::cout << graph.size() << " compounds, " << (double)paths / queries.size() << " shortest paths per query" << std::endl;
+
+        std::cout << "call\tallocations\tkbytes\tms" << std::endl;
+        auto measure = [&](const std::string &name, const std::function<void(CompoundID, CompoundID)> &query)
+        {
+            auto begin = std::chrono::steady_clock::now();
+            AllocationCounters counters;
+            {
+                AllocationScope scope;
+                for (const std::pair<CompoundID, CompoundID> &pair : queries)
+                {
+                    query(pair.first, pair.second);
+                }
+                counters = scope.counters();
+            }
+            double time = seconds_since(begin);
+            std::cout << name << "\t" << (double)counters.allocations / queries.size() << "\t"
+                      << counters.bytes / 1e3 / queries.size() << "\t" << time * 1e3 / queries.size() << std::endl;
+        };
+        auto runBfs = [&](CompoundID src, CompoundID)
+        {
+            bfs(graph, src);
+        };
+        auto runAllPaths = [&](CompoundID src, CompoundID dest)
+        {
+            find_all_shortest_paths(graph, src, dest);
+        };
+        auto runReference = [&](CompoundID src, CompoundID dest)
+        {
+            find_fastest_path(network, find_all_shortest_paths(graph, src, dest), initial, 1e-2);
+        };
+        auto runWorkspace = [&](CompoundID src, CompoundID dest)
+        {
+            find_fastest_path(graph, network, src, dest, initial, 1e-2, workspace);
+        };
+        measure("bfs", runBfs);
+        measure("find_all_shortest_paths", runAllPaths);
+        measure("find_fastest_path", runReference);
+        measure("workspace_query", runWorkspace);
+    }
+
+    void bench_path_output()
+    {
+        std::cout << " ======= streaming path output ======= " << std::endl;
+        SplitMix64 rng(45);
+        Network network = make_layered_network(12, 6, 3, rng);
+        AdjacencyGraph graph = build_adjacency_graph(network);
+        ShortestPathDag dag = build_shortest_path_dag(graph, 0, (CompoundID)graph.size() - 1);
+        Paths paths = to_paths(dag);
+        PathSet set;
+        for (const Path &path : paths)
+        {
+            set.push_back(path);
+        }
+        std::cout << paths.size() << " paths of " << path_length(dag) << " reactions" << std::endl;
+        std::cout << "writer\tms\tMB\theap_MB\tread_ms" << std::endl;
+        std::ofstream null("/dev/null");
+
+        // the stringstream to_string(Paths) this replaces, kept as the baseline
+        auto legacy = [&]()
+        {
+            std::stringstream ss;
+            for (size_t i = 0; i < paths.size(); ++i)
+            {
+                std::stringstream line;
+                line << "Reactions: ";
+                for (auto r : paths[i])
+                {
+                    line << r << " ";
+                }
+                line << "\n";
+                ss << "Path Number " << i + 1 << " - " << line.str();
+            }
+            std::string text = ss.str();
+            null << text;
+            return text.size();
+        };
+        auto begin = std::chrono::steady_clock::now();
+        AllocationCounters counters;
+        size_t bytes;
+        {
+            AllocationScope scope;
+            bytes = legacy();
+            counters = scope.counters();
+        }
+        std::cout << "stringstream\t" << seconds_since(begin) * 1e3 << "\t" << bytes / 1e6 << "\t" << counters.bytes / 1e6 << "\t-" << std::endl;
+
+        for (PathFormat format : {FORMAT_TEXT, FORMAT_CSV, FORMAT_BINARY})
+        {
+            begin = std::chrono::steady_clock::now();
+            {
+                AllocationScope scope;
+                OutputSink out(null);
+                write_paths(out, set, format);
+                out.flush();
+                counters = scope.counters();
+            }
+            double time = seconds_since(begin);
+            // the same output in memory, to measure its size and read it back
+            std::stringstream file;
+            {
+                OutputSink out(file);
+                write_paths(out, set, format);
+            }
+            bytes = file.str().size();
+            PathSet read;
+            begin = std::chrono::steady_clock::now();
+            read_paths(file, read, format);
+            double readTime = seconds_since(begin);
+            std::string name = format == FORMAT_TEXT ? "sink_text" : format == FORMAT_CSV ? "sink_csv" : "sink_binary";
+            std::cout << name << "\t" << time * 1e3 << "\t" << bytes / 1e6 << "\t" << counters.bytes / 1e6 << "\t" << readTime * 1e3
+                      << (read.size() == set.size() ? "" : " (read mismatch)") << std::endl;
+        }
+    }
+
+    void bench_sharding()
+    {
+        std::cout << " ======= sharded query serving ======= " << std::endl;
+        SplitMix64 rng(46);
+        Network network = make_hub_network(20000, 3, rng);
+        AdjacencyGraph graph = build_adjacency_graph(network);
+        Concentrations initial;
+        for (CompoundID c = 0; c < (CompoundID)graph.size(); ++c)
+        {
+            initial[c] = 0.1 + (rng.next() % 1000) / 1000.0;
+        }
+        std::vector<CompoundID> sources;
+        for (size_t i = 0; i < 20; ++i)
+        {
+            sources.push_back((CompoundID)(rng.next() % graph.size()));
+        }
+        auto begin = std::chrono::steady_clock::now();
+        for (CompoundID src : sources)
+        {
+            bfs(graph, src);
+        }
+        std::cout << "local bfs: " << seconds_since(begin) * 1e3 / sources.size() << " ms" << std::endl;
+        std::cout << "parts\tpartition\tcut\ttransport\tbfs_ms\tmessages\tvalues_per_bfs" << std::endl;
+        for (unsigned parts : {2u, 4u})
+        {
+            for (bool greedy : {false, true})
+            {
+                Partition partition = greedy ? partition_graph(graph, parts) : hash_partition(graph.size(), parts);
+                for (TransportKind transport : {TRANSPORT_IN_PROCESS, TRANSPORT_SOCKET})
+                {
+                    ShardCluster cluster(network, initial, partition, transport);
+                    ClusterStats before = cluster.stats();
+                    begin = std::chrono::steady_clock::now();
+                    for (CompoundID src : sources)
+                    {
+                        distributed_bfs(cluster, src);
+                    }
+                    double time = seconds_since(begin);
+                    std::cout << parts << "\t" << (greedy ? "greedy" : "hash") << "\t" << edge_cut(graph, partition) << "\t"
+                              << (transport == TRANSPORT_IN_PROCESS ? "thread" : "socket") << "\t" << time * 1e3 / sources.size() << "\t"
+                              << (cluster.stats().messages - before.messages) / sources.size() << "\t"
+                              << (cluster.stats().values - before.values) / sources.size() << std::endl;
+                }
+            }
+        }
+
+        // fastest path with the steady states solved on the shards
+        Network layered = make_layered_network(7, 12, 3, rng);
+        AdjacencyGraph layeredGraph = build_adjacency_graph(layered);
+        Concentrations layeredInitial;
+        for (CompoundID c = 0; c < (CompoundID)layeredGraph.size(); ++c)
+        {
+            layeredInitial[c] = 0.1 + (rng.next() % 1000) / 1000.0;
+        }
+        CompoundID dest = (CompoundID)layeredGraph.size() - 1;
+        PathSet paths;
+        ScratchArena arena;
+        begin = std::chrono::steady_clock::now();
+        find_all_shortest_paths(layeredGraph, 0, dest, paths, arena);
+        find_fastest_path(layered, paths, layeredInitial, 1e-2);
+        std::cout << "fastest path over " << paths.size() << " paths: local " << seconds_since(begin) * 1e3 << " ms";
+        for (unsigned parts : {2u, 4u})
+        {
+            ShardCluster cluster(layered, layeredInitial, partition_graph(layeredGraph, parts), TRANSPORT_SOCKET);
+            begin = std::chrono::steady_clock::now();
+            distributed_fastest_path(cluster, 0, dest, 1e-2);
+            std::cout << ", " << parts << " shards " << seconds_since(begin) * 1e3 << " ms";
+        }
+        std::cout << std::endl;
+    }
+
+    void bench_mixed_precision()
+    {
+        std::cout << " ======= mixed precision screening ======= " << std::endl;
+        std::cout << "network\tpaths\tdouble_ms\tscreened_ms\tspeedup\trefined\tsame" << std::endl;
+        for (uint64_t seed : {47, 48, 49})
+        {
+            SplitMix64 rng(seed);
+            Network network = make_layered_network(7, 12, 3, rng);
+            AdjacencyGraph graph = build_adjacency_graph(network);
+            Concentrations initial;
+            for (CompoundID c = 0; c < (CompoundID)graph.size(); ++c)
+            {
+                initial[c] = 0.1 + (rng.next() % 1000) / 1000.0;
+            }
+            PathSet paths;
+            ScratchArena arena;
+            find_all_shortest_paths(graph, 0, (CompoundID)graph.size() - 1, paths, arena);
+            auto begin = std::chrono::steady_clock::now();
+            PathView expected = find_fastest_path(network, paths, initial, 1e-2);
+            double exact = seconds_since(begin);
+            ScreeningStats stats;
+            begin = std::chrono::steady_clock::now();
+            PathView screened = find_fastest_path_screened(network, paths, initial, 1e-2, DEFAULT_SCREENING, &stats);
+            double time = seconds_since(begin);
+            std::cout << "layered_" << seed << "\t" << paths.size() << "\t" << exact * 1e3 << "\t" << time * 1e3 << "\t" << exact / time
+                      << "\t" << stats.refined << "\t" << (screened.data == expected.data ? "yes" : "NO") << std::endl;
+        }
+
+        // every reachable pair of a bundled network, by number of candidates
+        Network network = read_network("data/C00025-C00148.txt");
+        Concentrations initial = read_initial_concentrations(network, "data/C00025-C00148_concentrations.txt");
+        AdjacencyGraph graph = build_adjacency_graph(network);
+        ScreeningOptions everyGroup = DEFAULT_SCREENING;
+        everyGroup.min_group = 1;
+        std::cout << "C00025-C00148 queries\tpaths\tdouble_ms\tscreened_ms\tscreened_every_group_ms\tsame" << std::endl;
+        for (int bucket = 0; bucket < 3; ++bucket)
+        {
+            size_t low = bucket == 0 ? 1 : bucket == 1 ? 8 : DEFAULT_SCREENING.min_group;
+            size_t high = bucket == 0 ? 8 : bucket == 1 ? DEFAULT_SCREENING.min_group : SIZE_MAX;
+            size_t queries = 0, candidates = 0;
+            double seconds[3] = {0, 0, 0};
+            bool same = true;
+            ScratchArena arena;
+            for (CompoundID src = 0; src < (CompoundID)graph.size(); ++src)
+            {
+                BFS result = bfs(graph, src);
+                for (CompoundID dest = 0; dest < (CompoundID)graph.size(); ++dest)
+                {
+                    if (dest == src || result.distances[dest] == INT_MAX)
+                    {
+                        continue;
+                    }
+                    PathSet paths;
+                    find_all_shortest_paths(graph, src, dest, paths, arena);
+                    if (paths.size() < low || paths.size() >= high)
+                    {
+                        continue;
+                    }
+                    queries++;
+                    candidates += paths.size();
+                    auto begin = std::chrono::steady_clock::now();
+                    PathView expected = find_fastest_path(network, paths, initial, 1e-2);
+                    seconds[0] += seconds_since(begin);
+                    begin = std::chrono::steady_clock::now();
+                    same = same && find_fastest_path_screened(network, paths, initial, 1e-2).data == expected.data;
+                    seconds[1] += seconds_since(begin);
+                    begin = std::chrono::steady_clock::now();
+                    same = same && find_fastest_path_screened(network, paths, initial, 1e-2, everyGroup).data == expected.data;
+                    seconds[2] += seconds_since(begin);
+                }
+            }
+            std::cout << low << ".." << (high == SIZE_MAX ? std::string("") : std::to_string(high - 1)) << " paths: " << queries << "\t"
+                      << candidates << "\t" << seconds[0] * 1e3 << "\t" << seconds[1] * 1e3 << "\t" << seconds[2] * 1e3 << "\t"
+                      << (same ? "yes" : "NO") << std::endl;
+        }
+    }
+    void bench_comparative_pipeline()
+    {
+        std::cout << " ======= comparative pipeline ======= " << std::endl;
+        char directory[] = "/tmp/pathsearch_organismsXXXXXX";
+        if (!mkdtemp(directory))
+        {
+            std::cout << "cannot create a temporary directory" << std::endl;
+            return;
+        }
+        // organisms share the compounds of one hub network, each keeping 85% of its reactions
+        SplitMix64 rng(48);
+        Network base = make_hub_network(4000, 2, rng);
+        const size_t organisms = 120;
+        size_t compounds = 0;
+        for (size_t i = 0; i < organisms; ++i)
+        {
+            FuzzCase organism = {i, Network(), Concentrations(), 0, 0};
+            organism.network.compounds = base.compounds;
+            for (const Reaction &reaction : base.reactions)
+            {
+                if (rng.next_double() < 0.85)
+                {
+                    Reaction copy = reaction;
+                    copy.V_plus *= rng.next_double(0.5, 2.0);
+                    organism.network.reactions.push_back(copy);
+                }
+            }
+            for (CompoundID c = 0; c < (CompoundID)base.compounds.size(); ++c)
+            {
+                organism.initial[c] = rng.next_double(0.1, 1.0);
+            }
+            std::string name = std::string(directory) + "/organism" + std::to_string(i);
+            std::ofstream network(name + ".txt"), concentrations(name + "_concentrations.txt");
+            write_case(organism, network, concentrations);
+            compounds += base.compounds.size();
+        }
+        std::vector<ComparativeQuery> queries;
+        for (size_t q = 0; q < 8; ++q)
+        {
+            queries.push_back({base.compounds[rng.next() % base.compounds.size()], base.compounds[rng.next() % base.compounds.size()]});
+        }
+        std::vector<NetworkSource> sources = list_networks(directory);
+
+        // one network after the other through read_network and find_compoundID
+        auto begin = std::chrono::steady_clock::now();
+        uint64_t checksum = 0;
+        for (const NetworkSource &source : sources)
+        {
+            std::ifstream networkFile(source.network_file), concentrationsFile(source.concentrations_file);
+            Network network = read_network(networkFile);
+            Concentrations initial = read_initial_concentrations(network, concentrationsFile);
+            AdjacencyGraph graph = build_adjacency_graph(network);
+            for (const ComparativeQuery &query : queries)
+            {
+                CompoundID src = find_compoundID(network, query.source), dest = find_compoundID(network, query.destination);
+                BFS result = bfs(graph, src);
+                if (result.distances[dest] != INT_MAX && src != dest)
+                {
+                    ShortestPathDag dag = build_shortest_path_dag(graph, result, dest);
+                    checksum += count_paths(dag);
+                    find_fastest_paths(network, dag, initial, 1e-2, 1);
+                }
+            }
+        }
+        double sequential = seconds_since(begin);
+        std::cout << organisms << " organisms of " << base.compounds.size() << " compounds, " << queries.size() << " queries" << std::endl;
+        std::cout << "mode\tin_flight\tms\tpeak\tread_ms\tparse_ms\tbuild_ms\tquery_ms\tpaths" << std::endl;
+        std::cout << "sequential\t1\t" << sequential * 1e3 << "\t1\t-\t-\t-\t-\t" << checksum << std::endl;
+        for (size_t inFlight : {1, 2, 4, 8})
+        {
+            CompoundDictionary dictionary;
+            PipelineStats stats;
+            ComparisonMatrix matrix = run_comparative_pipeline(sources, queries, dictionary, {inFlight, 1e-2}, &stats);
+            uint64_t paths = 0;
+            for (size_t entry = 0; entry < matrix.path_counts.size(); ++entry)
+            {
+                paths += matrix.distances[entry] > 0 ? matrix.path_counts[entry] : 0;
+            }
+            std::cout << "pipeline\t" << inFlight << "\t" << stats.seconds * 1e3 << "\t" << stats.peak_in_flight << "\t" << stats.read_seconds * 1e3
+                      << "\t" << stats.parse_seconds * 1e3 << "\t" << stats.build_seconds * 1e3 << "\t" << stats.query_seconds * 1e3
+                      << "\t" << paths << std::endl;
+            if (inFlight == 8)
+            {
+                std::cout << "dictionary: " << dictionary.size() << " names for " << compounds << " compound entries" << std::endl;
+            }
+        }
+        for (const NetworkSource &source : sources)
+        {
+            std::remove(source.network_file.c_str());
+            std::remove(source.concentrations_file.c_str());
+        }
+        rmdir(directory);
+    }
+
+    void bench_auto_time_step()
+    {
+        std::cout << " ======= automatic time step ======= " << std::endl;
+        std::cout << "network\tpaths\tsteps_1e-3\tsteps_1e-2\tsteps_auto\tms_1e-2\tms_auto\tworst_rate_diff" << std::endl;
+        for (std::string name : {"basic", "7paths", "C00025-C00148"})
+        {
+            Network network = read_network("data/" + name + ".txt");
+            Concentrations initial = read_initial_concentrations(network, "data/" + name + "_concentrations.txt");
+            AdjacencyGraph graph = build_adjacency_graph(network);
+            // one shortest path per reachable pair
+            std::vector<CompiledPath> paths;
+            for (CompoundID src = 0; src < (CompoundID)graph.size(); ++src)
+            {
+                BFS result = bfs(graph, src);
+                for (CompoundID dest = 0; dest < (CompoundID)graph.size(); ++dest)
+                {
+                    if (result.distances[dest] != INT_MAX && result.distances[dest] > 0)
+                    {
+                        paths.push_back(compile_path(network, find_shortest_path(graph, src, dest)));
+                    }
+                }
+            }
+            size_t steps[3] = {0, 0, 0};
+            double seconds[3] = {0, 0, 0}, worst = 0;
+            PathState state, scratch;
+            for (const CompiledPath &path : paths)
+            {
+                double rates[3];
+                for (int mode = 0; mode < 3; ++mode)
+                {
+                    initial_path_state(path, initial, state);
+                    auto begin = std::chrono::steady_clock::now();
+                    steps[mode] += mode == 2 ? solve_ss_state_auto(path, state, scratch)
+                                             : solve_ss_state(path, state, scratch, mode == 0 ? 1e-3 : 1e-2);
+                    seconds[mode] += seconds_since(begin);
+                    rates[mode] = compute_path_rate(path, state);
+                }
+                worst = std::max(worst, std::fabs(rates[2] - rates[0]) / std::fabs(rates[0]));
+            }
+            std::cout << name << "\t" << paths.size() << "\t" << steps[0] << "\t" << steps[1] << "\t" << steps[2] << "\t"
+                      << seconds[1] * 1e3 << "\t" << seconds[2] * 1e3 << "\t" << worst << std::endl;
+        }
+    }
+    void bench_directed_search()
+    {
+        std::cout << " ======= directed search graph ======= " << std::endl;
+        std::cout << "network\tthreshold\tedges\treachable_pairs\tcandidates\tfastest_ms" << std::endl;
+        for (std::string name : {"basic", "7paths", "C00025-C00148"})
+        {
+            Network network = read_network("data/" + name + ".txt");
+            Concentrations initial = read_initial_concentrations(network, "data/" + name + "_concentrations.txt");
+            DirectedSearchGraph directed = build_directed_search_graph(network);
+            // threshold 0 keeps every edge: the undirected search
+            for (double threshold : {0.0, 0.1, DEFAULT_MIN_FEASIBILITY, 0.3, 0.4})
+            {
+                size_t pairs = 0, candidates = 0;
+                double seconds = 0;
+                for (CompoundID src = 0; src < (CompoundID)directed.edges.size(); ++src)
+                {
+                    for (CompoundID dest = 0; dest < (CompoundID)directed.edges.size(); ++dest)
+                    {
+                        Paths paths = find_all_shortest_paths(directed, src, dest, threshold);
+                        if (src == dest || paths.empty())
+                        {
+                            continue;
+                        }
+                        pairs++;
+                        candidates += paths.size();
+                        auto begin = std::chrono::steady_clock::now();
+                        find_fastest_path(network, paths, initial, 1e-2);
+                        seconds += seconds_since(begin);
+                    }
+                }
+                std::cout << name << "\t" << threshold << "\t" << count_feasible_edges(directed, threshold) << "\t" << pairs << "\t"
+                          << candidates << "\t" << seconds * 1e3 << std::endl;
+            }
+        }
+        // synthetic layered networks, candidates from the first to the last compound
+        for (uint64_t seed : {50, 51})
+        {
+            SplitMix64 rng(seed);
+            Network network = make_layered_network(8, 10, 3, rng);
+            AdjacencyGraph graph = build_adjacency_graph(network);
+            DirectedSearchGraph directed = build_directed_search_graph(network, graph);
+            CompoundID dest = (CompoundID)graph.size() - 1;
+            for (double threshold : {0.0, 0.1, DEFAULT_MIN_FEASIBILITY, 0.3, 0.4})
+            {
+                BFS result = bfs(directed, 0, threshold);
+                uint64_t candidates = result.distances[dest] == INT_MAX ? 0 : count_paths(build_shortest_path_dag(graph, result, dest));
+                std::cout << "layered_" << seed << "\t" << threshold << "\t" << count_feasible_edges(directed, threshold) << "\t"
+                          << (candidates > 0) << "\t" << candidates << "\t-" << std::endl;
+            }
+        }
+    }
+}
+
+void run_benchmarks()
+{
+    bench_fixed_length_kernels();
+    bench_rate_law_batch();
+    bench_distance_oracle();
+    bench_parallel_bfs();
+    bench_reordering();
+    bench_compact_bfs();
+    bench_parallel_enumeration();
+    bench_anytime_queries();
+    bench_top_k();
+    bench_near_shortest_paths();
+    bench_hub_filtering();
+    bench_allocations();
+    bench_path_output();
+    bench_sharding();
+    bench_mixed_precision();
+    bench_comparative_pipeline();
+    bench_auto_time_step();
+    bench_directed_search();
+}
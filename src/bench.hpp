@@ -0,0 +1,10 @@
+/*
+ * Mini-projet 3 : benchmarks
+ */
+#pragma once
+
+/*!
+ * @brief runs the benchmarks and prints one table per benchmark on std::cout
+ * Build with -DCMAKE_BUILD_TYPE=Release for meaningful numbers.
+ */
+void run_benchmarks();
@@ -0,0 +1,224 @@
+/*
+ * Mini-projet 3 : compact breadth-first search results
+ */
+#include "compact_bfs.hpp"
+#include <algorithm>
+#include <climits>
+
+namespace
+{
+    // per-thread scratch of compact_bfs(); distances are INT_MAX between calls
+    struct BfsWorkspace
+    {
+        std::vector<int> distances;
+        std::vector<CompoundID> queue;
+        // (child, parent) in discovery order
+        std::vector<std::pair<CompoundID, CompoundID>> edges;
+    };
+
+    thread_local BfsWorkspace workspace;
+
+    const uint8_t UNREACHED8 = UINT8_MAX;
+    const uint16_t UNREACHED16 = UINT16_MAX;
+
+    // first half of compact_bfs(): the BFS into the workspace, entering only the compounds allowed() accepts
+    template <class Allowed>
+    void discover(const AdjacencyGraph &graph, CompoundID start, const Allowed &allowed)
+    {
+        size_t size = graph.size();
+        std::vector<int> &distances = workspace.distances;
+        std::vector<CompoundID> &queue = workspace.queue;
+        std::vector<std::pair<CompoundID, CompoundID>> &edges = workspace.edges;
+        if (distances.size() < size)
+        {
+            distances.resize(size, INT_MAX);
+        }
+        queue.clear();
+        edges.clear();
+
+        distances[start] = 0;
+        queue.push_back(start);
+        edges.push_back({start, -1});
+        for (size_t head = 0; head < queue.size(); ++head)
+        {
+            CompoundID currentNode = queue[head];
+            int next = distances[currentNode] + 1;
+            for (const std::pair<const CompoundID, ReactionID> &pair : graph[currentNode])
+            {
+                if (!allowed(pair.first))
+                {
+                    continue;
+                }
+                if (distances[pair.first] == INT_MAX)
+                {
+                    distances[pair.first] = next;
+                    queue.push_back(pair.first);
+                    edges.push_back({pair.first, currentNode});
+                }
+                else if (distances[pair.first] == next)
+                {
+                    edges.push_back({pair.first, currentNode});
+                }
+            }
+        }
+    }
+}
+
+CompactBFS::CompactBFS() : origin(-1), bits(8)
+{
+}
+
+int CompactBFS::distance(CompoundID compound) const
+{
+    switch (bits)
+    {
+    case 8:
+        return distances8[compound] == UNREACHED8 ? INT_MAX : distances8[compound];
+    case 16:
+        return distances16[compound] == UNREACHED16 ? INT_MAX : distances16[compound];
+    default:
+        return distances32[compound];
+    }
+}
+
+ParentList CompactBFS::parents(CompoundID compound) const
+{
+    return {parent_list.data() + parent_start[compound], parent_start[compound + 1] - parent_start[compound]};
+}
+
+size_t CompactBFS::memory_bytes() const
+{
+    return distances8.size() * sizeof(uint8_t) + distances16.size() * sizeof(uint16_t) +
+           distances32.size() * sizeof(int32_t) + parent_start.size() * sizeof(uint32_t) +
+           parent_list.size() * sizeof(CompoundID);
+}
+
+void CompactBFS::set_distances(const std::vector<int> &distances, const std::vector<CompoundID> &reached, int deepest)
+{
+    size_t count = size();
+    distances8.clear();
+    distances16.clear();
+    distances32.clear();
+    if (deepest < UNREACHED8)
+    {
+        bits = 8;
+        distances8.assign(count, UNREACHED8);
+        for (CompoundID c : reached)
+        {
+            distances8[c] = (uint8_t)distances[c];
+        }
+    }
+    else if (deepest < UNREACHED16)
+    {
+        bits = 16;
+        distances16.assign(count, UNREACHED16);
+        for (CompoundID c : reached)
+        {
+            distances16[c] = (uint16_t)distances[c];
+        }
+    }
+    else
+    {
+        bits = 32;
+        distances32.assign(count, INT_MAX);
+        for (CompoundID c : reached)
+        {
+            distances32[c] = distances[c];
+        }
+    }
+}
+
+BFS CompactBFS::to_bfs() const
+{
+    BFS result;
+    result.start = origin;
+    result.parents.resize(size());
+    result.distances.resize(size());
+    for (size_t c = 0; c < size(); ++c)
+    {
+        result.distances[c] = distance((CompoundID)c);
+        ParentList list = parents((CompoundID)c);
+        result.parents[c].assign(list.begin(), list.end());
+    }
+    return result;
+}
+
+CompactBFS CompactBFS::from_bfs(const BFS &result)
+{
+    CompactBFS compact;
+    size_t count = result.distances.size();
+    compact.origin = result.start;
+    compact.parent_start.resize(count + 1);
+    std::vector<CompoundID> reached;
+    int deepest = 0;
+    for (size_t c = 0; c < count; ++c)
+    {
+        compact.parent_start[c] = (uint32_t)compact.parent_list.size();
+        compact.parent_list.insert(compact.parent_list.end(), result.parents[c].begin(), result.parents[c].end());
+        if (result.distances[c] != INT_MAX)
+        {
+            reached.push_back((CompoundID)c);
+            deepest = std::max(deepest, result.distances[c]);
+        }
+    }
+    compact.parent_start[count] = (uint32_t)compact.parent_list.size();
+    compact.set_distances(result.distances, reached, deepest);
+    return compact;
+}
+
+void CompactBFS::pack_workspace(CompoundID start, size_t size)
+{
+    std::vector<int> &distances = workspace.distances;
+    std::vector<CompoundID> &queue = workspace.queue;
+    std::vector<std::pair<CompoundID, CompoundID>> &edges = workspace.edges;
+
+    // counting sort of the edges by child; walking them backwards keeps each list in discovery order
+    origin = start;
+    parent_start.assign(size + 1, 0);
+    for (const std::pair<CompoundID, CompoundID> &edge : edges)
+    {
+        parent_start[edge.first]++;
+    }
+    for (size_t c = 1; c <= size; ++c)
+    {
+        parent_start[c] += parent_start[c - 1];
+    }
+    parent_list.resize(edges.size());
+    for (size_t i = edges.size(); i-- > 0;)
+    {
+        parent_list[--parent_start[edges[i].first]] = edges[i].second;
+    }
+
+    set_distances(distances, queue, distances[queue.back()]);
+    for (CompoundID c : queue)
+    {
+        distances[c] = INT_MAX;
+    }
+}
+
+void compact_bfs(const AdjacencyGraph &graph, CompoundID start, CompactBFS &result)
+{
+    auto everything = [](CompoundID)
+    {
+        return true;
+    };
+    discover(graph, start, everything);
+    result.pack_workspace(start, graph.size());
+}
+
+void compact_bfs(const GraphView &view, CompoundID start, CompoundID destID, CompactBFS &result)
+{
+    auto allowed = [&](CompoundID compound)
+    {
+        return view.allowed(compound, start, destID);
+    };
+    discover(*view.graph, start, allowed);
+    result.pack_workspace(start, view.graph->size());
+}
+
+CompactBFS compact_bfs(const AdjacencyGraph &graph, CompoundID start)
+{
+    CompactBFS result;
+    compact_bfs(graph, start, result);
+    return result;
+}
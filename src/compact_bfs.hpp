@@ -0,0 +1,79 @@
+/*
+ * Mini-projet 3 : compact breadth-first search results
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "pathsearch.hpp"
+#include "graph_view.hpp"
+
+/*-----------------  TYPES AND DATA STRUCTURES    ------------*/
+
+// Non-owning view of the parents of one compound in a CompactBFS
+struct ParentList
+{
+    const CompoundID *data;
+    size_t length;
+
+    const CompoundID *begin() const { return data; }
+    const CompoundID *end() const { return data + length; }
+    CompoundID operator[](size_t i) const { return data[i]; }
+    size_t size() const { return length; }
+    bool empty() const { return length == 0; }
+};
+
+/*!
+ * A BFS result in a few flat arrays: distances in 8, 16 or 32 bits, the
+ * narrowest that holds the deepest level, and all the parent lists in one
+ * CSR array, in the same order as BFS::parents. The start has the single
+ * parent -1 and unreached compounds have none, as in BFS.
+ * Filling an existing CompactBFS again keeps its capacity.
+ */
+class CompactBFS
+{
+public:
+    CompactBFS();
+
+    CompoundID start() const { return origin; }
+    size_t size() const { return parent_start.empty() ? 0 : parent_start.size() - 1; }
+    // INT_MAX if unreached, as in BFS::distances
+    int distance(CompoundID compound) const;
+    unsigned distance_bits() const { return bits; }
+    ParentList parents(CompoundID compound) const;
+    // bytes held by the arrays
+    size_t memory_bytes() const;
+
+    BFS to_bfs() const;
+    static CompactBFS from_bfs(const BFS &result);
+
+private:
+    friend void compact_bfs(const AdjacencyGraph &graph, CompoundID start, CompactBFS &result);
+    friend void compact_bfs(const GraphView &view, CompoundID start, CompoundID destID, CompactBFS &result);
+    // second half of compact_bfs(): packs the thread-local search into this result
+    void pack_workspace(CompoundID start, size_t size);
+    void set_distances(const std::vector<int> &distances, const std::vector<CompoundID> &reached, int deepest);
+
+    CompoundID origin;
+    unsigned bits;
+    // only the one matching bits is filled
+    std::vector<uint8_t> distances8;
+    std::vector<uint16_t> distances16;
+    std::vector<int32_t> distances32;
+    // size() + 1 entries, parents of c are parent_list[parent_start[c] .. parent_start[c + 1])
+    std::vector<uint32_t> parent_start;
+    std::vector<CompoundID> parent_list;
+};
+
+/*!
+ * @brief bfs() into a CompactBFS
+ * The working distance array and queue are thread-local and kept between
+ * calls, so only the result arrays are written per call.
+ */
+void compact_bfs(const AdjacencyGraph &graph, CompoundID start, CompactBFS &result);
+CompactBFS compact_bfs(const AdjacencyGraph &graph, CompoundID start);
+
+/*!
+ * @brief bfs(view, start, destID) into a CompactBFS
+ */
+void compact_bfs(const GraphView &view, CompoundID start, CompoundID destID, CompactBFS &result);
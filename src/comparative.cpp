@@ -0,0 +1,576 @@
+/*
+ * Mini-projet 3 : comparative queries over many networks
+ */
+#include "comparative.hpp"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <dirent.h>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include "dag.hpp"
+#include "topk.hpp"
+
+namespace
+{
+    double seconds_since(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // FIFO between two stages, push waits while capacity items are queued
+    template <class T>
+    class BoundedQueue
+    {
+    public:
+        explicit BoundedQueue(size_t capacity) : capacity(capacity), closed(false) {}
+
+        void push(T item)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (items.size() >= capacity)
+            {
+                notFull.wait(lock);
+            }
+            items.push_back(std::move(item));
+            notEmpty.notify_one();
+        }
+
+        // false once the queue is closed and drained
+        bool pop(T &item)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (items.empty() && !closed)
+            {
+                notEmpty.wait(lock);
+            }
+            if (items.empty())
+            {
+                return false;
+            }
+            item = std::move(items.front());
+            items.pop_front();
+            notFull.notify_one();
+            return true;
+        }
+
+        void close()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+            notEmpty.notify_all();
+        }
+
+    private:
+        size_t capacity;
+        bool closed;
+        std::mutex mutex;
+        std::condition_variable notEmpty, notFull;
+        std::deque<T> items;
+    };
+
+    // counts the networks alive in the pipeline, acquire() waits for a free slot
+    class InFlightLimit
+    {
+    public:
+        explicit InFlightLimit(size_t limit) : limit(limit == 0 ? 1 : limit), alive(0), peak(0) {}
+
+        void acquire()
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (alive >= limit)
+            {
+                released.wait(lock);
+            }
+            alive++;
+            peak = std::max(peak, alive);
+        }
+
+        void release()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            alive--;
+            released.notify_one();
+        }
+
+        size_t peak_alive()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return peak;
+        }
+
+    private:
+        size_t limit, alive, peak;
+        std::mutex mutex;
+        std::condition_variable released;
+    };
+
+    // One network on its way through the stages
+    struct Job
+    {
+        size_t organism;
+        std::string network_text;
+        std::string concentrations_text;
+        InternedNetwork parsed;
+        AdjacencyGraph graph;
+        std::string error;
+    };
+
+    std::string read_file(const std::string &filename)
+    {
+        std::ifstream file(filename, std::ios::binary);
+        if (!file)
+        {
+            throw std::runtime_error("cannot read " + filename);
+        }
+        std::string text;
+        file.seekg(0, std::ios::end);
+        text.resize((size_t)file.tellg());
+        file.seekg(0, std::ios::beg);
+        file.read(&text[0], text.size());
+        return text;
+    }
+
+    // next line of text from position, without the '\n'
+    bool next_line(const std::string &text, size_t &position, std::string &line)
+    {
+        if (position >= text.size())
+        {
+            return false;
+        }
+        size_t end = text.find('\n', position);
+        if (end == std::string::npos)
+        {
+            end = text.size();
+        }
+        line.assign(text, position, end - position);
+        position = end + 1;
+        return true;
+    }
+
+    double parse_number(const std::string &line)
+    {
+        try
+        {
+            return std::stod(line);
+        }
+        catch (const std::logic_error &)
+        {
+            throw std::runtime_error("expected a number, got \"" + line + "\"");
+        }
+    }
+
+    bool ends_with(const std::string &text, const std::string &suffix)
+    {
+        return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    // the queries of one network, one BFS per distinct source
+    void answer_queries(const Job &job, const std::vector<ComparativeQuery> &queries, const CompoundDictionary &dictionary,
+                        double dt, ComparisonMatrix &matrix)
+    {
+        const InternedNetwork &parsed = job.parsed;
+        std::unordered_map<uint32_t, CompoundID> needed;
+        for (const ComparativeQuery &query : queries)
+        {
+            for (const std::string &name : {query.source, query.destination})
+            {
+                int64_t id = dictionary.find(name);
+                if (id >= 0)
+                {
+                    needed[(uint32_t)id] = -1;
+                }
+            }
+        }
+        for (CompoundID c = 0; c < (CompoundID)parsed.global_ids.size(); ++c)
+        {
+            std::unordered_map<uint32_t, CompoundID>::iterator it = needed.find(parsed.global_ids[c]);
+            if (it != needed.end())
+            {
+                it->second = c;
+            }
+        }
+        auto local = [&](const std::string &name)
+        {
+            int64_t id = dictionary.find(name);
+            return id < 0 ? -1 : needed[(uint32_t)id];
+        };
+
+        std::map<CompoundID, BFS> searches;
+        for (size_t q = 0; q < queries.size(); ++q)
+        {
+            size_t entry = job.organism * queries.size() + q;
+            CompoundID src = local(queries[q].source);
+            CompoundID dest = local(queries[q].destination);
+            if (src < 0 || dest < 0)
+            {
+                continue;
+            }
+            std::map<CompoundID, BFS>::iterator search = searches.find(src);
+            if (search == searches.end())
+            {
+                search = searches.insert({src, bfs(job.graph, src)}).first;
+            }
+            int distance = search->second.distances[dest];
+            if (distance == INT_MAX)
+            {
+                continue;
+            }
+            matrix.distances[entry] = distance;
+            if (distance == 0)
+            {
+                matrix.path_counts[entry] = 1;
+                continue;
+            }
+            ShortestPathDag dag = build_shortest_path_dag(job.graph, search->second, dest);
+            matrix.path_counts[entry] = count_paths(dag);
+            matrix.rates[entry] = find_fastest_paths(parsed.network, dag, parsed.concentrations, dt, 1)[0].rate;
+        }
+    }
+}
+
+//==================================================================
+//                          DICTIONARY
+//==================================================================
+
+uint32_t CompoundDictionary::intern(const std::string &name)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unordered_map<std::string, uint32_t>::iterator it = ids.find(name);
+    if (it != ids.end())
+    {
+        return it->second;
+    }
+    it = ids.insert({name, (uint32_t)names.size()}).first;
+    names.push_back(&it->first);
+    return it->second;
+}
+
+int64_t CompoundDictionary::find(const std::string &name) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unordered_map<std::string, uint32_t>::const_iterator it = ids.find(name);
+    return it == ids.end() ? -1 : (int64_t)it->second;
+}
+
+std::string CompoundDictionary::name(uint32_t id) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return *names.at(id);
+}
+
+size_t CompoundDictionary::size() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return names.size();
+}
+
+//==================================================================
+//                          SOURCES
+//==================================================================
+
+std::vector<NetworkSource> read_manifest(const std::string &manifest_file)
+{
+    std::ifstream file(manifest_file);
+    if (!file)
+    {
+        throw std::runtime_error("cannot read " + manifest_file);
+    }
+    size_t slash = manifest_file.rfind('/');
+    return read_manifest(file, slash == std::string::npos ? "" : manifest_file.substr(0, slash + 1));
+}
+
+std::vector<NetworkSource> read_manifest(std::istream &manifest, const std::string &base_directory)
+{
+    std::vector<NetworkSource> sources;
+    std::string line;
+    while (std::getline(manifest, line))
+    {
+        std::istringstream fields(line);
+        NetworkSource source;
+        if (!(fields >> source.name) || source.name[0] == '#')
+        {
+            continue;
+        }
+        if (!(fields >> source.network_file >> source.concentrations_file))
+        {
+            throw std::runtime_error("expected <name> <network file> <concentrations file>, got \"" + line + "\"");
+        }
+        for (std::string *filename : {&source.network_file, &source.concentrations_file})
+        {
+            if ((*filename)[0] != '/')
+            {
+                *filename = base_directory + *filename;
+            }
+        }
+        sources.push_back(source);
+    }
+    return sources;
+}
+
+std::vector<NetworkSource> list_networks(const std::string &directory)
+{
+    DIR *dir = opendir(directory.c_str());
+    if (!dir)
+    {
+        throw std::runtime_error("cannot read directory " + directory);
+    }
+    std::vector<std::string> files;
+    while (dirent *entry = readdir(dir))
+    {
+        files.push_back(entry->d_name);
+    }
+    closedir(dir);
+    std::sort(files.begin(), files.end());
+
+    const std::string suffix = "_concentrations.txt";
+    std::string prefix = directory.empty() || directory.back() == '/' ? directory : directory + "/";
+    std::vector<NetworkSource> sources;
+    for (const std::string &file : files)
+    {
+        if (!ends_with(file, ".txt") || ends_with(file, suffix))
+        {
+            continue;
+        }
+        std::string name = file.substr(0, file.size() - 4);
+        if (std::binary_search(files.begin(), files.end(), name + suffix))
+        {
+            sources.push_back({name, prefix + file, prefix + name + suffix});
+        }
+    }
+    return sources;
+}
+
+//==================================================================
+//                          PARSING
+//==================================================================
+
+void parse_interned_network(const std::string &network_text, const std::string &concentrations_text,
+                            CompoundDictionary &dictionary, InternedNetwork &parsed)
+{
+    parsed.network = Network();
+    parsed.global_ids.clear();
+    parsed.concentrations.clear();
+    // global id -> CompoundID, later compounds of the same name win like in read_network
+    std::unordered_map<uint32_t, CompoundID> local;
+    auto find_local = [&](const std::string &name)
+    {
+        int64_t id = dictionary.find(name);
+        std::unordered_map<uint32_t, CompoundID>::const_iterator it = id < 0 ? local.end() : local.find((uint32_t)id);
+        return it == local.end() ? (CompoundID)-1 : it->second;
+    };
+
+    size_t position = 0;
+    std::string line;
+    bool more = next_line(network_text, position, line);
+    while (more && line[0] != '-')
+    {
+        uint32_t id = dictionary.intern(line);
+        local[id] = (CompoundID)parsed.global_ids.size();
+        parsed.global_ids.push_back(id);
+        more = next_line(network_text, position, line);
+    }
+    parsed.network.compounds.resize(parsed.global_ids.size());
+
+    while (next_line(network_text, position, line))
+    {
+        if (line.empty() || line[0] == '#' || line[0] == '-')
+        {
+            continue;
+        }
+        std::string fields[6] = {line};
+        for (size_t i = 1; i < 6; ++i)
+        {
+            if (!next_line(network_text, position, fields[i]))
+            {
+                throw std::runtime_error("truncated reaction after " + line);
+            }
+        }
+        Reaction reaction;
+        reaction.compounds = {find_local(fields[0]), find_local(fields[1])};
+        if (reaction.compounds.first < 0 || reaction.compounds.second < 0)
+        {
+            throw std::runtime_error("unknown compound in reaction " + fields[0] + " -> " + fields[1]);
+        }
+        reaction.V_plus = parse_number(fields[2]);
+        reaction.V_minus = parse_number(fields[3]);
+        reaction.K_S = parse_number(fields[4]);
+        reaction.K_P = parse_number(fields[5]);
+        parsed.network.reactions.push_back(reaction);
+    }
+    parsed.network.kinetics = build_kinetic_table(parsed.network);
+
+    position = 0;
+    while (next_line(concentrations_text, position, line))
+    {
+        size_t equal = line.find('=');
+        if (line.empty() || equal == std::string::npos)
+        {
+            continue;
+        }
+        CompoundID id = find_local(line.substr(1, equal - 2)); // strips the brackets
+        if (id >= 0)
+        {
+            parsed.concentrations[id] = parse_number(line.substr(equal + 1));
+        }
+    }
+}
+
+//==================================================================
+//                          PIPELINE
+//==================================================================
+
+ComparisonMatrix run_comparative_pipeline(const std::vector<NetworkSource> &sources, const std::vector<ComparativeQuery> &queries,
+                                          CompoundDictionary &dictionary, const PipelineOptions &options, PipelineStats *stats)
+{
+    auto begin = std::chrono::steady_clock::now();
+    ComparisonMatrix matrix;
+    matrix.queries = queries;
+    matrix.errors.resize(sources.size());
+    for (const NetworkSource &source : sources)
+    {
+        matrix.organisms.push_back(source.name);
+    }
+    matrix.distances.assign(sources.size() * queries.size(), -1);
+    matrix.path_counts.assign(sources.size() * queries.size(), 0);
+    matrix.rates.assign(sources.size() * queries.size(), NAN);
+
+    size_t capacity = options.in_flight == 0 ? 1 : options.in_flight;
+    InFlightLimit limit(capacity);
+    BoundedQueue<std::unique_ptr<Job>> read(capacity), parsed(capacity), built(capacity);
+    double readTime = 0, parseTime = 0, buildTime = 0, queryTime = 0;
+
+    auto reader = [&]()
+    {
+        for (size_t i = 0; i < sources.size(); ++i)
+        {
+            limit.acquire();
+            auto start = std::chrono::steady_clock::now();
+            std::unique_ptr<Job> job(new Job());
+            job->organism = i;
+            try
+            {
+                job->network_text = read_file(sources[i].network_file);
+                job->concentrations_text = read_file(sources[i].concentrations_file);
+            }
+            catch (const std::exception &e)
+            {
+                job->error = e.what();
+            }
+            readTime += seconds_since(start);
+            read.push(std::move(job));
+        }
+        read.close();
+    };
+    auto parser = [&]()
+    {
+        std::unique_ptr<Job> job;
+        while (read.pop(job))
+        {
+            auto start = std::chrono::steady_clock::now();
+            if (job->error.empty())
+            {
+                try
+                {
+                    parse_interned_network(job->network_text, job->concentrations_text, dictionary, job->parsed);
+                }
+                catch (const std::exception &e)
+                {
+                    job->error = sources[job->organism].network_file + ": " + e.what();
+                }
+            }
+            // the texts are not needed anymore
+            std::string().swap(job->network_text);
+            std::string().swap(job->concentrations_text);
+            parseTime += seconds_since(start);
+            parsed.push(std::move(job));
+        }
+        parsed.close();
+    };
+    auto builder = [&]()
+    {
+        std::unique_ptr<Job> job;
+        while (parsed.pop(job))
+        {
+            auto start = std::chrono::steady_clock::now();
+            if (job->error.empty())
+            {
+                job->graph = build_adjacency_graph(job->parsed.network);
+            }
+            buildTime += seconds_since(start);
+            built.push(std::move(job));
+        }
+        built.close();
+    };
+
+    std::vector<std::thread> stages;
+    stages.emplace_back(reader);
+    stages.emplace_back(parser);
+    stages.emplace_back(builder);
+    std::unique_ptr<Job> job;
+    while (built.pop(job))
+    {
+        auto start = std::chrono::steady_clock::now();
+        if (job->error.empty())
+        {
+            answer_queries(*job, queries, dictionary, options.dt, matrix);
+        }
+        else
+        {
+            matrix.errors[job->organism] = job->error;
+        }
+        job.reset();
+        queryTime += seconds_since(start);
+        limit.release();
+    }
+    for (std::thread &stage : stages)
+    {
+        stage.join();
+    }
+    if (stats)
+    {
+        *stats = {sources.size(), limit.peak_alive(), readTime, parseTime, buildTime, queryTime, seconds_since(begin)};
+    }
+    return matrix;
+}
+
+void write_comparison(OutputSink &out, const ComparisonMatrix &matrix)
+{
+    out << "organism";
+    for (const ComparativeQuery &query : matrix.queries)
+    {
+        std::string name = query.source + "->" + query.destination;
+        out << '\t' << name << " distance\t" << name << " paths\t" << name << " rate";
+    }
+    out << '\n';
+    for (size_t organism = 0; organism < matrix.organisms.size(); ++organism)
+    {
+        out << matrix.organisms[organism];
+        for (size_t q = 0; q < matrix.queries.size(); ++q)
+        {
+            size_t entry = organism * matrix.queries.size() + q;
+            if (matrix.distances[entry] < 0)
+            {
+                out << "\t-\t-\t-";
+                continue;
+            }
+            out << '\t' << matrix.distances[entry] << '\t' << (unsigned long)matrix.path_counts[entry] << '\t';
+            if (std::isnan(matrix.rates[entry]))
+            {
+                out << '-';
+            }
+            else
+            {
+                out.write_double(matrix.rates[entry]);
+            }
+        }
+        out << '\n';
+    }
+}
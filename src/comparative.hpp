@@ -0,0 +1,138 @@
+/*
+ * Mini-projet 3 : comparative queries over many networks
+ */
+#pragma once
+#include <cstdint>
+#include <istream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "pathsearch.hpp"
+#include "stream_io.hpp"
+
+/*-----------------  TYPES AND DATA STRUCTURES    ------------*/
+
+/*!
+ * Compound names of every network in one table, each name stored once.
+ * Networks keep a vector of global ids instead of their own names, and a
+ * compound has the same global id in every network. Thread safe.
+ */
+class CompoundDictionary
+{
+public:
+    uint32_t intern(const std::string &name);
+    // -1 if the name was never interned
+    int64_t find(const std::string &name) const;
+    std::string name(uint32_t id) const;
+    size_t size() const;
+
+private:
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, uint32_t> ids;
+    std::vector<const std::string *> names; // keys of ids, which never move
+};
+
+// One organism: a network file and its concentrations file
+struct NetworkSource
+{
+    std::string name;
+    std::string network_file;
+    std::string concentrations_file;
+};
+
+/*!
+ * @brief reads a manifest, one "<name> <network file> <concentrations file>"
+ * line per network ('#' starts a comment line). Relative file names are taken
+ * from the directory of the manifest.
+ * throws std::runtime_error if the manifest cannot be read or a line is incomplete
+ */
+std::vector<NetworkSource> read_manifest(const std::string &manifest_file);
+std::vector<NetworkSource> read_manifest(std::istream &manifest, const std::string &base_directory);
+
+/*!
+ * @brief every X.txt of a directory that has an X_concentrations.txt next to
+ * it, named X, sorted by name
+ * throws std::runtime_error if the directory cannot be read
+ */
+std::vector<NetworkSource> list_networks(const std::string &directory);
+
+// A network whose compound names live in a CompoundDictionary
+struct InternedNetwork
+{
+    Network network; // compound names are left empty
+    // vector index == CompoundID
+    std::vector<uint32_t> global_ids;
+    Concentrations concentrations;
+};
+
+/*!
+ * @brief parses the text of a network file and of its concentrations file
+ * Same format, same compound and reaction ids as read_network and
+ * read_initial_concentrations. Concentrations of unknown compounds are skipped.
+ * throws std::runtime_error on a malformed reaction
+ */
+void parse_interned_network(const std::string &network_text, const std::string &concentrations_text,
+                            CompoundDictionary &dictionary, InternedNetwork &parsed);
+
+// Source and destination compounds, by name
+struct ComparativeQuery
+{
+    std::string source;
+    std::string destination;
+};
+
+/*!
+ * Results of every query on every network.
+ * Entries are row major: entry organism * queries.size() + query.
+ */
+struct ComparisonMatrix
+{
+    std::vector<std::string> organisms;
+    std::vector<ComparativeQuery> queries;
+    std::vector<int> distances;        // in reactions, -1 if unreachable or a compound is missing
+    std::vector<uint64_t> path_counts; // shortest paths, 0 if unreachable
+    std::vector<double> rates;         // of the fastest shortest path, NaN if it has no reaction
+    // vector index == organism, empty if the network was loaded
+    std::vector<std::string> errors;
+};
+
+struct PipelineOptions
+{
+    size_t in_flight; // networks alive between being read and being queried
+    double dt;        // of the fastest path evaluations
+};
+
+const PipelineOptions DEFAULT_PIPELINE = {4, 1e-2};
+
+struct PipelineStats
+{
+    size_t networks;
+    size_t peak_in_flight;
+    // busy time of each stage
+    double read_seconds, parse_seconds, build_seconds, query_seconds;
+    double seconds; // wall clock
+};
+
+///------------- Pipeline -------------
+
+/*!
+ * @brief answers the queries on every network
+ * Four stages on their own threads (read the files, parse them against the
+ * shared dictionary, build the graph, run the queries) hand networks over
+ * through bounded queues, so reading and parsing the next networks overlap
+ * the queries of the current one. A network is freed once queried and the
+ * reader waits while options.in_flight networks are alive: memory depends on
+ * in_flight, not on the number of networks. A network that cannot be loaded
+ * gets its error in the matrix and unreachable results.
+ * @param stats if not null, receives the time spent in each stage
+ */
+ComparisonMatrix run_comparative_pipeline(const std::vector<NetworkSource> &sources, const std::vector<ComparativeQuery> &queries,
+                                          CompoundDictionary &dictionary, const PipelineOptions &options = DEFAULT_PIPELINE,
+                                          PipelineStats *stats = nullptr);
+
+/*!
+ * @brief writes the matrix as TSV: a header line, then one line per organism
+ * with distance, path count and rate for each query ("-" where there is none)
+ */
+void write_comparison(OutputSink &out, const ComparisonMatrix &matrix);
@@ -0,0 +1,274 @@
+/*
+ * Mini-projet 3 : connected components
+ */
+#include "components.hpp"
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <memory>
+#include <thread>
+#include "parallel.hpp"
+
+namespace
+{
+    // Concurrent union-find: roots are linked towards the smaller index with
+    // compare-and-swap, and find() halves paths as it goes.
+    class AtomicUnionFind
+    {
+    public:
+        explicit AtomicUnionFind(size_t size) : parent(new std::atomic<int>[size])
+        {
+            for (size_t i = 0; i < size; ++i)
+            {
+                parent[i].store((int)i, std::memory_order_relaxed);
+            }
+        }
+
+        int find(int x)
+        {
+            while (true)
+            {
+                int p = parent[x].load();
+                if (p == x)
+                {
+                    return x;
+                }
+                int grandparent = parent[p].load();
+                parent[x].compare_exchange_weak(p, grandparent);
+                x = grandparent;
+            }
+        }
+
+        void unite(int a, int b)
+        {
+            while (true)
+            {
+                a = find(a);
+                b = find(b);
+                if (a == b)
+                {
+                    return;
+                }
+                if (a < b)
+                {
+                    std::swap(a, b);
+                }
+                int expected = a;
+                if (parent[a].compare_exchange_strong(expected, b))
+                {
+                    return;
+                }
+            }
+        }
+
+    private:
+        std::unique_ptr<std::atomic<int>[]> parent;
+    };
+
+    // dense component IDs in order of first compound
+    ComponentIndex label_components(AtomicUnionFind &sets, size_t size)
+    {
+        ComponentIndex index;
+        index.component.assign(size, -1);
+        std::vector<int> idOfRoot(size, -1);
+        for (size_t v = 0; v < size; ++v)
+        {
+            int root = sets.find((int)v);
+            if (idOfRoot[root] == -1)
+            {
+                idOfRoot[root] = (int)index.sizes.size();
+                index.sizes.push_back(0);
+            }
+            index.component[v] = idOfRoot[root];
+            index.sizes[idOfRoot[root]]++;
+        }
+        return index;
+    }
+
+    // moves the compounds labelled from that are reachable from start (start
+    // included) to label to, without leaving them; the label marks them as seen
+    std::vector<CompoundID> relabel(IndexedGraph &graph, CompoundID start, int from, int to, size_t sizeHint)
+    {
+        std::vector<int> &component = graph.components.component;
+        std::vector<CompoundID> visited;
+        visited.reserve(sizeHint);
+        visited.push_back(start);
+        component[start] = to;
+        for (size_t head = 0; head < visited.size(); ++head)
+        {
+            for (const std::pair<const CompoundID, ReactionID> &pair : graph.adjacency[visited[head]])
+            {
+                if (component[pair.first] == from)
+                {
+                    component[pair.first] = to;
+                    visited.push_back(pair.first);
+                }
+            }
+        }
+        return visited;
+    }
+}
+
+IndexedGraph build_indexed_graph(const Network &network, unsigned threads)
+{
+    size_t size = network.compounds.size();
+    size_t reactions = network.reactions.size();
+    unsigned workers = threads == 0 ? default_thread_count() : threads;
+    AtomicUnionFind sets(size);
+
+    auto uniteChunk = [&](size_t first, size_t last)
+    {
+        for (size_t i = first; i < last; ++i)
+        {
+            sets.unite(network.reactions[i].compounds.first, network.reactions[i].compounds.second);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned w = 0; w < workers; ++w)
+    {
+        pool.emplace_back(uniteChunk, reactions * w / workers, reactions * (w + 1) / workers);
+    }
+
+    IndexedGraph graph;
+    graph.adjacency = build_adjacency_graph(network);
+    for (std::thread &t : pool)
+    {
+        t.join();
+    }
+    graph.components = label_components(sets, size);
+    return graph;
+}
+
+ComponentIndex compute_components(const AdjacencyGraph &graph)
+{
+    AtomicUnionFind sets(graph.size());
+    for (size_t v = 0; v < graph.size(); ++v)
+    {
+        for (const std::pair<const CompoundID, ReactionID> &pair : graph[v])
+        {
+            sets.unite((int)v, pair.first);
+        }
+    }
+    return label_components(sets, graph.size());
+}
+
+bool same_component(const IndexedGraph &graph, CompoundID a, CompoundID b)
+{
+    return graph.components.component[a] == graph.components.component[b];
+}
+
+CompoundID add_compound(IndexedGraph &graph)
+{
+    graph.adjacency.emplace_back();
+    graph.components.component.push_back((int)graph.components.sizes.size());
+    graph.components.sizes.push_back(1);
+    return (CompoundID)graph.adjacency.size() - 1;
+}
+
+void add_edge(IndexedGraph &graph, CompoundID a, CompoundID b, ReactionID reaction)
+{
+    int ca = graph.components.component[a];
+    int cb = graph.components.component[b];
+    if (ca != cb)
+    {
+        if (graph.components.sizes[ca] < graph.components.sizes[cb])
+        {
+            std::swap(ca, cb);
+            std::swap(a, b);
+        }
+        // relabel b's (smaller) component before the edge joins it to a's
+        relabel(graph, b, cb, ca, graph.components.sizes[cb]);
+        graph.components.sizes[ca] += graph.components.sizes[cb];
+        graph.components.sizes[cb] = 0;
+    }
+    graph.adjacency[a].insert({b, reaction});
+    graph.adjacency[b].insert({a, reaction});
+}
+
+void remove_edge(IndexedGraph &graph, CompoundID a, CompoundID b)
+{
+    graph.adjacency[a].erase(b);
+    graph.adjacency[b].erase(a);
+    int old = graph.components.component[a];
+    int fresh = (int)graph.components.sizes.size();
+    std::vector<CompoundID> side = relabel(graph, a, old, fresh, graph.components.sizes[old]);
+    if (graph.components.component[b] == fresh)
+    {
+        // still connected: back to the old label
+        for (CompoundID v : side)
+        {
+            graph.components.component[v] = old;
+        }
+        return;
+    }
+    graph.components.sizes.push_back(side.size());
+    graph.components.sizes[old] -= side.size();
+}
+
+BFS bfs(const IndexedGraph &graph, CompoundID start)
+{
+    BFS result;
+    size_t size = graph.adjacency.size();
+    result.start = start;
+    result.parents.resize(size);
+    result.parents[start] = {-1};
+    result.distances.assign(size, INT_MAX);
+    result.distances[start] = 0;
+
+    // every compound of the component goes through the queue exactly once
+    std::vector<CompoundID> queue;
+    queue.reserve(graph.components.sizes[graph.components.component[start]]);
+    queue.push_back(start);
+    for (size_t head = 0; head < queue.size(); ++head)
+    {
+        CompoundID currentNode = queue[head];
+        for (const std::pair<const CompoundID, ReactionID> &pair : graph.adjacency[currentNode])
+        {
+            if (result.distances[pair.first] > result.distances[currentNode] + 1)
+            {
+                result.distances[pair.first] = result.distances[currentNode] + 1;
+                queue.push_back(pair.first);
+                result.parents[pair.first] = {currentNode};
+            }
+            else if (result.distances[pair.first] == result.distances[currentNode] + 1)
+            {
+                result.parents[pair.first].push_back(currentNode);
+            }
+        }
+    }
+
+    return result;
+}
+
+Path find_shortest_path(const IndexedGraph &graph, CompoundID srcID, CompoundID destID)
+{
+    Path path;
+    if (!same_component(graph, srcID, destID))
+    {
+        return path;
+    }
+    BFS result = bfs(graph, srcID);
+    for (CompoundID currentNode = destID; result.parents[currentNode][0] != -1; currentNode = result.parents[currentNode][0])
+    {
+        path.push_back(find_reactionID(graph.adjacency, currentNode, result.parents[currentNode][0]));
+    }
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+Paths find_all_shortest_paths(const IndexedGraph &graph, CompoundID srcID, CompoundID destID)
+{
+    Paths allPaths;
+    if (!same_component(graph, srcID, destID))
+    {
+        return allPaths;
+    }
+    BFS result = bfs(graph, srcID);
+    Path currentPath;
+    recursive_find_paths(graph.adjacency, result, srcID, destID, currentPath, allPaths);
+    for (Path &path : allPaths)
+    {
+        std::reverse(path.begin(), path.end());
+    }
+    return allPaths;
+}
@@ -0,0 +1,80 @@
+/*
+ * Mini-projet 3 : connected components
+ */
+#pragma once
+#include <vector>
+#include "pathsearch.hpp"
+
+/*-----------------  TYPES AND DATA STRUCTURES    ------------*/
+
+struct ComponentIndex
+{
+    // vector index == CompoundID
+    std::vector<int> component;
+    // vector index == component ID, 0 for IDs emptied by merges
+    std::vector<size_t> sizes;
+};
+
+// An adjacency graph that keeps the connected component of every compound
+struct IndexedGraph
+{
+    AdjacencyGraph adjacency;
+    ComponentIndex components;
+};
+
+///------------- Construction -------------
+
+/*!
+ * @brief builds the adjacency graph and labels its connected components
+ * The components come from a lock-free union-find run by worker threads
+ * over chunks of the reactions while this thread fills the adjacency maps.
+ * @param threads number of union-find workers, 0 means one per hardware thread
+ */
+IndexedGraph build_indexed_graph(const Network &network, unsigned threads = 0);
+
+/*!
+ * @brief labels the connected components of an existing graph (sequential)
+ */
+ComponentIndex compute_components(const AdjacencyGraph &graph);
+
+/*!
+ * @brief true if a path can exist between the two compounds, in O(1)
+ */
+bool same_component(const IndexedGraph &graph, CompoundID a, CompoundID b);
+
+///------------- Incremental edits -------------
+
+/*!
+ * @brief adds a compound without reactions, in a component of its own
+ * @return its ID
+ */
+CompoundID add_compound(IndexedGraph &graph);
+
+/*!
+ * @brief links two compounds by a reaction (both directions), merging their
+ * components by relabelling the smaller one
+ */
+void add_edge(IndexedGraph &graph, CompoundID a, CompoundID b, ReactionID reaction);
+
+/*!
+ * @brief removes the link between two compounds; if that disconnects them the
+ * side of a gets a new component ID
+ */
+void remove_edge(IndexedGraph &graph, CompoundID a, CompoundID b);
+
+///------------- Component-aware queries -------------
+
+/*!
+ * @brief bfs() sizing its work queue to the start's component
+ */
+BFS bfs(const IndexedGraph &graph, CompoundID start);
+
+/*!
+ * @brief find_shortest_path(), returning an empty path at once across components
+ */
+Path find_shortest_path(const IndexedGraph &graph, CompoundID srcID, CompoundID destID);
+
+/*!
+ * @brief find_all_shortest_paths(), returning no path at once across components
+ */
+Paths find_all_shortest_paths(const IndexedGraph &graph, CompoundID srcID, CompoundID destID);
@@ -0,0 +1,286 @@
+/*
+ * Mini-projet 3 : shortest path DAG
+ */
+#include "dag.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+#include "kinetics.hpp"
+
+ShortestPathDag build_shortest_path_dag(const AdjacencyGraph &graph, const BFS &result, CompoundID destID)
+{
+    auto reaction = [&](CompoundID parent, CompoundID child)
+    {
+        return find_reactionID(graph, child, parent);
+    };
+    return build_shortest_path_dag(result, destID, reaction);
+}
+
+ShortestPathDag build_shortest_path_dag(const BFS &result, CompoundID destID,
+                                        const std::function<ReactionID(CompoundID, CompoundID)> &reaction)
+{
+    ShortestPathDag dag;
+    dag.source = result.start;
+    dag.destination = destID;
+    if (result.distances[destID] == INT_MAX)
+    {
+        return dag;
+    }
+    size_t length = result.distances[destID];
+
+    // compounds that can reach the destination through parents, by layer
+    std::vector<std::vector<CompoundID>> layers(length + 1);
+    std::vector<bool> marked(result.distances.size(), false);
+    std::vector<CompoundID> stack = {destID};
+    marked[destID] = true;
+    while (!stack.empty())
+    {
+        CompoundID v = stack.back();
+        stack.pop_back();
+        layers[result.distances[v]].push_back(v);
+        for (CompoundID parent : result.parents[v])
+        {
+            if (parent != -1 && !marked[parent])
+            {
+                marked[parent] = true;
+                stack.push_back(parent);
+            }
+        }
+    }
+
+    std::vector<size_t> indexOf(result.distances.size());
+    for (std::vector<CompoundID> &layer : layers)
+    {
+        std::sort(layer.begin(), layer.end());
+        dag.layer_start.push_back(dag.nodes.size());
+        for (CompoundID c : layer)
+        {
+            indexOf[c] = dag.nodes.size();
+            dag.nodes.push_back(c);
+        }
+    }
+    dag.layer_start.push_back(dag.nodes.size());
+
+    for (CompoundID v : dag.nodes)
+    {
+        dag.parent_start.push_back(dag.edges.size());
+        if (v == dag.source)
+        {
+            continue;
+        }
+        for (CompoundID parent : result.parents[v])
+        {
+            dag.edges.push_back({indexOf[parent], reaction(parent, v)});
+        }
+    }
+    dag.parent_start.push_back(dag.edges.size());
+
+    size_t size = dag.nodes.size();
+    dag.paths_from_source.assign(size, 0);
+    dag.paths_to_destination.assign(size, 0);
+    dag.paths_from_source[0] = 1;
+    for (size_t v = 1; v < size; ++v)
+    {
+        for (size_t e = dag.parent_start[v]; e < dag.parent_start[v + 1]; ++e)
+        {
+            dag.paths_from_source[v] += dag.paths_from_source[dag.edges[e].parent];
+        }
+    }
+    dag.paths_to_destination[size - 1] = 1;
+    for (size_t v = size; v-- > 0;)
+    {
+        for (size_t e = dag.parent_start[v]; e < dag.parent_start[v + 1]; ++e)
+        {
+            dag.paths_to_destination[dag.edges[e].parent] += dag.paths_to_destination[v];
+        }
+    }
+    return dag;
+}
+
+ShortestPathDag build_shortest_path_dag(const AdjacencyGraph &graph, CompoundID srcID, CompoundID destID)
+{
+    return build_shortest_path_dag(graph, bfs(graph, srcID), destID);
+}
+
+int path_length(const ShortestPathDag &dag)
+{
+    return (int)dag.layer_start.size() - 2;
+}
+
+uint64_t count_paths(const ShortestPathDag &dag)
+{
+    return dag.nodes.empty() ? 0 : dag.paths_from_source.back();
+}
+
+Path get_path(const ShortestPathDag &dag, uint64_t index)
+{
+    int length = path_length(dag);
+    Path path(std::max(length, 0));
+    size_t v = dag.nodes.size() - 1;
+    for (int position = length - 1; position >= 0; --position)
+    {
+        for (size_t e = dag.parent_start[v]; e < dag.parent_start[v + 1]; ++e)
+        {
+            uint64_t through = dag.paths_from_source[dag.edges[e].parent];
+            if (index < through)
+            {
+                path[position] = dag.edges[e].reaction;
+                v = dag.edges[e].parent;
+                break;
+            }
+            index -= through;
+        }
+    }
+    return path;
+}
+
+void for_each_path(const ShortestPathDag &dag, const std::function<void(const Path &)> &visit)
+{
+    if (dag.nodes.empty())
+    {
+        return;
+    }
+    size_t length = path_length(dag);
+    Path path(length);
+    std::vector<size_t> stackNode(length + 1), stackNext(length + 1);
+    long depth = 0;
+    stackNode[0] = dag.nodes.size() - 1;
+    stackNext[0] = dag.parent_start[stackNode[0]];
+    while (depth >= 0)
+    {
+        size_t v = stackNode[depth];
+        if ((size_t)depth == length)
+        {
+            visit(path);
+            depth--;
+        }
+        else if (stackNext[depth] < dag.parent_start[v + 1])
+        {
+            const DagEdge &edge = dag.edges[stackNext[depth]++];
+            path[length - 1 - depth] = edge.reaction;
+            depth++;
+            stackNode[depth] = edge.parent;
+            stackNext[depth] = dag.parent_start[edge.parent];
+        }
+        else
+        {
+            depth--;
+        }
+    }
+}
+
+Paths to_paths(const ShortestPathDag &dag)
+{
+    Paths paths;
+    paths.reserve(count_paths(dag));
+    auto collect = [&](const Path &path)
+    {
+        paths.push_back(path);
+    };
+    for_each_path(dag, collect);
+    return paths;
+}
+
+Path find_fastest_path(const Network &network, const ShortestPathDag &dag, const Concentrations &initial_concentrations,
+                       double dt, DagSearchStats *stats)
+{
+    DagSearchStats counters = {0, 0};
+    Path bestPath;
+    if (dag.nodes.empty())
+    {
+        if (stats)
+        {
+            *stats = counters;
+        }
+        return bestPath;
+    }
+    size_t length = path_length(dag);
+    size_t size = dag.nodes.size();
+
+    // per edge: the reaction's rate never exceeds V_plus, whatever the concentrations
+    std::vector<double> bound(dag.edges.size());
+    for (size_t e = 0; e < dag.edges.size(); ++e)
+    {
+        bound[e] = network.reactions[dag.edges[e].reaction].V_plus;
+    }
+    // per node: best bottleneck bound over the paths source -> node
+    std::vector<double> widest(size, DBL_MAX);
+    for (size_t v = 1; v < size; ++v)
+    {
+        widest[v] = -DBL_MAX;
+        for (size_t e = dag.parent_start[v]; e < dag.parent_start[v + 1]; ++e)
+        {
+            widest[v] = std::max(widest[v], std::min(bound[e], widest[dag.edges[e].parent]));
+        }
+    }
+
+    // the compiled path is filled from its end while walking dest -> source,
+    // so every path reuses the suffix it shares with the previous one
+    CompiledPath compiled;
+    compiled.reactions.resize(length);
+    compiled.steps.resize(length);
+    compiled.compounds.resize(length + 1);
+    compiled.compounds[length] = dag.destination;
+    PathState state, scratch;
+
+    std::vector<size_t> stackNode(length + 1), stackNext(length + 1);
+    std::vector<double> bottleneck(length + 1);
+    double maxPathRate = INT_MIN;
+    long depth = 0;
+    stackNode[0] = size - 1;
+    stackNext[0] = dag.parent_start[size - 1];
+    bottleneck[0] = DBL_MAX;
+    while (depth >= 0)
+    {
+        size_t v = stackNode[depth];
+        if ((size_t)depth == length)
+        {
+            if (length == 1)
+            {
+                // compute_coumpound_path keeps the reaction's own direction for single reactions
+                compiled.compounds[0] = compiled.steps[0].compounds.first;
+                compiled.compounds[1] = compiled.steps[0].compounds.second;
+            }
+            initial_path_state(compiled, initial_concentrations, state);
+            solve_ss_state(compiled, state, scratch, dt);
+            double pathRate = compute_path_rate(compiled, state);
+            counters.evaluated++;
+            if (pathRate > maxPathRate)
+            {
+                maxPathRate = pathRate;
+                bestPath = compiled.reactions;
+            }
+            depth--;
+        }
+        else if (stackNext[depth] < dag.parent_start[v + 1])
+        {
+            size_t e = stackNext[depth]++;
+            const DagEdge &edge = dag.edges[e];
+            double reachable = std::min(bottleneck[depth], std::min(bound[e], widest[edge.parent]));
+            // rates stay strictly below their bound, so an equal bound cannot win either
+            if (reachable <= maxPathRate)
+            {
+                counters.pruned += dag.paths_from_source[edge.parent];
+                continue;
+            }
+            size_t position = length - 1 - depth;
+            compiled.reactions[position] = edge.reaction;
+            compiled.steps[position] = network.reactions[edge.reaction];
+            compiled.compounds[position] = dag.nodes[edge.parent];
+            depth++;
+            stackNode[depth] = edge.parent;
+            stackNext[depth] = dag.parent_start[edge.parent];
+            bottleneck[depth] = std::min(bottleneck[depth - 1], bound[e]);
+        }
+        else
+        {
+            depth--;
+        }
+    }
+
+    if (stats)
+    {
+        *stats = counters;
+    }
+    return bestPath;
+}
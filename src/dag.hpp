@@ -0,0 +1,100 @@
+/*
+ * Mini-projet 3 : shortest path DAG
+ */
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "pathsearch.hpp"
+
+/*-----------------  TYPES AND DATA STRUCTURES    ------------*/
+
+struct DagEdge
+{
+    size_t parent;       // node index of the compound closer to the source
+    ReactionID reaction; // reaction linking the parent to the child
+};
+
+/*!
+ * All the shortest paths between two compounds, kept as the layered DAG of
+ * BFS parents instead of a list. Nodes are the compounds lying on at least
+ * one shortest path, numbered layer by layer (layer k == distance k from the
+ * source). The parent edges of each node keep the order of BFS::parents, so
+ * paths are numbered in the same order as find_all_shortest_paths.
+ */
+struct ShortestPathDag
+{
+    CompoundID source;
+    CompoundID destination;
+    std::vector<CompoundID> nodes;       // node index -> compound
+    std::vector<size_t> layer_start;     // nodes of layer k: [layer_start[k], layer_start[k + 1])
+    std::vector<size_t> parent_start;    // parent edges of node v: [parent_start[v], parent_start[v + 1])
+    std::vector<DagEdge> edges;
+    std::vector<uint64_t> paths_from_source;      // number of shortest paths source -> node
+    std::vector<uint64_t> paths_to_destination;   // number of shortest paths node -> destination
+};
+
+// Counters of a DAG ranking: every path is either evaluated or pruned
+struct DagSearchStats
+{
+    uint64_t evaluated;
+    uint64_t pruned;
+};
+
+///------------- Construction -------------
+
+/*!
+ * @brief extracts the shortest path DAG towards destID from a BFS result
+ * @return a DAG without nodes if destID is not reachable
+ */
+ShortestPathDag build_shortest_path_dag(const AdjacencyGraph &graph, const BFS &result, CompoundID destID);
+
+/*!
+ * @brief same DAG, with the reaction of each edge given by reaction(parent, child)
+ * For graphs whose edges name other reactions than the adjacency graph's.
+ */
+ShortestPathDag build_shortest_path_dag(const BFS &result, CompoundID destID,
+                                        const std::function<ReactionID(CompoundID, CompoundID)> &reaction);
+
+/*!
+ * @brief runs bfs() from srcID and extracts the shortest path DAG towards destID
+ */
+ShortestPathDag build_shortest_path_dag(const AdjacencyGraph &graph, CompoundID srcID, CompoundID destID);
+
+///------------- Path level operations -------------
+
+/*!
+ * @brief length (number of reactions) of every path of the DAG, -1 if it has none
+ */
+int path_length(const ShortestPathDag &dag);
+
+/*!
+ * @brief number of shortest paths, without enumerating them
+ */
+uint64_t count_paths(const ShortestPathDag &dag);
+
+/*!
+ * @brief the index-th path, in find_all_shortest_paths order
+ */
+Path get_path(const ShortestPathDag &dag, uint64_t index);
+
+/*!
+ * @brief calls visit on every path in find_all_shortest_paths order
+ * The same Path object is reused between calls.
+ */
+void for_each_path(const ShortestPathDag &dag, const std::function<void(const Path &)> &visit);
+
+/*!
+ * @brief expands the DAG into the list returned by find_all_shortest_paths
+ */
+Paths to_paths(const ShortestPathDag &dag);
+
+/*!
+ * @brief fastest path of the DAG, same answer as find_fastest_path on to_paths(dag)
+ * Edge orientations and rate bounds (V_plus caps the reversible rate of a
+ * reaction) are computed once per edge. The walk shares path prefixes and
+ * skips every subtree whose widest bottleneck cannot beat the best rate so far.
+ * @param stats if not null, receives how many paths were evaluated and pruned
+ */
+Path find_fastest_path(const Network &network, const ShortestPathDag &dag, const Concentrations &initial_concentrations,
+                       double dt, DagSearchStats *stats = nullptr);
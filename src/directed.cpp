@@ -0,0 +1,185 @@
+/*
+ * Mini-projet 3 : direction and thermodynamics aware search graph
+ */
+#include "directed.hpp"
+#include <algorithm>
+#include <climits>
+#include <queue>
+
+namespace
+{
+    // order of the edges of a compound, for std::lower_bound
+    bool edge_before(const DirectedEdge &edge, CompoundID compound)
+    {
+        return edge.to < compound;
+    }
+
+    // same walk as recursive_find_paths, looking reactions up from parent to child
+    void recursive_find_paths(const DirectedSearchGraph &graph, const BFS &result, CompoundID src, CompoundID dest,
+                              Path &currentPath, Paths &allPaths)
+    {
+        if (src == dest)
+        {
+            allPaths.push_back(currentPath);
+            return;
+        }
+
+        for (CompoundID parent : result.parents[dest])
+        {
+            currentPath.push_back(find_reactionID(graph, parent, dest));
+            recursive_find_paths(graph, result, src, parent, currentPath, allPaths);
+            currentPath.pop_back();
+        }
+    }
+}
+
+double feasibility(const Reaction &reaction, bool forward)
+{
+    double forwardEfficiency = reaction.V_plus / reaction.K_S;
+    double backwardEfficiency = reaction.V_minus / reaction.K_P;
+    double total = forwardEfficiency + backwardEfficiency;
+    if (total <= 0)
+    {
+        return 0.0; // runs in neither direction
+    }
+    return (forward ? forwardEfficiency : backwardEfficiency) / total;
+}
+
+DirectedSearchGraph build_directed_search_graph(const Network &network)
+{
+    return build_directed_search_graph(network, build_adjacency_graph(network));
+}
+
+DirectedSearchGraph build_directed_search_graph(const Network &network, const AdjacencyGraph &graph)
+{
+    DirectedSearchGraph directed;
+    directed.edges.resize(graph.size());
+    for (size_t c = 0; c < graph.size(); ++c)
+    {
+        directed.edges[c].reserve(graph[c].size());
+        for (const std::pair<const CompoundID, ReactionID> &pair : graph[c])
+        {
+            const Reaction &reaction = network.reactions[pair.second];
+            bool forward = reaction.compounds.first == (CompoundID)c;
+            directed.edges[c].push_back({pair.first, pair.second, forward, feasibility(reaction, forward)});
+        }
+    }
+    // the adjacency graph keeps the first reaction between two compounds; each
+    // direction takes the reaction that runs best that way
+    for (ReactionID r = 0; r < (ReactionID)network.reactions.size(); ++r)
+    {
+        const Reaction &reaction = network.reactions[r];
+        for (bool forward : {true, false})
+        {
+            CompoundID from = forward ? reaction.compounds.first : reaction.compounds.second;
+            CompoundID to = forward ? reaction.compounds.second : reaction.compounds.first;
+            std::vector<DirectedEdge> &edges = directed.edges[from];
+            std::vector<DirectedEdge>::iterator it = std::lower_bound(edges.begin(), edges.end(), to, edge_before);
+            double score = feasibility(reaction, forward);
+            if (it != edges.end() && it->to == to && score > it->feasibility)
+            {
+                *it = {to, r, forward, score};
+            }
+        }
+    }
+    return directed;
+}
+
+size_t count_feasible_edges(const DirectedSearchGraph &graph, double min_feasibility)
+{
+    size_t count = 0;
+    for (const std::vector<DirectedEdge> &edges : graph.edges)
+    {
+        for (const DirectedEdge &edge : edges)
+        {
+            count += edge.feasibility >= min_feasibility;
+        }
+    }
+    return count;
+}
+
+BFS bfs(const DirectedSearchGraph &graph, CompoundID start, double min_feasibility)
+{
+    BFS result;
+    size_t size = graph.edges.size();
+    result.start = start;
+    result.parents.resize(size);
+    result.parents[start] = {-1};
+    result.distances.assign(size, INT_MAX);
+    result.distances[start] = 0;
+
+    std::queue<CompoundID> queue;
+    queue.push(start);
+    while (!queue.empty())
+    {
+        CompoundID currentNode = queue.front();
+        queue.pop();
+        for (const DirectedEdge &edge : graph.edges[currentNode])
+        {
+            if (edge.feasibility < min_feasibility)
+            {
+                continue;
+            }
+            if (result.distances[edge.to] > result.distances[currentNode] + 1)
+            {
+                result.distances[edge.to] = result.distances[currentNode] + 1;
+                queue.push(edge.to);
+                result.parents[edge.to] = {currentNode};
+            }
+            else if (result.distances[edge.to] == result.distances[currentNode] + 1)
+            {
+                result.parents[edge.to].push_back(currentNode);
+            }
+        }
+    }
+
+    return result;
+}
+
+ReactionID find_reactionID(const DirectedSearchGraph &graph, CompoundID from, CompoundID to)
+{
+    const std::vector<DirectedEdge> &edges = graph.edges[from];
+    std::vector<DirectedEdge>::const_iterator it = std::lower_bound(edges.begin(), edges.end(), to, edge_before);
+    return it != edges.end() && it->to == to ? it->reaction : -1;
+}
+
+Path find_shortest_path(const DirectedSearchGraph &graph, CompoundID srcID, CompoundID destID, double min_feasibility)
+{
+    BFS result = bfs(graph, srcID, min_feasibility);
+    Path path;
+    if (result.distances[destID] == INT_MAX)
+    {
+        return path;
+    }
+    for (CompoundID currentNode = destID; result.parents[currentNode][0] != -1; currentNode = result.parents[currentNode][0])
+    {
+        path.push_back(find_reactionID(graph, result.parents[currentNode][0], currentNode));
+    }
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+Paths find_all_shortest_paths(const DirectedSearchGraph &graph, CompoundID srcID, CompoundID destID, double min_feasibility)
+{
+    BFS result = bfs(graph, srcID, min_feasibility);
+    Paths allPaths;
+    Path currentPath;
+    if (result.distances[destID] != INT_MAX)
+    {
+        recursive_find_paths(graph, result, srcID, destID, currentPath, allPaths);
+    }
+    for (Path &path : allPaths)
+    {
+        std::reverse(path.begin(), path.end());
+    }
+    return allPaths;
+}
+
+ShortestPathDag build_shortest_path_dag(const DirectedSearchGraph &graph, const BFS &result, CompoundID destID)
+{
+    auto reaction = [&](CompoundID parent, CompoundID child)
+    {
+        return find_reactionID(graph, parent, child);
+    };
+    return build_shortest_path_dag(result, destID, reaction);
+}
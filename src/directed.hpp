@@ -0,0 +1,86 @@
+/*
+ * Mini-projet 3 : direction and thermodynamics aware search graph
+ */
+#pragma once
+#include <vector>
+#include "pathsearch.hpp"
+#include "dag.hpp"
+
+/*-----------------  TYPES AND DATA STRUCTURES    ------------*/
+
+// Edges whose feasibility is below this are skipped by default
+const double DEFAULT_MIN_FEASIBILITY = 0.2;
+
+// One direction of a reaction, leaving the compound that owns the edge
+struct DirectedEdge
+{
+    CompoundID to;
+    ReactionID reaction;
+    bool forward; // the edge goes from the substrate to the product of the reaction
+    double feasibility;
+};
+
+/*!
+ * The adjacency graph with each edge annotated by the direction in which it
+ * runs the reaction and how much of the reaction's capacity can flow that
+ * way. Same edges, in the same order, as build_adjacency_graph. Where several
+ * reactions link two compounds, each direction uses the most feasible one
+ * rather than the adjacency graph's first. Without such parallel reactions,
+ * a threshold of 0 gives every search the result of its AdjacencyGraph version.
+ */
+struct DirectedSearchGraph
+{
+    // vector index == CompoundID, edges sorted by DirectedEdge::to
+    std::vector<std::vector<DirectedEdge>> edges;
+};
+
+///------------- Construction -------------
+
+/*!
+ * @brief share of a reaction's catalytic efficiency that runs in one direction
+ * (V+/K_S) / (V+/K_S + V-/K_P) forward, its complement backward: near 0 when
+ * the reaction barely runs that way
+ */
+double feasibility(const Reaction &reaction, bool forward);
+
+/*!
+ * @brief annotates the edges of build_adjacency_graph(network)
+ */
+DirectedSearchGraph build_directed_search_graph(const Network &network);
+DirectedSearchGraph build_directed_search_graph(const Network &network, const AdjacencyGraph &graph);
+
+/*!
+ * @brief edges at or above min_feasibility, out of all edges
+ */
+size_t count_feasible_edges(const DirectedSearchGraph &graph, double min_feasibility);
+
+///------------- Searches -------------
+
+/*!
+ * @brief bfs() over the edges whose feasibility is at least min_feasibility
+ * The parents of the result only use such edges; build its DAG with the
+ * DirectedSearchGraph overload of build_shortest_path_dag.
+ */
+BFS bfs(const DirectedSearchGraph &graph, CompoundID start, double min_feasibility = DEFAULT_MIN_FEASIBILITY);
+
+/*!
+ * @brief reaction of the edge from a compound to another, -1 if there is none
+ */
+ReactionID find_reactionID(const DirectedSearchGraph &graph, CompoundID from, CompoundID to);
+
+/*!
+ * @brief shortest paths along feasible edges only
+ * They may be longer than the shortest paths of the adjacency graph, or not
+ * exist where a step would have to run a reaction backwards.
+ */
+Path find_shortest_path(const DirectedSearchGraph &graph, CompoundID srcID, CompoundID destID,
+                        double min_feasibility = DEFAULT_MIN_FEASIBILITY);
+Paths find_all_shortest_paths(const DirectedSearchGraph &graph, CompoundID srcID, CompoundID destID,
+                              double min_feasibility = DEFAULT_MIN_FEASIBILITY);
+
+/*!
+ * @brief shortest path DAG of a bfs() of the directed graph towards destID
+ * Edges name the reaction the directed graph runs from parent to child, which
+ * differs from the adjacency graph's where parallel reactions exist.
+ */
+ShortestPathDag build_shortest_path_dag(const DirectedSearchGraph &graph, const BFS &result, CompoundID destID);
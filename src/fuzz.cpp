@@ -0,0 +1,716 @@
+/*
+ * Mini-projet 3 : randomized differential testing
+ */
+#include "fuzz.hpp"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <iomanip>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include "anytime.hpp"
+#include "compact_bfs.hpp"
+#include "components.hpp"
+#include "dag.hpp"
+#include "graph_view.hpp"
+#include "kernels.hpp"
+#include "kinetics.hpp"
+#include "near_shortest.hpp"
+#include "oracle.hpp"
+#include "partition.hpp"
+#include "parallel_bfs.hpp"
+#include "parallel_paths.hpp"
+#include "pathset.hpp"
+#include "random.hpp"
+#include "ratelaw.hpp"
+#include "reorder.hpp"
+#include "screening.hpp"
+#include "shard.hpp"
+#include "stream_io.hpp"
+#include "topk.hpp"
+#include "utils.hpp"
+
+namespace
+{
+    // threads given to the parallel engines, more than one even on a single core
+    const unsigned FUZZ_THREADS = 3;
+    // the kinetic properties only simulate queries with at most this many shortest paths
+    const size_t MAX_SIMULATED_PATHS = 16;
+
+    bool close(double expected, double computed)
+    {
+        return std::fabs(expected - computed) <= FUZZ_TOLERANCE * std::max(1.0, std::fabs(expected));
+    }
+
+    Paths sorted(Paths paths)
+    {
+        std::sort(paths.begin(), paths.end());
+        return paths;
+    }
+
+    std::string describe(const std::string &engine, const std::string &what)
+    {
+        return engine + ": " + what;
+    }
+
+    // rate of a path with the reference solver
+    double reference_rate(const FuzzCase &c, const Path &path)
+    {
+        return compute_path_rate(c.network, path, compute_ss_concentration(c.network, path, c.initial, FUZZ_DT));
+    }
+
+    // every simple path of at most maxLength reactions, by brute force
+    void simple_paths(const AdjacencyGraph &graph, CompoundID current, CompoundID dest, size_t maxLength,
+                      std::vector<bool> &visited, Path &path, Paths &paths)
+    {
+        if (current == dest)
+        {
+            paths.push_back(path);
+            return;
+        }
+        if (path.size() == maxLength)
+        {
+            return;
+        }
+        visited[current] = true;
+        for (const std::pair<const CompoundID, ReactionID> &pair : graph[current])
+        {
+            if (!visited[pair.first])
+            {
+                path.push_back(pair.second);
+                simple_paths(graph, pair.first, dest, maxLength, visited, path, paths);
+                path.pop_back();
+            }
+        }
+        visited[current] = false;
+    }
+
+    // about one compound in four, chosen from the seed so shrinking keeps the mask stable
+    CompoundMask seeded_mask(const FuzzCase &c, size_t size)
+    {
+        CompoundMask mask(size);
+        for (size_t i = 0; i < size; ++i)
+        {
+            SplitMix64 rng(c.seed ^ (i * 0x9e3779b97f4a7c15ULL));
+            if (rng.next() % 4 == 0)
+            {
+                mask.exclude((CompoundID)i);
+            }
+        }
+        return mask;
+    }
+
+    //==================================================================
+    //                          PROPERTIES
+    //==================================================================
+
+    std::string check_bfs(const FuzzCase &c)
+    {
+        AdjacencyGraph graph = build_adjacency_graph(c.network);
+        IndexedGraph indexed = build_indexed_graph(c.network, 2);
+        ReorderedNetwork reordered = reorder_network(c.network, ORDER_RCM);
+        CompoundMask none(graph.size());
+        GraphView view = {&graph, &none};
+        CompactBFS compact;
+        for (CompoundID src = 0; src < (CompoundID)graph.size(); ++src)
+        {
+            BFS expected = bfs(graph, src);
+            std::string from = " from " + std::to_string(src);
+            BFS parallel = parallel_bfs(graph, src, FUZZ_THREADS);
+            if (parallel.distances != expected.distances || parallel.parents != expected.parents)
+            {
+                return describe("parallel_bfs", "differs" + from);
+            }
+            compact_bfs(graph, src, compact);
+            BFS unpacked = compact.to_bfs();
+            if (unpacked.distances != expected.distances || unpacked.parents != expected.parents)
+            {
+                return describe("compact_bfs", "differs" + from);
+            }
+            BFS components = bfs(indexed, src);
+            if (components.distances != expected.distances || components.parents != expected.parents)
+            {
+                return describe("bfs(IndexedGraph)", "differs" + from);
+            }
+            if (bfs(view, src).distances != expected.distances)
+            {
+                return describe("bfs(GraphView)", "distances differ" + from);
+            }
+            if (bfs(reordered, src).distances != expected.distances)
+            {
+                return describe("bfs(ReorderedNetwork)", "distances differ" + from);
+            }
+        }
+        return "";
+    }
+
+    std::string check_shortest_paths(const FuzzCase &c)
+    {
+        AdjacencyGraph graph = build_adjacency_graph(c.network);
+        Paths expected = find_all_shortest_paths(graph, c.src, c.dest);
+        Path shortest = find_shortest_path(graph, c.src, c.dest);
+        if (expected.empty() != shortest.empty() ||
+            (!shortest.empty() && std::find(expected.begin(), expected.end(), shortest) == expected.end()))
+        {
+            return describe("find_shortest_path", "not one of find_all_shortest_paths");
+        }
+
+        PathSet set;
+        ScratchArena arena;
+        find_all_shortest_paths(graph, c.src, c.dest, set, arena);
+        if (set.to_paths() != expected)
+        {
+            return describe("find_all_shortest_paths(PathSet)", "differs");
+        }
+        ShortestPathDag dag = build_shortest_path_dag(graph, c.src, c.dest);
+        if (to_paths(dag) != expected)
+        {
+            return describe("build_shortest_path_dag", "differs");
+        }
+        if (!expected.empty() && to_paths_parallel(dag, FUZZ_THREADS) != expected)
+        {
+            return describe("to_paths_parallel", "differs");
+        }
+
+        IndexedGraph indexed = build_indexed_graph(c.network, 2);
+        if (find_all_shortest_paths(indexed, c.src, c.dest) != expected || find_shortest_path(indexed, c.src, c.dest) != shortest)
+        {
+            return describe("IndexedGraph", "paths differ");
+        }
+        CompoundMask none(graph.size());
+        GraphView view = {&graph, &none};
+        if (find_all_shortest_paths(view, c.src, c.dest) != expected || find_shortest_path(view, c.src, c.dest) != shortest)
+        {
+            return describe("GraphView", "paths differ");
+        }
+        ReorderedNetwork reordered = reorder_network(c.network, ORDER_RCM);
+        if (sorted(find_all_shortest_paths(reordered, c.src, c.dest)) != sorted(expected))
+        {
+            return describe("ReorderedNetwork", "paths differ");
+        }
+        int distance = expected.empty() ? -1 : (int)expected[0].size();
+        if (DistanceOracle::build(graph).distance(c.src, c.dest) != distance)
+        {
+            return describe("DistanceOracle", "distance differs");
+        }
+
+        if (sorted(find_near_shortest_paths(graph, c.src, c.dest, 0)) != sorted(expected))
+        {
+            return describe("find_near_shortest_paths", "slack 0 differs from the shortest paths");
+        }
+        if (!expected.empty())
+        {
+            std::vector<bool> visited(graph.size(), false);
+            Path path;
+            Paths brute;
+            simple_paths(graph, c.src, c.dest, (size_t)distance + 1, visited, path, brute);
+            if (sorted(find_near_shortest_paths(graph, c.src, c.dest, 1)) != sorted(brute))
+            {
+                return describe("find_near_shortest_paths", "slack 1 differs from brute force");
+            }
+        }
+        return "";
+    }
+
+    // a view must answer like the graph with the masked compounds' reactions removed
+    std::string check_graph_view(const FuzzCase &c)
+    {
+        AdjacencyGraph graph = build_adjacency_graph(c.network);
+        CompoundMask mask = seeded_mask(c, graph.size());
+        GraphView view = {&graph, &mask};
+        AdjacencyGraph filtered = graph;
+        for (CompoundID compound = 0; compound < (CompoundID)graph.size(); ++compound)
+        {
+            if (mask.excluded(compound) && compound != c.src && compound != c.dest)
+            {
+                for (const std::pair<const CompoundID, ReactionID> &pair : graph[compound])
+                {
+                    filtered[pair.first].erase(compound);
+                }
+                filtered[compound].clear();
+            }
+        }
+        Paths expected = find_all_shortest_paths(filtered, c.src, c.dest);
+        if (bfs(view, c.src, c.dest).distances[c.dest] != bfs(filtered, c.src).distances[c.dest])
+        {
+            return describe("bfs(GraphView)", "masked distance differs");
+        }
+        if (find_all_shortest_paths(view, c.src, c.dest) != expected)
+        {
+            return describe("find_all_shortest_paths(GraphView)", "masked paths differ");
+        }
+        if (find_shortest_path(view, c.src, c.dest) != find_shortest_path(filtered, c.src, c.dest))
+        {
+            return describe("find_shortest_path(GraphView)", "masked path differs");
+        }
+        if (to_paths(build_shortest_path_dag(view, c.src, c.dest)) != expected)
+        {
+            return describe("build_shortest_path_dag(GraphView)", "masked paths differ");
+        }
+        if (sorted(find_near_shortest_paths(view, c.src, c.dest, 1)) != sorted(find_near_shortest_paths(filtered, c.src, c.dest, 1)))
+        {
+            return describe("find_near_shortest_paths(GraphView)", "masked paths differ");
+        }
+
+        BFS result = bfs(view, c.src, c.dest);
+        BFS parallel = parallel_bfs(view, c.src, c.dest, FUZZ_THREADS);
+        if (parallel.distances != result.distances || parallel.parents != result.parents)
+        {
+            return describe("parallel_bfs(GraphView)", "differs from bfs(GraphView)");
+        }
+        CompactBFS compact;
+        compact_bfs(view, c.src, c.dest, compact);
+        BFS unpacked = compact.to_bfs();
+        if (unpacked.distances != result.distances || unpacked.parents != result.parents)
+        {
+            return describe("compact_bfs(GraphView)", "differs from bfs(GraphView)");
+        }
+        PathSet set;
+        ScratchArena arena;
+        find_all_shortest_paths(view, c.src, c.dest, set, arena);
+        if (set.to_paths() != expected)
+        {
+            return describe("find_all_shortest_paths(GraphView, PathSet)", "masked paths differ");
+        }
+        if (expected.size() <= MAX_SIMULATED_PATHS)
+        {
+            QueryWorkspace workspace;
+            Path fastest = find_fastest_path(view, c.network, c.src, c.dest, c.initial, FUZZ_DT, workspace).to_path();
+            if (fastest != find_fastest_path(c.network, expected, c.initial, FUZZ_DT))
+            {
+                return describe("find_fastest_path(GraphView, QueryWorkspace)", "masked path differs");
+            }
+        }
+        return "";
+    }
+
+    std::string check_kinetics(const FuzzCase &c)
+    {
+        std::vector<double> concentrations(c.network.compounds.size());
+        for (const std::pair<const CompoundID, double> &pair : c.initial)
+        {
+            concentrations[pair.first] = pair.second;
+        }
+        std::vector<double> rates;
+        compute_network_rates(c.network, concentrations, rates);
+        for (ReactionID r = 0; r < (ReactionID)c.network.reactions.size(); ++r)
+        {
+            const Reaction &reaction = c.network.reactions[r];
+            double expected = michaelis_reversible_rate(reaction, concentrations[reaction.compounds.first], concentrations[reaction.compounds.second]);
+            if (!close(expected, rates[r]))
+            {
+                return describe("compute_network_rates (" + rate_kernel_name() + ")", "rate of reaction " + std::to_string(r) + " differs");
+            }
+        }
+
+        Paths paths = find_all_shortest_paths(build_adjacency_graph(c.network), c.src, c.dest);
+        SteadyStateWorkspace workspace;
+        PathSet simulated;
+        for (size_t i = 0; i < paths.size() && i < MAX_SIMULATED_PATHS; ++i)
+        {
+            const Path &path = paths[i];
+            simulated.push_back(path);
+            std::string which = " on path " + to_string(path);
+            Concentrations expected = compute_ss_concentration(c.network, path, c.initial, FUZZ_DT);
+            double rate = compute_path_rate(c.network, path, expected);
+
+            CompiledPath compiled = compile_path(c.network, path);
+            PathState state = initial_path_state(compiled, c.initial);
+            solve_ss_state(compiled, state, FUZZ_DT);
+            Concentrations computed = to_concentrations(compiled, state);
+            bool same = computed.size() == expected.size();
+            for (const std::pair<const CompoundID, double> &pair : expected)
+            {
+                same = same && computed.count(pair.first) && close(pair.second, computed[pair.first]);
+            }
+            if (!same)
+            {
+                return describe("solve_ss_state", "steady state differs" + which);
+            }
+            if (!close(rate, compute_path_rate(compiled, state)))
+            {
+                return describe("compute_path_rate(CompiledPath)", "rate differs" + which);
+            }
+
+            PathState fixed = initial_path_state(compiled, c.initial);
+            solve_ss_state_fixed(compiled, fixed, FUZZ_DT);
+            if (!close(rate, compute_path_rate_fixed(compiled, fixed)))
+            {
+                return describe("solve_ss_state_fixed", "rate differs" + which);
+            }
+            if (!close(rate, steady_state_rate(c.network, path.data(), path.size(), c.initial, FUZZ_DT, workspace)))
+            {
+                return describe("steady_state_rate", "rate differs" + which);
+            }
+        }
+
+        // double lanes at DELTA take the scalar solver's steps, so they must match it exactly
+        std::vector<double> lanes;
+        std::vector<bool> converged;
+        screen_path_rates<double>(c.network, simulated, c.initial, FUZZ_DT, DELTA, SIZE_MAX, lanes, converged);
+        for (size_t i = 0; i < simulated.size(); ++i)
+        {
+            double rate = steady_state_rate(c.network, simulated[i].data, simulated[i].length, c.initial, FUZZ_DT, workspace);
+            if (lanes[i] != rate || !converged[i])
+            {
+                return describe("screen_path_rates<double>", "rate differs on path " + to_string(paths[i]));
+            }
+        }
+        return "";
+    }
+
+    std::string check_fastest_path(const FuzzCase &c)
+    {
+        AdjacencyGraph graph = build_adjacency_graph(c.network);
+        Paths paths = find_all_shortest_paths(graph, c.src, c.dest);
+        if (paths.size() > MAX_SIMULATED_PATHS)
+        {
+            return "";
+        }
+        std::vector<double> rates;
+        double best = 0;
+        for (const Path &path : paths)
+        {
+            rates.push_back(reference_rate(c, path));
+            best = rates.size() == 1 ? rates.back() : std::max(best, rates.back());
+        }
+        // ties within the tolerance may be settled either way, anything slower is a bug
+        auto check = [&](const std::string &engine, const Path &path) -> std::string
+        {
+            if (paths.empty())
+            {
+                return path.empty() ? "" : describe(engine, "returned a path for an unreachable destination");
+            }
+            std::vector<Path>::const_iterator it = std::find(paths.begin(), paths.end(), path);
+            if (it == paths.end())
+            {
+                return describe(engine, "returned " + to_string(path) + ", not a shortest path");
+            }
+            if (!close(best, rates[it - paths.begin()]))
+            {
+                std::ostringstream what;
+                what << std::setprecision(17) << "returned a path of rate " << rates[it - paths.begin()] << " instead of " << best;
+                return describe(engine, what.str());
+            }
+            return "";
+        };
+
+        std::vector<std::pair<std::string, Path>> answers;
+        answers.push_back({"find_fastest_path", find_fastest_path(c.network, paths, c.initial, FUZZ_DT)});
+        ShortestPathDag dag = build_shortest_path_dag(graph, c.src, c.dest);
+        if (!paths.empty())
+        {
+            answers.push_back({"find_fastest_path(ShortestPathDag)", find_fastest_path(c.network, dag, c.initial, FUZZ_DT)});
+            answers.push_back({"find_fastest_path_parallel", find_fastest_path_parallel(c.network, dag, c.initial, FUZZ_DT, FUZZ_THREADS)});
+            AnytimeResult anytime = find_fastest_path_anytime(c.network, dag, c.initial, FUZZ_DT, QueryBudget());
+            if (!anytime.optimal)
+            {
+                return describe("find_fastest_path_anytime", "not optimal without a budget");
+            }
+            answers.push_back({"find_fastest_path_anytime", anytime.path});
+            PathRanking ranking = find_fastest_paths(c.network, dag, c.initial, FUZZ_DT, 3);
+            if (ranking.size() != std::min<size_t>(3, paths.size()))
+            {
+                return describe("find_fastest_paths", "ranking has " + std::to_string(ranking.size()) + " entries");
+            }
+            for (size_t i = 0; i < ranking.size(); ++i)
+            {
+                if (!close(rates[ranking[i].index], ranking[i].rate) || ranking[i].path != paths[ranking[i].index] ||
+                    (i > 0 && ranking[i].rate > ranking[i - 1].rate))
+                {
+                    return describe("find_fastest_paths", "entry " + std::to_string(i) + " is wrong");
+                }
+            }
+            answers.push_back({"find_fastest_paths", ranking[0].path});
+        }
+        answers.push_back({"find_fastest_path_anytime(Paths)", find_fastest_path_anytime(c.network, paths, c.initial, FUZZ_DT, QueryBudget()).path});
+        QueryWorkspace workspace;
+        answers.push_back({"find_fastest_path(QueryWorkspace)",
+                           find_fastest_path(graph, c.network, c.src, c.dest, c.initial, FUZZ_DT, workspace).to_path()});
+        PathSet set;
+        for (const Path &path : paths)
+        {
+            set.push_back(path);
+        }
+        answers.push_back({"find_fastest_path_screened", find_fastest_path_screened(c.network, set, c.initial, FUZZ_DT).to_path()});
+        ScreeningOptions everyGroup = DEFAULT_SCREENING;
+        everyGroup.min_group = 1;
+        answers.push_back({"find_fastest_path_screened(min_group 1)",
+                           find_fastest_path_screened(c.network, set, c.initial, FUZZ_DT, everyGroup).to_path()});
+        ReorderedNetwork reordered = reorder_network(c.network, ORDER_RCM);
+        answers.push_back({"find_fastest_path(ReorderedNetwork)", find_fastest_path(reordered, paths, c.initial, FUZZ_DT)});
+
+        for (const std::pair<std::string, Path> &answer : answers)
+        {
+            std::string failure = check(answer.first, answer.second);
+            if (!failure.empty())
+            {
+                return failure;
+            }
+        }
+        return "";
+    }
+
+    // a partition of the graph and a hash partition with more shards than compounds
+    std::string check_sharded(const FuzzCase &c)
+    {
+        AdjacencyGraph graph = build_adjacency_graph(c.network);
+        BFS expected = bfs(graph, c.src);
+        Paths paths = find_all_shortest_paths(graph, c.src, c.dest);
+        for (const Partition &partition : {partition_graph(graph, FUZZ_THREADS), hash_partition(graph.size(), (unsigned)graph.size() + 2)})
+        {
+            std::string with = " with " + std::to_string(partition.parts) + " shards";
+            ShardCluster cluster(c.network, c.initial, partition, TRANSPORT_IN_PROCESS);
+            BFS distributed = distributed_bfs(cluster, c.src);
+            if (distributed.distances != expected.distances || distributed.parents != expected.parents)
+            {
+                return describe("distributed_bfs", "differs" + with);
+            }
+            if (distributed_shortest_paths(cluster, c.src, c.dest) != paths)
+            {
+                return describe("distributed_shortest_paths", "differs" + with);
+            }
+        }
+        return "";
+    }
+
+    // every path file format reads back the paths it was given, empty ones included
+    std::string check_path_files(const FuzzCase &c)
+    {
+        AdjacencyGraph graph = build_adjacency_graph(c.network);
+        PathSet paths;
+        for (const Path &path : find_near_shortest_paths(graph, c.src, c.dest, 1))
+        {
+            paths.push_back(path);
+        }
+        paths.push_back(Path());
+        for (const Path &path : find_all_shortest_paths(graph, c.dest, c.src))
+        {
+            paths.push_back(path);
+        }
+        const char *names[] = {"text", "csv", "binary"};
+        for (PathFormat format : {FORMAT_TEXT, FORMAT_CSV, FORMAT_BINARY})
+        {
+            std::stringstream file;
+            {
+                OutputSink out(file);
+                write_paths(out, paths, format);
+            }
+            PathSet read;
+            read_paths(file, read, format);
+            if (read.to_paths() != paths.to_paths())
+            {
+                return describe("read_paths", std::string(names[format]) + " round trip differs");
+            }
+        }
+        return "";
+    }
+
+    // the case without one reaction; the kinetic table follows
+    FuzzCase without_reaction(const FuzzCase &c, size_t reaction)
+    {
+        FuzzCase smaller = c;
+        smaller.network.reactions.erase(smaller.network.reactions.begin() + reaction);
+        smaller.network.kinetics = build_kinetic_table(smaller.network);
+        return smaller;
+    }
+
+    // the case without the compounds that no reaction uses, except the query's
+    FuzzCase without_unused_compounds(const FuzzCase &c)
+    {
+        std::vector<bool> used(c.network.compounds.size(), false);
+        used[c.src] = used[c.dest] = true;
+        for (const Reaction &reaction : c.network.reactions)
+        {
+            used[reaction.compounds.first] = used[reaction.compounds.second] = true;
+        }
+        FuzzCase smaller = c;
+        smaller.network.compounds.clear();
+        smaller.initial.clear();
+        std::vector<CompoundID> renumber(c.network.compounds.size(), -1);
+        for (CompoundID compound = 0; compound < (CompoundID)c.network.compounds.size(); ++compound)
+        {
+            if (used[compound])
+            {
+                renumber[compound] = (CompoundID)smaller.network.compounds.size();
+                smaller.network.compounds.push_back(c.network.compounds[compound]);
+                smaller.initial[renumber[compound]] = c.initial.find(compound)->second;
+            }
+        }
+        for (Reaction &reaction : smaller.network.reactions)
+        {
+            reaction.compounds = {renumber[reaction.compounds.first], renumber[reaction.compounds.second]};
+        }
+        smaller.src = renumber[c.src];
+        smaller.dest = renumber[c.dest];
+        smaller.network.kinetics = build_kinetic_table(smaller.network);
+        return smaller;
+    }
+}
+
+//==================================================================
+//                              CASES
+//==================================================================
+
+FuzzCase generate_case(uint64_t seed, size_t maxCompounds)
+{
+    SplitMix64 rng(seed);
+    FuzzCase c;
+    c.seed = seed;
+    size_t compounds = 2 + rng.next() % (std::max<size_t>(maxCompounds, 2) - 1);
+    for (size_t i = 0; i < compounds; ++i)
+    {
+        c.network.compounds.push_back("C" + std::to_string(i));
+    }
+
+    // a random tree keeps most queries reachable, extra reactions create ties and cycles;
+    // sometimes the tree is skipped to get several components
+    std::set<std::pair<CompoundID, CompoundID>> pairs;
+    auto react = [&](CompoundID a, CompoundID b)
+    {
+        if (a == b || !pairs.insert({std::min(a, b), std::max(a, b)}).second)
+        {
+            return;
+        }
+        if (rng.next() % 2)
+        {
+            std::swap(a, b);
+        }
+        c.network.reactions.push_back({{a, b},
+                                       rng.next_double(1.0, 10.0),
+                                       rng.next_double(1.0, 10.0),
+                                       rng.next_double(0.1, 1.5),
+                                       rng.next_double(0.1, 1.5)});
+    };
+    if (rng.next() % 8 != 0)
+    {
+        for (size_t i = 1; i < compounds; ++i)
+        {
+            react((CompoundID)i, (CompoundID)(rng.next() % i));
+        }
+    }
+    size_t extra = rng.next() % (2 * compounds + 1);
+    for (size_t i = 0; i < extra; ++i)
+    {
+        react((CompoundID)(rng.next() % compounds), (CompoundID)(rng.next() % compounds));
+    }
+    c.network.kinetics = build_kinetic_table(c.network);
+
+    for (size_t i = 0; i < compounds; ++i)
+    {
+        // a few compounds start almost drained
+        c.initial[(CompoundID)i] = rng.next() % 16 == 0 ? 1e-3 : rng.next_double(0.01, 1.0);
+    }
+    c.src = (CompoundID)(rng.next() % compounds);
+    c.dest = (CompoundID)((c.src + 1 + rng.next() % (compounds - 1)) % compounds);
+    return c;
+}
+
+void write_case(const FuzzCase &fuzzCase, std::ostream &network, std::ostream &concentrations)
+{
+    const std::vector<CompoundName> &compounds = fuzzCase.network.compounds;
+    network << std::setprecision(17);
+    for (const CompoundName &name : compounds)
+    {
+        network << name << std::endl;
+    }
+    network << "----End Compounds ---" << std::endl;
+    network << "####Reactions####" << std::endl;
+    network << "# seed " << fuzzCase.seed << std::endl;
+    for (const Reaction &reaction : fuzzCase.network.reactions)
+    {
+        network << "-----------------------" << std::endl;
+        network << compounds[reaction.compounds.first] << std::endl
+                << compounds[reaction.compounds.second] << std::endl
+                << reaction.V_plus << std::endl
+                << reaction.V_minus << std::endl
+                << reaction.K_S << std::endl
+                << reaction.K_P << std::endl;
+    }
+    network << "-----------------------" << std::endl;
+
+    // lines without '=' are skipped by read_initial_concentrations
+    concentrations << std::setprecision(17);
+    concentrations << "# query " << compounds[fuzzCase.src] << " -> " << compounds[fuzzCase.dest] << std::endl;
+    for (const std::pair<const CompoundID, double> &pair : fuzzCase.initial)
+    {
+        concentrations << "[" << compounds[pair.first] << "]=" << pair.second << std::endl;
+    }
+}
+
+//==================================================================
+//                           PROPERTIES
+//==================================================================
+
+std::vector<NamedProperty> differential_properties()
+{
+    return {{"bfs", check_bfs},
+            {"shortest_paths", check_shortest_paths},
+            {"graph_view", check_graph_view},
+            {"kinetics", check_kinetics},
+            {"fastest_path", check_fastest_path},
+            {"sharded", check_sharded},
+            {"path_files", check_path_files}};
+}
+
+std::string check_property(const FuzzProperty &property, const FuzzCase &fuzzCase)
+{
+    try
+    {
+        return property(fuzzCase);
+    }
+    catch (const std::exception &e)
+    {
+        return std::string("threw ") + e.what();
+    }
+}
+
+//==================================================================
+//                              DRIVER
+//==================================================================
+
+FuzzCase shrink_case(const FuzzCase &failing, const FuzzProperty &property)
+{
+    FuzzCase current = failing;
+    bool progress = true;
+    while (progress)
+    {
+        progress = false;
+        // from the last reaction, so a removal does not shift the ones still to try
+        for (size_t r = current.network.reactions.size(); r-- > 0;)
+        {
+            FuzzCase smaller = without_reaction(current, r);
+            if (!check_property(property, smaller).empty())
+            {
+                current = smaller;
+                progress = true;
+            }
+        }
+    }
+    FuzzCase compact = without_unused_compounds(current);
+    return check_property(property, compact).empty() ? current : compact;
+}
+
+FuzzReport run_fuzz(uint64_t seed, size_t cases, const std::vector<NamedProperty> &properties, size_t maxCompounds)
+{
+    FuzzReport report = {0, 0, 0.0, {}};
+    auto begin = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < cases; ++i)
+    {
+        FuzzCase c = generate_case(seed + i, maxCompounds);
+        report.cases++;
+        for (const NamedProperty &property : properties)
+        {
+            report.checks++;
+            if (!check_property(property.check, c).empty())
+            {
+                FuzzCase shrunk = shrink_case(c, property.check);
+                report.failures.push_back({property.name, check_property(property.check, shrunk), c, shrunk});
+            }
+        }
+    }
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    return report;
+}
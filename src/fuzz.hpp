@@ -0,0 +1,95 @@
+/*
+ * Mini-projet 3 : randomized differential testing
+ */
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "pathsearch.hpp"
+
+/*-----------------  TYPES AND DATA STRUCTURES    ------------*/
+
+// One generated input: a network, its concentrations and a query
+struct FuzzCase
+{
+    uint64_t seed;
+    Network network;
+    Concentrations initial;
+    CompoundID src;
+    CompoundID dest;
+};
+
+// Compares fast engines with the reference on one case.
+// Returns an empty string when they agree, else what differed.
+typedef std::function<std::string(const FuzzCase &)> FuzzProperty;
+
+struct NamedProperty
+{
+    std::string name;
+    FuzzProperty check;
+};
+
+struct FuzzFailure
+{
+    std::string property;
+    std::string message; // on the shrunk case
+    FuzzCase original;
+    FuzzCase shrunk;
+};
+
+struct FuzzReport
+{
+    size_t cases;
+    size_t checks;
+    double seconds;
+    std::vector<FuzzFailure> failures;
+};
+
+// time step of the steady-state solves of the kinetic properties
+const double FUZZ_DT = 1e-2;
+// relative tolerance between two solvers of the same steady state
+const double FUZZ_TOLERANCE = 1e-6;
+
+///------------- Cases -------------
+
+/*!
+ * @brief generates a random network of 2 .. maxCompounds compounds with its
+ * concentrations and a query between two distinct compounds
+ * The same seed always gives the same case. Networks have no self reactions
+ * and at most one reaction per pair of compounds, like the bundled data.
+ */
+FuzzCase generate_case(uint64_t seed, size_t maxCompounds = 24);
+
+/*!
+ * @brief writes a case in the formats of read_network and read_initial_concentrations,
+ * so a failure can be replayed from files (seed and query are written as comments)
+ */
+void write_case(const FuzzCase &fuzzCase, std::ostream &network, std::ostream &concentrations);
+
+///------------- Properties -------------
+
+/*!
+ * @brief every optimized engine against its reference: graph results must be
+ * equal, steady states and rates must agree within FUZZ_TOLERANCE
+ */
+std::vector<NamedProperty> differential_properties();
+
+/*!
+ * @brief runs a property, turning an exception into a failure message
+ */
+std::string check_property(const FuzzProperty &property, const FuzzCase &fuzzCase);
+
+///------------- Driver -------------
+
+/*!
+ * @brief greedily removes reactions, then unused compounds, while the property still fails
+ * @return a case where removing any single reaction makes the property pass
+ */
+FuzzCase shrink_case(const FuzzCase &failing, const FuzzProperty &property);
+
+/*!
+ * @brief checks every property on the cases seed, seed + 1, ... and shrinks each failure
+ */
+FuzzReport run_fuzz(uint64_t seed, size_t cases, const std::vector<NamedProperty> &properties, size_t maxCompounds = 24);
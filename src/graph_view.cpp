@@ -0,0 +1,143 @@
+/*
+ * Mini-projet 3 : filtered graph views
+ */
+#include "graph_view.hpp"
+#include <algorithm>
+#include <climits>
+#include <queue>
+
+CompoundMask::CompoundMask(size_t size) : words((size + 63) / 64, 0), bits(size)
+{
+}
+
+size_t CompoundMask::count() const
+{
+    size_t total = 0;
+    for (uint64_t word : words)
+    {
+        total += __builtin_popcountll(word);
+    }
+    return total;
+}
+
+CompoundMask &CompoundMask::operator|=(const CompoundMask &other)
+{
+    for (size_t i = 0; i < words.size() && i < other.words.size(); ++i)
+    {
+        words[i] |= other.words[i];
+    }
+    return *this;
+}
+
+CompoundMask mask_by_degree(const AdjacencyGraph &graph, size_t maxDegree)
+{
+    CompoundMask mask(graph.size());
+    for (size_t c = 0; c < graph.size(); ++c)
+    {
+        if (graph[c].size() > maxDegree)
+        {
+            mask.exclude((CompoundID)c);
+        }
+    }
+    return mask;
+}
+
+CompoundMask mask_by_names(const Network &network, const std::vector<CompoundName> &names)
+{
+    CompoundMask mask(network.compounds.size());
+    for (const CompoundName &name : names)
+    {
+        CompoundID id = find_compoundID(network, name);
+        if (id != -1)
+        {
+            mask.exclude(id);
+        }
+    }
+    return mask;
+}
+
+CompoundMask mask_by_predicate(size_t size, const std::function<bool(CompoundID)> &exclude)
+{
+    CompoundMask mask(size);
+    for (size_t c = 0; c < size; ++c)
+    {
+        if (exclude((CompoundID)c))
+        {
+            mask.exclude((CompoundID)c);
+        }
+    }
+    return mask;
+}
+
+BFS bfs(const GraphView &view, CompoundID start, CompoundID destID)
+{
+    const AdjacencyGraph &graph = *view.graph;
+    BFS result;
+    size_t size = graph.size();
+    result.start = start;
+    result.parents.resize(size);
+    result.parents[start] = {-1};
+    result.distances.assign(size, INT_MAX);
+    result.distances[start] = 0;
+
+    std::queue<CompoundID> queue;
+    queue.push(start);
+    while (!queue.empty())
+    {
+        CompoundID currentNode = queue.front();
+        queue.pop();
+        for (const std::pair<const CompoundID, ReactionID> &pair : graph[currentNode])
+        {
+            if (!view.allowed(pair.first, start, destID))
+            {
+                continue;
+            }
+            if (result.distances[pair.first] > result.distances[currentNode] + 1)
+            {
+                result.distances[pair.first] = result.distances[currentNode] + 1;
+                queue.push(pair.first);
+                result.parents[pair.first] = {currentNode};
+            }
+            else if (result.distances[pair.first] == result.distances[currentNode] + 1)
+            {
+                result.parents[pair.first].push_back(currentNode);
+            }
+        }
+    }
+
+    return result;
+}
+
+Path find_shortest_path(const GraphView &view, CompoundID srcID, CompoundID destID)
+{
+    BFS result = bfs(view, srcID, destID);
+    Path path;
+    if (result.distances[destID] == INT_MAX)
+    {
+        return path;
+    }
+    for (CompoundID currentNode = destID; result.parents[currentNode][0] != -1; currentNode = result.parents[currentNode][0])
+    {
+        path.push_back(find_reactionID(*view.graph, currentNode, result.parents[currentNode][0]));
+    }
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+Paths find_all_shortest_paths(const GraphView &view, CompoundID srcID, CompoundID destID)
+{
+    BFS result = bfs(view, srcID, destID);
+    Paths allPaths;
+    Path currentPath;
+    recursive_find_paths(*view.graph, result, srcID, destID, currentPath, allPaths);
+    for (Path &path : allPaths)
+    {
+        std::reverse(path.begin(), path.end());
+    }
+    return allPaths;
+}
+
+ShortestPathDag build_shortest_path_dag(const GraphView &view, CompoundID srcID, CompoundID destID)
+{
+    return build_shortest_path_dag(*view.graph, bfs(view, srcID, destID), destID);
+}
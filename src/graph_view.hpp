@@ -0,0 +1,89 @@
+/*
+ * Mini-projet 3 : filtered graph views
+ */
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "pathsearch.hpp"
+#include "dag.hpp"
+
+/*-----------------  TYPES AND DATA STRUCTURES    ------------*/
+
+/*!
+ * One bit per compound, set for the compounds a search must not go through.
+ * A mask is a few kilobytes even for large networks, so every filter policy
+ * can keep its own and a query just points its view at one.
+ */
+class CompoundMask
+{
+public:
+    explicit CompoundMask(size_t size = 0);
+
+    size_t size() const { return bits; }
+    bool excluded(CompoundID compound) const { return (words[compound >> 6] >> (compound & 63)) & 1; }
+    void exclude(CompoundID compound) { words[compound >> 6] |= uint64_t(1) << (compound & 63); }
+    void include(CompoundID compound) { words[compound >> 6] &= ~(uint64_t(1) << (compound & 63)); }
+    // number of excluded compounds
+    size_t count() const;
+    // excludes what either mask excludes
+    CompoundMask &operator|=(const CompoundMask &other);
+
+private:
+    std::vector<uint64_t> words;
+    size_t bits;
+};
+
+/*!
+ * A graph seen without the compounds of a mask. Neither is copied: the view
+ * only points at them, so both must outlive it. The source and destination
+ * of a query are never filtered out, so a path can still start or end at a
+ * masked cofactor.
+ */
+struct GraphView
+{
+    const AdjacencyGraph *graph;
+    const CompoundMask *mask; // null for no filtering
+
+    // false for masked compounds, unless they are one of the exempted endpoints
+    bool allowed(CompoundID compound, CompoundID exempt1 = -1, CompoundID exempt2 = -1) const
+    {
+        return !mask || compound == exempt1 || compound == exempt2 || !mask->excluded(compound);
+    }
+};
+
+///------------- Masks -------------
+
+/*!
+ * @brief excludes the compounds linked to more than maxDegree others (cofactor-like hubs)
+ */
+CompoundMask mask_by_degree(const AdjacencyGraph &graph, size_t maxDegree);
+
+/*!
+ * @brief excludes the listed compounds; names missing from the network are ignored
+ */
+CompoundMask mask_by_names(const Network &network, const std::vector<CompoundName> &names);
+
+/*!
+ * @brief excludes the compounds for which exclude returns true
+ */
+CompoundMask mask_by_predicate(size_t size, const std::function<bool(CompoundID)> &exclude);
+
+///------------- Searches on a view -------------
+
+/*!
+ * @brief bfs() that does not enter masked compounds (start and destID excepted)
+ */
+BFS bfs(const GraphView &view, CompoundID start, CompoundID destID = -1);
+
+Path find_shortest_path(const GraphView &view, CompoundID srcID, CompoundID destID);
+Paths find_all_shortest_paths(const GraphView &view, CompoundID srcID, CompoundID destID);
+
+/*!
+ * @brief shortest path DAG on the view; every DAG query (fastest, top-k,
+ * anytime, parallel enumeration) then runs on the filtered graph
+ * The other engines declare their view overloads next to their
+ * AdjacencyGraph versions: PathSet and QueryWorkspace searches (pathset.hpp),
+ * parallel_bfs, compact_bfs and the near-shortest paths.
+ */
+ShortestPathDag build_shortest_path_dag(const GraphView &view, CompoundID srcID, CompoundID destID);
@@ -0,0 +1,50 @@
+/*
+ * Mini-projet 3 : fixed length path kernels
+ */
+#include "kernels.hpp"
+#include <utility>
+
+namespace
+{
+    typedef size_t (*SolveKernel)(const CompiledPath &, PathState &, double);
+    typedef double (*RateKernel)(const CompiledPath &, const PathState &);
+
+    size_t solve_generic(const CompiledPath &path, PathState &state, double dt)
+    {
+        return solve_ss_state(path, state, dt);
+    }
+
+    double rate_generic(const CompiledPath &path, const PathState &state)
+    {
+        return compute_path_rate(path, state);
+    }
+
+    // entry 0 is the generic kernel, entry N the kernel for N reactions
+    template <size_t... N>
+    std::array<SolveKernel, sizeof...(N) + 1> make_solve_table(std::index_sequence<N...>)
+    {
+        return {{&solve_generic, &FixedPathKernel<N + 1>::solve...}};
+    }
+
+    template <size_t... N>
+    std::array<RateKernel, sizeof...(N) + 1> make_rate_table(std::index_sequence<N...>)
+    {
+        return {{&rate_generic, &FixedPathKernel<N + 1>::path_rate...}};
+    }
+
+    const auto SOLVE_TABLE = make_solve_table(std::make_index_sequence<MAX_FIXED_PATH_LENGTH>());
+    const auto RATE_TABLE = make_rate_table(std::make_index_sequence<MAX_FIXED_PATH_LENGTH>());
+}
+
+size_t solve_ss_state_fixed(const CompiledPath &path, PathState &state, double dt)
+{
+    size_t n = path.steps.size();
+    // the kernels step with a fixed dt, AUTO_DT goes to the generic solver
+    return SOLVE_TABLE[n <= MAX_FIXED_PATH_LENGTH && dt != AUTO_DT ? n : 0](path, state, dt);
+}
+
+double compute_path_rate_fixed(const CompiledPath &path, const PathState &ss_state)
+{
+    size_t n = path.steps.size();
+    return RATE_TABLE[n <= MAX_FIXED_PATH_LENGTH ? n : 0](path, ss_state);
+}
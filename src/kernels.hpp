@@ -0,0 +1,133 @@
+/*
+ * Mini-projet 3 : fixed length path kernels
+ */
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include "kinetics.hpp"
+
+// longest path with a specialized kernel, longer paths use the generic solver
+const size_t MAX_FIXED_PATH_LENGTH = 8;
+
+/*!
+ * Steady-state kernel for paths of exactly N reactions. Parameters and
+ * state live in std::arrays, each Euler step is unrolled at compile time
+ * and the V_IN / V_OUT boundaries are resolved per position by the compiler.
+ * Arithmetic is done in the same order as euler_step, so results are
+ * bit-for-bit identical to the generic solver.
+ */
+template <size_t N>
+struct FixedPathKernel
+{
+    typedef std::array<double, N + 1> State;
+
+    struct Parameters
+    {
+        std::array<double, N> V_plus, V_minus, K_S, K_P;
+    };
+
+    static double rate(const Parameters &p, size_t i, double S, double P)
+    {
+        return (p.V_plus[i] * (S / p.K_S[i]) - p.V_minus[i] * (P / p.K_P[i])) / (1 + S / p.K_S[i] + P / p.K_P[i]);
+    }
+
+    // compound K of the chain, then K + 1 ...
+    template <size_t K, bool LAST = (K == N)>
+    struct Step
+    {
+        static void run(const Parameters &p, const State &c, State &out, double incoming, double dt)
+        {
+            double outgoing = rate(p, K, c[K], c[K + 1]);
+            double rateOfChange = K == 0 ? V_IN * (1.0 - c[K]) - outgoing : incoming - outgoing;
+            double newConcentration = c[K] + dt * rateOfChange;
+            out[K] = newConcentration < 0 ? 0.0 : newConcentration;
+            Step<K + 1>::run(p, c, out, outgoing, dt);
+        }
+    };
+
+    template <size_t K>
+    struct Step<K, true>
+    {
+        static void run(const Parameters &, const State &c, State &out, double incoming, double dt)
+        {
+            double newConcentration = c[K] + dt * (incoming - c[K] * V_OUT);
+            out[K] = newConcentration < 0 ? 0.0 : newConcentration;
+        }
+    };
+
+    template <size_t K, bool LAST = (K == N)>
+    struct Stable
+    {
+        static bool run(const State &c_in, const State &c_out)
+        {
+            // written as checkStable, so that a NaN (0 / 0) is stable
+            return !(fabs(c_out[K] - c_in[K]) / c_out[K] >= DELTA) && Stable<K + 1>::run(c_in, c_out);
+        }
+    };
+
+    template <size_t K>
+    struct Stable<K, true>
+    {
+        static bool run(const State &c_in, const State &c_out)
+        {
+            return !(fabs(c_out[K] - c_in[K]) / c_out[K] >= DELTA);
+        }
+    };
+
+    static Parameters load(const CompiledPath &path)
+    {
+        Parameters p;
+        for (size_t i = 0; i < N; ++i)
+        {
+            p.V_plus[i] = path.steps[i].V_plus;
+            p.V_minus[i] = path.steps[i].V_minus;
+            p.K_S[i] = path.steps[i].K_S;
+            p.K_P[i] = path.steps[i].K_P;
+        }
+        return p;
+    }
+
+    static size_t solve(const CompiledPath &path, PathState &state, double dt)
+    {
+        Parameters p = load(path);
+        State a, b;
+        std::copy(state.begin(), state.end(), a.begin());
+        State *c_in = &a, *c_out = &b;
+        size_t iterations = 1;
+        Step<0>::run(p, *c_in, *c_out, 0.0, dt);
+        while (!Stable<0>::run(*c_in, *c_out))
+        {
+            std::swap(c_in, c_out);
+            Step<0>::run(p, *c_in, *c_out, 0.0, dt);
+            iterations++;
+        }
+        std::copy(c_out->begin(), c_out->end(), state.begin());
+        return iterations;
+    }
+
+    static double path_rate(const CompiledPath &path, const PathState &state)
+    {
+        Parameters p = load(path);
+        double minRate = rate(p, 0, state[0], state[1]);
+        for (size_t i = 1; i < N; ++i)
+        {
+            double r = rate(p, i, state[i], state[i + 1]);
+            minRate = r < minRate ? r : minRate;
+        }
+        return minRate;
+    }
+};
+
+/*!
+ * @brief solve_ss_state through the kernel matching the path length
+ * Lengths 1..MAX_FIXED_PATH_LENGTH go through a jump table of specialized
+ * kernels, anything else falls back to the generic solver.
+ */
+size_t solve_ss_state_fixed(const CompiledPath &path, PathState &state, double dt);
+
+/*!
+ * @brief compute_path_rate through the kernel matching the path length
+ */
+double compute_path_rate_fixed(const CompiledPath &path, const PathState &ss_state);
@@ -0,0 +1,250 @@
+/*
+ * Mini-projet 3 : compiled path kinetics
+ */
+#include "kinetics.hpp"
+#include <climits>
+#include <cmath>
+
+CompiledPath compile_path(const Network &network, const Path &path)
+{
+    CompiledPath compiled;
+    compile_path(network, path.data(), path.size(), compiled);
+    return compiled;
+}
+
+void compile_path(const Network &network, const ReactionID *path, size_t length, CompiledPath &compiled)
+{
+    compiled.reactions.assign(path, path + length);
+    compiled.compounds.clear();
+    compiled.steps.clear();
+    for (size_t i = 0; i < length; ++i)
+    {
+        compiled.steps.push_back(network.reactions[path[i]]);
+    }
+    if (length == 1)
+    {
+        compiled.compounds.push_back(compiled.steps[0].compounds.first);
+        compiled.compounds.push_back(compiled.steps[0].compounds.second);
+    }
+    else if (length > 1)
+    {
+        // same orientation rules as compute_coumpound_path
+        for (size_t i = 0; i < length - 1; ++i)
+        {
+            CompoundID left = compiled.steps[i].compounds.first;
+            CompoundID right = compiled.steps[i].compounds.second;
+            const Reaction &next = compiled.steps[i + 1];
+            bool leftShared = left == next.compounds.first || left == next.compounds.second;
+            if (i == 0)
+            {
+                compiled.compounds.push_back(leftShared ? right : left);
+            }
+            compiled.compounds.push_back(leftShared ? left : right);
+        }
+        CompoundID left = compiled.steps[length - 1].compounds.first;
+        CompoundID right = compiled.steps[length - 1].compounds.second;
+        const Reaction &prev = compiled.steps[length - 2];
+        bool leftShared = left == prev.compounds.first || left == prev.compounds.second;
+        compiled.compounds.push_back(leftShared ? right : left);
+    }
+}
+
+PathState initial_path_state(const CompiledPath &path, const Concentrations &concentrations)
+{
+    PathState state;
+    initial_path_state(path, concentrations, state);
+    return state;
+}
+
+void initial_path_state(const CompiledPath &path, const Concentrations &concentrations, PathState &state)
+{
+    state.clear();
+    for (CompoundID id : path.compounds)
+    {
+        state.push_back(concentrations.find(id)->second);
+    }
+}
+
+Concentrations to_concentrations(const CompiledPath &path, const PathState &state)
+{
+    Concentrations concentrations;
+    for (size_t i = 0; i < path.compounds.size(); ++i)
+    {
+        concentrations.insert({path.compounds[i], state[i]});
+    }
+    return concentrations;
+}
+
+void euler_step(const CompiledPath &path, const PathState &c_in, PathState &c_out, double dt)
+{
+    size_t last = c_in.size() - 1;
+    double incoming = 0.0;
+    for (size_t k = 0; k <= last; ++k)
+    {
+        double outgoing = k < last ? michaelis_reversible_rate(path.steps[k], c_in[k], c_in[k + 1])
+                                   : c_in[k] * V_OUT;
+        double rateOfChange = k == 0 ? V_IN * (1.0 - c_in[k]) - outgoing : incoming - outgoing;
+        double newConcentration = c_in[k] + dt * rateOfChange;
+        c_out[k] = newConcentration < 0 ? 0.0 : newConcentration;
+        incoming = outgoing;
+    }
+}
+
+bool checkStable(const PathState &c_in, const PathState &c_out)
+{
+    for (size_t k = 0; k < c_in.size(); ++k)
+    {
+        if (fabs(c_out[k] - c_in[k]) / c_out[k] >= DELTA)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool checkStable(const PathState &c_in, const PathState &c_out, double floor)
+{
+    for (size_t k = 0; k < c_in.size(); ++k)
+    {
+        double change = fabs(c_out[k] - c_in[k]);
+        if (c_out[k] < floor ? change >= DELTA * floor : change / c_out[k] >= DELTA)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t solve_ss_state(const CompiledPath &path, PathState &state, double dt)
+{
+    PathState scratch;
+    return solve_ss_state(path, state, scratch, dt);
+}
+
+size_t solve_ss_state(const CompiledPath &path, PathState &state, PathState &scratch, double dt)
+{
+    if (dt == AUTO_DT)
+    {
+        return solve_ss_state_auto(path, state, scratch);
+    }
+    if (state.empty())
+    {
+        return 0;
+    }
+    scratch.resize(state.size());
+    size_t iterations = 1;
+    euler_step(path, state, scratch, dt);
+    while (!checkStable(state, scratch))
+    {
+        state.swap(scratch);
+        euler_step(path, state, scratch, dt);
+        iterations++;
+    }
+    state.swap(scratch);
+    return iterations;
+}
+
+size_t solve_ss_state_bounded(const CompiledPath &path, PathState &state, PathState &scratch, double dt,
+                              size_t max_iterations, double floor, bool &converged)
+{
+    converged = state.empty();
+    if (converged)
+    {
+        return 0;
+    }
+    scratch.resize(state.size());
+    bool automatic = dt == AUTO_DT;
+    size_t iterations = 0;
+    while (iterations < max_iterations)
+    {
+        if (automatic && iterations % AUTO_DT_REESTIMATE_EVERY == 0)
+        {
+            dt = 1.0 / jacobian_spectral_bound(path, state);
+        }
+        euler_step(path, state, scratch, dt);
+        iterations++;
+        converged = checkStable(state, scratch, floor);
+        state.swap(scratch);
+        if (converged)
+        {
+            break;
+        }
+    }
+    return iterations;
+}
+
+double jacobian_spectral_bound(const CompiledPath &path, const PathState &state)
+{
+    // dS = d rate / d S >= 0 and dP = -d rate / d P >= 0 of the reaction leaving
+    // compound k; column k of the Jacobian holds, around its diagonal
+    // -(dS_k + dP_{k-1}), the entries dS_k (below) and -dP_{k-1} (above)
+    size_t last = state.size() - 1;
+    double bound = 0.0;
+    double previousDP = 0.0;
+    for (size_t k = 0; k <= last; ++k)
+    {
+        double dS = 0.0, dP = 0.0;
+        if (k < last)
+        {
+            const Reaction &R = path.steps[k];
+            double S = state[k], P = state[k + 1];
+            double forward = R.V_plus / R.K_S, backward = R.V_minus / R.K_P;
+            double denominator = 1.0 + S / R.K_S + P / R.K_P;
+            dS = (forward * (1.0 + P / R.K_P) + backward * P / R.K_S) / (denominator * denominator);
+            dP = (backward * (1.0 + S / R.K_S) + forward * S / R.K_P) / (denominator * denominator);
+        }
+        double column = 2.0 * (dS + previousDP) + (k == 0 ? V_IN : 0.0) + (k == last ? V_OUT : 0.0);
+        bound = column > bound ? column : bound;
+        previousDP = dP;
+    }
+    return bound;
+}
+
+size_t solve_ss_state_auto(const CompiledPath &path, PathState &state, PathState &scratch, double step_factor,
+                           size_t reestimate_every, double *final_dt)
+{
+    if (state.empty())
+    {
+        return 0;
+    }
+    scratch.resize(state.size());
+    size_t iterations = 0;
+    double dt = 0.0;
+    bool stable = false;
+    while (!stable)
+    {
+        if (iterations % reestimate_every == 0)
+        {
+            dt = step_factor / jacobian_spectral_bound(path, state);
+        }
+        euler_step(path, state, scratch, dt);
+        iterations++;
+        stable = checkStable(state, scratch);
+        state.swap(scratch);
+    }
+    if (final_dt)
+    {
+        *final_dt = dt;
+    }
+    return iterations;
+}
+
+double compute_path_rate(const CompiledPath &path, const PathState &ss_state)
+{
+    double minRate = INT_MAX;
+    for (size_t i = 0; i < path.steps.size(); ++i)
+    {
+        double rate = michaelis_reversible_rate(path.steps[i], ss_state[i], ss_state[i + 1]);
+        minRate = rate < minRate ? rate : minRate;
+    }
+    return minRate;
+}
+
+double steady_state_rate(const Network &network, const ReactionID *path, size_t length,
+                         const Concentrations &initial_concentrations, double dt, SteadyStateWorkspace &workspace)
+{
+    compile_path(network, path, length, workspace.compiled);
+    initial_path_state(workspace.compiled, initial_concentrations, workspace.state);
+    solve_ss_state(workspace.compiled, workspace.state, workspace.scratch, dt);
+    return compute_path_rate(workspace.compiled, workspace.state);
+}
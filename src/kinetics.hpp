@@ -0,0 +1,135 @@
+/*
+ * Mini-projet 3 : compiled path kinetics
+ */
+#pragma once
+#include <vector>
+#include "pathsearch.hpp"
+
+/*-----------------  TYPES AND DATA STRUCTURES    ------------*/
+
+/*!
+ * A path prepared once for repeated steady-state solves. The compound chain
+ * and a copy of each reaction's kinetic parameters are resolved up front, so
+ * the Euler loop runs on a flat state vector instead of Concentrations maps.
+ */
+struct CompiledPath
+{
+    Path reactions;
+    // compounds[i] -> compounds[i + 1] is the orientation used for steps[i]
+    std::vector<CompoundID> compounds;
+    // steps[i] holds the parameters of reactions[i] (may be overridden, e.g. by a sweep)
+    std::vector<Reaction> steps;
+};
+
+// vector index == position in CompiledPath::compounds
+typedef std::vector<double> PathState;
+
+/*!
+ * Buffers of one steady-state solve. Reused across calls, they keep the
+ * capacity of the longest path seen so far, after which a solve does not
+ * allocate.
+ */
+struct SteadyStateWorkspace
+{
+    CompiledPath compiled;
+    PathState state;
+    PathState scratch;
+};
+
+/*!
+ * @brief resolves the compound chain and kinetic parameters of a path
+ */
+CompiledPath compile_path(const Network &network, const Path &path);
+
+/*!
+ * @brief same as above, reusing the storage of an existing CompiledPath
+ */
+void compile_path(const Network &network, const ReactionID *path, size_t length, CompiledPath &compiled);
+
+/*!
+ * @brief extracts the concentrations of the compounds of a compiled path
+ */
+PathState initial_path_state(const CompiledPath &path, const Concentrations &concentrations);
+void initial_path_state(const CompiledPath &path, const Concentrations &concentrations, PathState &state);
+
+/*!
+ * @brief converts a path state back to the Concentrations of its compounds
+ */
+Concentrations to_concentrations(const CompiledPath &path, const PathState &state);
+
+/*!
+ * @brief one explicit Euler step on a compiled path (same scheme as euler_implicite)
+ * @param c_out must have the size of c_in
+ */
+void euler_step(const CompiledPath &path, const PathState &c_in, PathState &c_out, double dt);
+
+/*!
+ * @brief same stability criterion as checkStable on Concentrations
+ */
+bool checkStable(const PathState &c_in, const PathState &c_out);
+
+/*!
+ * @brief checkStable where concentrations below floor are compared in absolute
+ * terms (change below DELTA * floor), so a compound drained to zero cannot
+ * make the test divide by zero
+ */
+bool checkStable(const PathState &c_in, const PathState &c_out, double floor);
+
+// steps between two estimates of the automatic time step
+const size_t AUTO_DT_REESTIMATE_EVERY = 16;
+
+/*!
+ * @brief iterates euler_step until convergence
+ * @param state the starting state on input (initial or warm start), the steady state on output
+ * @param dt the time step, or AUTO_DT for solve_ss_state_auto
+ * @return the number of Euler steps performed
+ */
+size_t solve_ss_state(const CompiledPath &path, PathState &state, double dt = 1e-3);
+
+/*!
+ * @brief same as above, with a caller-provided buffer for the next state
+ */
+size_t solve_ss_state(const CompiledPath &path, PathState &state, PathState &scratch, double dt);
+
+/*!
+ * @brief solve_ss_state with checkStable(c_in, c_out, floor), stopping after max_iterations steps
+ * The state is left on the last step, so calling it again continues the same iteration.
+ * dt = AUTO_DT re-estimates the step as solve_ss_state_auto does.
+ * @param converged set to whether the steady state was reached
+ * @return the number of Euler steps performed by this call
+ */
+size_t solve_ss_state_bounded(const CompiledPath &path, PathState &state, PathState &scratch, double dt,
+                              size_t max_iterations, double floor, bool &converged);
+
+/*!
+ * @brief upper bound on the spectral radius of the Jacobian of euler_step's
+ * right-hand side at the given state
+ * The Jacobian of the chain is tridiagonal with a negative diagonal; each
+ * column's off-diagonal entries sum to at most the magnitude of its diagonal
+ * entry (what leaves a compound enters its neighbour), so every column
+ * Gershgorin disc lies in the left half-plane, within the returned radius of 0.
+ */
+double jacobian_spectral_bound(const CompiledPath &path, const PathState &state);
+
+/*!
+ * @brief solve_ss_state with the time step taken from jacobian_spectral_bound
+ * dt = step_factor / bound, re-estimated every reestimate_every steps as the
+ * concentrations move. With step_factor 1 the eigenvalues of one Euler step
+ * have a non negative real part (no oscillation); 2 is the stability limit.
+ * @param final_dt if not null, receives the last step used
+ * @return the number of Euler steps performed
+ */
+size_t solve_ss_state_auto(const CompiledPath &path, PathState &state, PathState &scratch, double step_factor = 1.0,
+                           size_t reestimate_every = AUTO_DT_REESTIMATE_EVERY, double *final_dt = nullptr);
+
+/*!
+ * @brief smallest michaelis_reversible_rate along a compiled path
+ */
+double compute_path_rate(const CompiledPath &path, const PathState &ss_state);
+
+/*!
+ * @brief compiles a path, solves its steady state and returns its rate, all in the workspace
+ * Same value as compute_path_rate(network, path, compute_ss_concentration(...)).
+ */
+double steady_state_rate(const Network &network, const ReactionID *path, size_t length,
+                         const Concentrations &initial_concentrations, double dt, SteadyStateWorkspace &workspace);
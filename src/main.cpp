@@ -1,9 +1,24 @@
 #include <iostream>
 #include <iomanip>
 #include <exception>
+#include <string>
 #include "pathsearch.hpp"
 #include "utils.hpp"
 #include "unit_test.hpp"
+#include "bench.hpp"
+#include "server.hpp"
+#include "oracle.hpp"
+#include "fuzz.hpp"
+#include "comparative.hpp"
+#include <fstream>
+#include <sys/stat.h>
+
+/*---------------- Command line modes  -----------------------*/
+int serve(int argc, char *argv[]);
+int client(int argc, char *argv[]);
+int build_index(int argc, char *argv[]);
+int fuzz(int argc, char *argv[]);
+int compare(int argc, char *argv[]);
 
 /*---------------- Helper test functions  -----------------------*/
 void test_part1();
@@ -15,6 +30,31 @@ void test_larger_networks();
 
 int main(int argc, char *argv[])
 {
+    if (argc > 1 && std::string(argv[1]) == "bench")
+    {
+        run_benchmarks();
+        return 0;
+    }
+    if (argc > 2 && std::string(argv[1]) == "serve")
+    {
+        return serve(argc, argv);
+    }
+    if (argc > 2 && std::string(argv[1]) == "client")
+    {
+        return client(argc, argv);
+    }
+    if (argc == 4 && std::string(argv[1]) == "index")
+    {
+        return build_index(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "fuzz")
+    {
+        return fuzz(argc, argv);
+    }
+    if (argc > 3 && std::string(argv[1]) == "compare")
+    {
+        return compare(argc, argv);
+    }
 
     std::cout << "========= TESTING PART 1 ================" << std::endl;
     test_part1(); // UNCOMMENT WHEN READY TO TEST
@@ -32,7 +72,162 @@ int main(int argc, char *argv[])
     run_unit_tests(1); // UNCOMMENT WHEN READY TO TEST PART 1
     run_unit_tests(2); // UNCOMMENT WHEN READY TO TEST PART 2
     run_unit_tests(3); // UNCOMMENT WHEN READY TO TEST PART 3
+    run_unit_tests(4);
+
+    return 0;
+}
+
+// pathsearch serve <socket> [<name>=<network file>,<concentrations file> ...]
+int serve(int argc, char *argv[])
+{
+    NetworkRegistry registry;
+    try
+    {
+        for (int i = 3; i < argc; ++i)
+        {
+            std::string spec(argv[i]);
+            size_t equal = spec.find('=');
+            size_t comma = spec.find(',', equal);
+            if (equal == std::string::npos || comma == std::string::npos)
+            {
+                std::cerr << "expected <name>=<network file>,<concentrations file>, got " << spec << std::endl;
+                return 1;
+            }
+            registry.load(spec.substr(0, equal), spec.substr(equal + 1, comma - equal - 1), spec.substr(comma + 1));
+        }
+        QueryServer server(registry, argv[2]);
+        server.listen();
+        std::cerr << "listening on " << argv[2] << std::endl;
+        server.run();
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// pathsearch client <socket> [request]: without a request, pipelines the lines of stdin
+int client(int argc, char *argv[])
+{
+    try
+    {
+        QueryClient connection(argv[2]);
+        if (argc > 3)
+        {
+            std::string request(argv[3]);
+            for (int i = 4; i < argc; ++i)
+            {
+                request += std::string(" ") + argv[i];
+            }
+            std::cout << connection.query(request) << std::endl;
+            return 0;
+        }
+        size_t pending = 0;
+        std::string line;
+        while (std::getline(std::cin, line))
+        {
+            connection.send(line);
+            pending++;
+        }
+        for (; pending > 0; --pending)
+        {
+            std::cout << connection.receive() << std::endl;
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// pathsearch index <network file> <oracle file>: builds the distance oracle offline
+int build_index(int argc, char *argv[])
+{
+    std::ifstream file(argv[2]);
+    if (!file)
+    {
+        std::cerr << "File not found: " << argv[2] << std::endl;
+        return 1;
+    }
+    Network network = read_network(file);
+    DistanceOracle oracle = DistanceOracle::build(build_adjacency_graph(network));
+    try
+    {
+        oracle.save(argv[3]);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    std::cout << oracle.size() << " compounds, " << oracle.label_entries() << " label entries" << std::endl;
+    return 0;
+}
 
+// pathsearch fuzz [<cases> [<first seed> [<max compounds>]]]: differential tests of the optimized engines
+int fuzz(int argc, char *argv[])
+{
+    size_t cases = argc > 2 ? std::stoul(argv[2]) : 1000;
+    uint64_t seed = argc > 3 ? std::stoull(argv[3]) : 1;
+    size_t maxCompounds = argc > 4 ? std::stoul(argv[4]) : 24;
+    FuzzReport report = run_fuzz(seed, cases, differential_properties(), maxCompounds);
+    for (const FuzzFailure &failure : report.failures)
+    {
+        std::cout << "FAILED " << failure.property << " on seed " << failure.original.seed << ": " << failure.message << std::endl;
+        std::cout << "shrunk from " << failure.original.network.reactions.size() << " to "
+                  << failure.shrunk.network.reactions.size() << " reactions:" << std::endl;
+        write_case(failure.shrunk, std::cout, std::cout);
+    }
+    std::cout << report.cases << " cases, " << report.checks << " checks, " << report.failures.size() << " failures in "
+              << report.seconds << " s (" << report.cases / report.seconds * 60 << " cases per minute)" << std::endl;
+    return report.failures.empty() ? 0 : 1;
+}
+
+// pathsearch compare <manifest file | directory> <src>:<dest> ...: distances, path counts and rates per network
+int compare(int argc, char *argv[])
+{
+    try
+    {
+        struct stat info;
+        bool directory = stat(argv[2], &info) == 0 && S_ISDIR(info.st_mode);
+        std::vector<NetworkSource> sources = directory ? list_networks(argv[2]) : read_manifest(argv[2]);
+        std::vector<ComparativeQuery> queries;
+        for (int i = 3; i < argc; ++i)
+        {
+            std::string spec(argv[i]);
+            size_t colon = spec.find(':');
+            if (colon == std::string::npos)
+            {
+                std::cerr << "expected <src>:<dest>, got " << spec << std::endl;
+                return 1;
+            }
+            queries.push_back({spec.substr(0, colon), spec.substr(colon + 1)});
+        }
+        CompoundDictionary dictionary;
+        PipelineStats stats;
+        ComparisonMatrix matrix = run_comparative_pipeline(sources, queries, dictionary, DEFAULT_PIPELINE, &stats);
+        {
+            OutputSink out(std::cout);
+            write_comparison(out, matrix);
+        }
+        for (size_t i = 0; i < matrix.errors.size(); ++i)
+        {
+            if (!matrix.errors[i].empty())
+            {
+                std::cerr << matrix.organisms[i] << ": " << matrix.errors[i] << std::endl;
+            }
+        }
+        std::cerr << stats.networks << " networks, " << dictionary.size() << " compounds in " << stats.seconds << " s" << std::endl;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
     return 0;
 }
 
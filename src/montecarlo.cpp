@@ -0,0 +1,265 @@
+/*
+ * Mini-projet 3 : Monte Carlo robustness ranking
+ */
+#include "montecarlo.hpp"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <map>
+#include <sstream>
+#include "kinetics.hpp"
+#include "parallel.hpp"
+#include "random.hpp"
+
+P2Quantile::P2Quantile(double p) : p(p), count(0)
+{
+    for (int i = 0; i < 5; ++i)
+    {
+        q[i] = 0.0;
+        n[i] = i + 1;
+    }
+    np[0] = 1;
+    np[1] = 1 + 2 * p;
+    np[2] = 1 + 4 * p;
+    np[3] = 3 + 2 * p;
+    np[4] = 5;
+    dn[0] = 0;
+    dn[1] = p / 2;
+    dn[2] = p;
+    dn[3] = (1 + p) / 2;
+    dn[4] = 1;
+}
+
+void P2Quantile::add(double x)
+{
+    if (count < 5)
+    {
+        q[count++] = x;
+        if (count == 5)
+        {
+            std::sort(q, q + 5);
+        }
+        return;
+    }
+    count++;
+
+    int k;
+    if (x < q[0])
+    {
+        q[0] = x;
+        k = 0;
+    }
+    else if (x >= q[4])
+    {
+        q[4] = x;
+        k = 3;
+    }
+    else
+    {
+        k = 0;
+        while (x >= q[k + 1])
+        {
+            k++;
+        }
+    }
+    for (int i = k + 1; i < 5; ++i)
+    {
+        n[i] += 1;
+    }
+    for (int i = 0; i < 5; ++i)
+    {
+        np[i] += dn[i];
+    }
+
+    for (int i = 1; i < 4; ++i)
+    {
+        double d = np[i] - n[i];
+        if ((d >= 1 && n[i + 1] - n[i] > 1) || (d <= -1 && n[i - 1] - n[i] < -1))
+        {
+            int s = d > 0 ? 1 : -1;
+            double parabolic = q[i] + s / (n[i + 1] - n[i - 1]) *
+                                          ((n[i] - n[i - 1] + s) * (q[i + 1] - q[i]) / (n[i + 1] - n[i]) +
+                                           (n[i + 1] - n[i] - s) * (q[i] - q[i - 1]) / (n[i] - n[i - 1]));
+            if (q[i - 1] < parabolic && parabolic < q[i + 1])
+            {
+                q[i] = parabolic;
+            }
+            else
+            {
+                q[i] = q[i] + s * (q[i + s] - q[i]) / (n[i + s] - n[i]);
+            }
+            n[i] += s;
+        }
+    }
+}
+
+double P2Quantile::value() const
+{
+    if (count >= 5)
+    {
+        return q[2];
+    }
+    if (count == 0)
+    {
+        return 0.0;
+    }
+    double sorted[5];
+    std::copy(q, q + count, sorted);
+    std::sort(sorted, sorted + count);
+    return sorted[(size_t)std::lround(p * (count - 1))];
+}
+
+MonteCarloRanking rank_paths_monte_carlo(const Network &network, const Paths &paths, const MonteCarloOptions &options)
+{
+    // compounds touched by the candidates, and where each path reads them
+    std::map<CompoundID, size_t> slotOf;
+    std::vector<CompiledPath> compiled;
+    std::vector<std::vector<size_t>> slots;
+    for (const Path &path : paths)
+    {
+        compiled.push_back(compile_path(network, path));
+        slots.emplace_back();
+        for (CompoundID id : compiled.back().compounds)
+        {
+            auto it = slotOf.insert({id, slotOf.size()}).first;
+            slots.back().push_back(it->second);
+        }
+    }
+
+    size_t batchSize = std::max<size_t>(1, options.batch_size);
+    size_t batches = (options.samples + batchSize - 1) / batchSize;
+    unsigned workers = options.threads == 0 ? default_thread_count() : options.threads;
+
+    SplitMix64 master(options.seed);
+    std::vector<SplitMix64> streams;
+    for (size_t b = 0; b < batches; ++b)
+    {
+        streams.push_back(master.split());
+    }
+
+    MonteCarloRanking ranking;
+    ranking.samples = options.samples;
+    ranking.quantile_levels = options.quantiles;
+    ranking.paths.assign(paths.size(), PathStatistics{0, 0.0, 0.0, INT_MAX, INT_MIN, {}});
+    std::vector<std::vector<P2Quantile>> estimators(paths.size());
+    for (auto &estimator : estimators)
+    {
+        for (double level : options.quantiles)
+        {
+            estimator.emplace_back(level);
+        }
+    }
+
+    // rates[w][s * paths + p] for the batch currently held by worker slot w
+    std::vector<std::vector<double>> rates(workers);
+    std::vector<std::vector<int>> winners(workers);
+    size_t seen = 0;
+
+    for (size_t first = 0; first < batches; first += workers)
+    {
+        size_t round = std::min<size_t>(workers, batches - first);
+        auto runBatch = [&](size_t r, unsigned)
+        {
+            size_t b = first + r;
+            size_t count = std::min(batchSize, options.samples - b * batchSize);
+            SplitMix64 rng = streams[b];
+            std::vector<double> sample(slotOf.size());
+            PathState state;
+            rates[r].resize(count * paths.size());
+            winners[r].resize(count);
+            for (size_t s = 0; s < count; ++s)
+            {
+                for (double &c : sample)
+                {
+                    c = rng.next_double(options.min_concentration, options.max_concentration);
+                }
+                double best = INT_MIN;
+                winners[r][s] = -1;
+                for (size_t p = 0; p < paths.size(); ++p)
+                {
+                    state.resize(slots[p].size());
+                    for (size_t k = 0; k < slots[p].size(); ++k)
+                    {
+                        state[k] = sample[slots[p][k]];
+                    }
+                    solve_ss_state(compiled[p], state, options.dt);
+                    double rate = compute_path_rate(compiled[p], state);
+                    rates[r][s * paths.size() + p] = rate;
+                    if (rate > best)
+                    {
+                        best = rate;
+                        winners[r][s] = (int)p;
+                    }
+                }
+            }
+        };
+        parallel_for(round, workers, runBatch);
+
+        // merge in batch order so the estimators see the same sequence for any thread count
+        for (size_t r = 0; r < round; ++r)
+        {
+            for (size_t s = 0; s < winners[r].size(); ++s)
+            {
+                seen++;
+                if (winners[r][s] >= 0)
+                {
+                    ranking.paths[winners[r][s]].wins++;
+                }
+                for (size_t p = 0; p < paths.size(); ++p)
+                {
+                    double rate = rates[r][s * paths.size() + p];
+                    PathStatistics &stats = ranking.paths[p];
+                    stats.mean_rate += (rate - stats.mean_rate) / seen;
+                    stats.min_rate = std::min(stats.min_rate, rate);
+                    stats.max_rate = std::max(stats.max_rate, rate);
+                    for (P2Quantile &estimator : estimators[p])
+                    {
+                        estimator.add(rate);
+                    }
+                }
+            }
+        }
+    }
+
+    for (size_t p = 0; p < paths.size(); ++p)
+    {
+        PathStatistics &stats = ranking.paths[p];
+        stats.win_frequency = seen == 0 ? 0.0 : (double)stats.wins / seen;
+        for (const P2Quantile &estimator : estimators[p])
+        {
+            stats.quantiles.push_back(estimator.value());
+        }
+        ranking.order.push_back(p);
+    }
+    auto moreRobust = [&](size_t a, size_t b)
+    {
+        const PathStatistics &sa = ranking.paths[a];
+        const PathStatistics &sb = ranking.paths[b];
+        return sa.wins != sb.wins ? sa.wins > sb.wins : sa.mean_rate > sb.mean_rate;
+    };
+    std::stable_sort(ranking.order.begin(), ranking.order.end(), moreRobust);
+    return ranking;
+}
+
+std::string to_string(const Paths &paths, const MonteCarloRanking &ranking)
+{
+    std::stringstream ss;
+    ss << "Samples: " << ranking.samples << "\n";
+    for (size_t rank = 0; rank < ranking.order.size(); ++rank)
+    {
+        size_t p = ranking.order[rank];
+        const PathStatistics &stats = ranking.paths[p];
+        ss << rank + 1 << ". Reactions: ";
+        for (ReactionID r : paths[p])
+        {
+            ss << r << " ";
+        }
+        ss << "| wins " << stats.win_frequency * 100 << "% | mean " << stats.mean_rate;
+        for (size_t i = 0; i < stats.quantiles.size(); ++i)
+        {
+            ss << " | q" << ranking.quantile_levels[i] << " " << stats.quantiles[i];
+        }
+        ss << "\n";
+    }
+    return ss.str();
+}
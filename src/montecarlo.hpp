@@ -0,0 +1,73 @@
+/*
+ * Mini-projet 3 : Monte Carlo robustness ranking
+ */
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "pathsearch.hpp"
+
+/*-----------------  TYPES AND DATA STRUCTURES    ------------*/
+
+/*!
+ * Streaming quantile estimate in constant memory (P-square algorithm,
+ * Jain & Chlamtac 1985): five markers are moved along the observations
+ * with piecewise-parabolic interpolation.
+ */
+class P2Quantile
+{
+public:
+    explicit P2Quantile(double p);
+    void add(double x);
+    double value() const;
+
+private:
+    double p;
+    size_t count;
+    double q[5];  // marker heights
+    double n[5];  // marker positions
+    double np[5]; // desired positions
+    double dn[5]; // desired position increments
+};
+
+struct MonteCarloOptions
+{
+    size_t samples = 1000;
+    uint64_t seed = 2023;
+    // every compound of the candidate paths gets a concentration drawn uniformly in [min, max)
+    double min_concentration = 0.0;
+    double max_concentration = 1.0;
+    // samples are drawn and solved in batches, one batch per thread at a time
+    size_t batch_size = 64;
+    unsigned threads = 0;
+    double dt = 1e-2;
+    std::vector<double> quantiles = {0.05, 0.5, 0.95};
+};
+
+struct PathStatistics
+{
+    size_t wins;
+    double win_frequency;
+    double mean_rate;
+    double min_rate;
+    double max_rate;
+    std::vector<double> quantiles; // same order as MonteCarloOptions::quantiles
+};
+
+struct MonteCarloRanking
+{
+    size_t samples;
+    std::vector<double> quantile_levels;
+    std::vector<PathStatistics> paths; // vector index == index in the candidate paths
+    std::vector<size_t> order;         // candidate indices, most frequent winner first
+};
+
+/*!
+ * @brief ranks paths by how often they are the fastest over random initial concentrations
+ * Each batch of samples draws from its own stream split off the seed, so the
+ * result only depends on the seed and batch size, not on the thread count.
+ * Statistics are accumulated in batch order with constant memory per path.
+ */
+MonteCarloRanking rank_paths_monte_carlo(const Network &network, const Paths &paths, const MonteCarloOptions &options = MonteCarloOptions());
+
+std::string to_string(const Paths &paths, const MonteCarloRanking &ranking);
@@ -0,0 +1,158 @@
+/*
+ * Mini-projet 3 : near-shortest paths
+ */
+#include "near_shortest.hpp"
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+
+namespace
+{
+    struct Neighbour
+    {
+        size_t node; // index among the kept compounds
+        ReactionID reaction;
+    };
+}
+
+uint64_t for_each_near_shortest_path(const AdjacencyGraph &graph, CompoundID srcID, CompoundID destID, size_t slack,
+                                     const PathStream &visit, NearShortestStats *stats)
+{
+    return for_each_near_shortest_path(GraphView{&graph, nullptr}, srcID, destID, slack, visit, stats);
+}
+
+uint64_t for_each_near_shortest_path(const GraphView &view, CompoundID srcID, CompoundID destID, size_t slack,
+                                     const PathStream &visit, NearShortestStats *stats)
+{
+    const AdjacencyGraph &graph = *view.graph;
+    NearShortestStats counters = {0, 0, 0};
+    BFS fromSource = bfs(view, srcID, destID);
+    if (fromSource.distances[destID] == INT_MAX)
+    {
+        if (stats)
+        {
+            *stats = counters;
+        }
+        return 0;
+    }
+    BFS toDestination = bfs(view, destID, srcID);
+    const std::vector<int> &from = fromSource.distances;
+    const std::vector<int> &to = toDestination.distances;
+    long limit = (long)from[destID] + (long)slack;
+
+    // compounds some path within the limit can go through
+    std::vector<CompoundID> kept;
+    std::vector<size_t> index(graph.size(), SIZE_MAX);
+    for (size_t c = 0; c < graph.size(); ++c)
+    {
+        if (from[c] != INT_MAX && (long)from[c] + (long)to[c] <= limit)
+        {
+            index[c] = kept.size();
+            kept.push_back((CompoundID)c);
+        }
+    }
+    counters.compounds = kept.size();
+
+    // their neighbours among themselves, closest to the destination first
+    std::vector<size_t> neighbourStart(kept.size() + 1, 0);
+    std::vector<Neighbour> neighbours;
+    std::vector<int> remaining(kept.size()); // distance to the destination
+    for (size_t k = 0; k < kept.size(); ++k)
+    {
+        remaining[k] = to[kept[k]];
+    }
+    auto closer = [&](const Neighbour &a, const Neighbour &b)
+    {
+        return remaining[a.node] < remaining[b.node] || (remaining[a.node] == remaining[b.node] && a.node < b.node);
+    };
+    for (size_t k = 0; k < kept.size(); ++k)
+    {
+        neighbourStart[k] = neighbours.size();
+        for (const std::pair<const CompoundID, ReactionID> &pair : graph[kept[k]])
+        {
+            if (index[pair.first] != SIZE_MAX)
+            {
+                neighbours.push_back({index[pair.first], pair.second});
+            }
+        }
+        std::sort(neighbours.begin() + neighbourStart[k], neighbours.end(), closer);
+    }
+    neighbourStart[kept.size()] = neighbours.size();
+
+    // depth-first walk over simple paths, never deeper than limit
+    size_t source = index[srcID], destination = index[destID];
+    std::vector<bool> onPath(kept.size(), false);
+    std::vector<size_t> stackNode(limit + 1), stackNext(limit + 1);
+    Path path;
+    long depth = 0;
+    stackNode[0] = source;
+    stackNext[0] = neighbourStart[source];
+    onPath[source] = true;
+    bool more = true;
+    if (source == destination)
+    {
+        counters.paths++;
+        more = visit(path);
+        depth = -1;
+    }
+    while (more && depth >= 0)
+    {
+        size_t v = stackNode[depth];
+        size_t e = stackNext[depth];
+        // neighbours are sorted by distance to go, the first too far ends the scan
+        if (e < neighbourStart[v + 1] && depth + 1 + remaining[neighbours[e].node] <= limit)
+        {
+            stackNext[depth]++;
+            const Neighbour &next = neighbours[e];
+            if (onPath[next.node])
+            {
+                continue;
+            }
+            counters.expanded++;
+            path.push_back(next.reaction);
+            if (next.node == destination)
+            {
+                counters.paths++;
+                more = visit(path);
+                path.pop_back();
+                continue;
+            }
+            depth++;
+            stackNode[depth] = next.node;
+            stackNext[depth] = neighbourStart[next.node];
+            onPath[next.node] = true;
+        }
+        else
+        {
+            onPath[v] = false;
+            if (depth > 0)
+            {
+                path.pop_back();
+            }
+            depth--;
+        }
+    }
+
+    if (stats)
+    {
+        *stats = counters;
+    }
+    return counters.paths;
+}
+
+Paths find_near_shortest_paths(const AdjacencyGraph &graph, CompoundID srcID, CompoundID destID, size_t slack)
+{
+    return find_near_shortest_paths(GraphView{&graph, nullptr}, srcID, destID, slack);
+}
+
+Paths find_near_shortest_paths(const GraphView &view, CompoundID srcID, CompoundID destID, size_t slack)
+{
+    Paths paths;
+    auto collect = [&](const Path &path)
+    {
+        paths.push_back(path);
+        return true;
+    };
+    for_each_near_shortest_path(view, srcID, destID, slack, collect);
+    return paths;
+}
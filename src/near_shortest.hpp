@@ -0,0 +1,50 @@
+/*
+ * Mini-projet 3 : near-shortest paths
+ */
+#pragma once
+#include <cstdint>
+#include <functional>
+#include "pathsearch.hpp"
+#include "graph_view.hpp"
+
+/*-----------------  TYPES AND DATA STRUCTURES    ------------*/
+
+struct NearShortestStats
+{
+    uint64_t paths;    // paths passed to the visitor
+    uint64_t expanded; // search nodes (path prefixes) extended
+    size_t compounds;  // compounds that can lie on a path within the length limit
+};
+
+/*!
+ * Receives each path (reactions in source -> destination order); returning
+ * false stops the enumeration. The Path object is reused between calls.
+ */
+typedef std::function<bool(const Path &)> PathStream;
+
+/*!
+ * @brief streams every simple path from srcID to destID with at most
+ * d(srcID, destID) + slack reactions
+ * Two BFS give each compound its distance from the source and to the
+ * destination. Only compounds with from + to within the limit are kept, in a
+ * compact neighbour list sorted by distance to the destination, so the
+ * depth-first walk never enters a branch that cannot end in time and stops
+ * scanning a hub's neighbours at the first one that is too far.
+ * Assumes the graph is symmetric, as build_adjacency_graph makes it.
+ * @return number of paths streamed
+ */
+uint64_t for_each_near_shortest_path(const AdjacencyGraph &graph, CompoundID srcID, CompoundID destID, size_t slack,
+                                     const PathStream &visit, NearShortestStats *stats = nullptr);
+
+/*!
+ * @brief collects every simple path of length at most d(srcID, destID) + slack
+ * With slack 0 these are the paths of find_all_shortest_paths (in another order).
+ */
+Paths find_near_shortest_paths(const AdjacencyGraph &graph, CompoundID srcID, CompoundID destID, size_t slack);
+
+/*!
+ * @brief the same two searches on a filtered view
+ */
+uint64_t for_each_near_shortest_path(const GraphView &view, CompoundID srcID, CompoundID destID, size_t slack,
+                                     const PathStream &visit, NearShortestStats *stats = nullptr);
+Paths find_near_shortest_paths(const GraphView &view, CompoundID srcID, CompoundID destID, size_t slack);
@@ -0,0 +1,299 @@
+/*
+ * Mini-projet 3 : distance oracle (pruned landmark labeling)
+ */
+#include "oracle.hpp"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <numeric>
+#include <queue>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    const char MAGIC[8] = {'P', 'S', 'O', 'R', 'A', 'C', 'L', '1'};
+
+    struct Header
+    {
+        char magic[8];
+        uint64_t compounds;
+        uint64_t entries;
+    };
+
+    const uint32_t UNSEEN = UINT32_MAX;
+}
+
+DistanceOracle::DistanceOracle() : compounds(0), offsets(nullptr), entries(nullptr), mapping(nullptr), mappingSize(0) {}
+
+DistanceOracle::~DistanceOracle()
+{
+    release();
+}
+
+DistanceOracle::DistanceOracle(DistanceOracle &&other) : DistanceOracle()
+{
+    *this = std::move(other);
+}
+
+DistanceOracle &DistanceOracle::operator=(DistanceOracle &&other)
+{
+    if (this != &other)
+    {
+        release();
+        compounds = other.compounds;
+        offsets = other.offsets;
+        entries = other.entries;
+        ownedOffsets = std::move(other.ownedOffsets);
+        ownedEntries = std::move(other.ownedEntries);
+        mapping = other.mapping;
+        mappingSize = other.mappingSize;
+        other.compounds = 0;
+        other.offsets = nullptr;
+        other.entries = nullptr;
+        other.mapping = nullptr;
+        other.mappingSize = 0;
+    }
+    return *this;
+}
+
+void DistanceOracle::release()
+{
+    if (mapping)
+    {
+        munmap(mapping, mappingSize);
+    }
+    mapping = nullptr;
+    mappingSize = 0;
+}
+
+DistanceOracle DistanceOracle::build(const AdjacencyGraph &graph)
+{
+    size_t size = graph.size();
+    std::vector<CompoundID> order(size);
+    std::iota(order.begin(), order.end(), 0);
+    auto moreConnected = [&](CompoundID a, CompoundID b)
+    {
+        return graph[a].size() > graph[b].size();
+    };
+    std::stable_sort(order.begin(), order.end(), moreConnected);
+
+    std::vector<std::vector<LabelEntry>> labels(size);
+    std::vector<uint32_t> distances(size, UNSEEN);
+    std::vector<uint32_t> hubDistance(size, UNSEEN); // label of the current hub, indexed by hub rank
+    std::vector<CompoundID> visited;
+
+    for (uint32_t rank = 0; rank < size; ++rank)
+    {
+        CompoundID hub = order[rank];
+        for (const LabelEntry &entry : labels[hub])
+        {
+            hubDistance[entry.hub] = entry.distance;
+        }
+
+        // pruned BFS: stop at compounds whose distance the labels already give
+        std::queue<CompoundID> queue;
+        queue.push(hub);
+        distances[hub] = 0;
+        visited.push_back(hub);
+        while (!queue.empty())
+        {
+            CompoundID v = queue.front();
+            queue.pop();
+            bool covered = false;
+            for (const LabelEntry &entry : labels[v])
+            {
+                if (hubDistance[entry.hub] != UNSEEN && hubDistance[entry.hub] + entry.distance <= distances[v])
+                {
+                    covered = true;
+                    break;
+                }
+            }
+            if (covered)
+            {
+                continue;
+            }
+            labels[v].push_back({rank, distances[v]});
+            for (const std::pair<const CompoundID, ReactionID> &pair : graph[v])
+            {
+                if (distances[pair.first] == UNSEEN)
+                {
+                    distances[pair.first] = distances[v] + 1;
+                    visited.push_back(pair.first);
+                    queue.push(pair.first);
+                }
+            }
+        }
+
+        for (CompoundID v : visited)
+        {
+            distances[v] = UNSEEN;
+        }
+        visited.clear();
+        for (const LabelEntry &entry : labels[hub])
+        {
+            hubDistance[entry.hub] = UNSEEN;
+        }
+    }
+
+    DistanceOracle oracle;
+    oracle.compounds = size;
+    oracle.ownedOffsets.push_back(0);
+    for (const std::vector<LabelEntry> &label : labels)
+    {
+        oracle.ownedEntries.insert(oracle.ownedEntries.end(), label.begin(), label.end());
+        oracle.ownedOffsets.push_back(oracle.ownedEntries.size());
+    }
+    oracle.offsets = oracle.ownedOffsets.data();
+    oracle.entries = oracle.ownedEntries.data();
+    return oracle;
+}
+
+void DistanceOracle::save(const std::string &filename) const
+{
+    std::ofstream file(filename, std::ios::binary);
+    Header header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.compounds = compounds;
+    header.entries = label_entries();
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    if (compounds > 0)
+    {
+        file.write(reinterpret_cast<const char *>(offsets), (compounds + 1) * sizeof(uint64_t));
+        file.write(reinterpret_cast<const char *>(entries), header.entries * sizeof(LabelEntry));
+    }
+    if (!file)
+    {
+        throw std::runtime_error("cannot write " + filename);
+    }
+}
+
+DistanceOracle DistanceOracle::load(const std::string &filename)
+{
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw std::runtime_error("cannot read " + filename);
+    }
+    struct stat info;
+    fstat(fd, &info);
+    size_t fileSize = info.st_size;
+    void *mapping = fileSize < sizeof(Header) ? MAP_FAILED : mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        throw std::runtime_error("cannot map " + filename);
+    }
+
+    DistanceOracle oracle;
+    oracle.mapping = mapping;
+    oracle.mappingSize = fileSize;
+    const Header *header = static_cast<const Header *>(mapping);
+    if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        fileSize != sizeof(Header) + (header->compounds ? (header->compounds + 1) * sizeof(uint64_t) : 0) + header->entries * sizeof(LabelEntry))
+    {
+        throw std::runtime_error(filename + " is not a distance oracle");
+    }
+    oracle.compounds = header->compounds;
+    oracle.offsets = reinterpret_cast<const uint64_t *>(header + 1);
+    oracle.entries = reinterpret_cast<const LabelEntry *>(oracle.offsets + (oracle.compounds + 1));
+    return oracle;
+}
+
+int DistanceOracle::distance(CompoundID src, CompoundID dest) const
+{
+    const LabelEntry *a = entries + offsets[src], *aEnd = entries + offsets[src + 1];
+    const LabelEntry *b = entries + offsets[dest], *bEnd = entries + offsets[dest + 1];
+    uint64_t best = UINT64_MAX;
+    while (a != aEnd && b != bEnd)
+    {
+        if (a->hub < b->hub)
+        {
+            ++a;
+        }
+        else if (b->hub < a->hub)
+        {
+            ++b;
+        }
+        else
+        {
+            best = std::min<uint64_t>(best, (uint64_t)a->distance + b->distance);
+            ++a;
+            ++b;
+        }
+    }
+    return best == UINT64_MAX ? -1 : (int)best;
+}
+
+BFS bfs(const AdjacencyGraph &adjacency_graph, CompoundID start, CompoundID dest, const DistanceOracle &oracle)
+{
+    BFS result;
+    size_t size = adjacency_graph.size();
+    result.start = start;
+    result.parents.resize(size);
+    result.parents[start] = {-1};
+    result.distances.assign(size, INT_MAX);
+    result.distances[start] = 0;
+    int total = oracle.distance(start, dest);
+    if (total < 0)
+    {
+        return result;
+    }
+
+    std::queue<CompoundID> queue;
+    queue.push(start);
+    while (!queue.empty())
+    {
+        CompoundID currentNode = queue.front();
+        queue.pop();
+        if (result.distances[currentNode] == total)
+        {
+            continue;
+        }
+        for (const std::pair<const CompoundID, ReactionID> &pair : adjacency_graph[currentNode])
+        {
+            int next = result.distances[currentNode] + 1;
+            if (result.distances[pair.first] == INT_MAX)
+            {
+                // only compounds on a shortest start -> dest path
+                if (next + oracle.distance(pair.first, dest) != total)
+                {
+                    continue;
+                }
+                result.distances[pair.first] = next;
+                queue.push(pair.first);
+                result.parents[pair.first] = {currentNode};
+            }
+            else if (result.distances[pair.first] == next)
+            {
+                result.parents[pair.first].push_back(currentNode);
+            }
+        }
+    }
+
+    return result;
+}
+
+Paths find_all_shortest_paths(const AdjacencyGraph &graph, CompoundID srcID, CompoundID destID, const DistanceOracle &oracle)
+{
+    Paths allPaths;
+    if (oracle.distance(srcID, destID) < 0)
+    {
+        return allPaths;
+    }
+    BFS result = bfs(graph, srcID, destID, oracle);
+    Path currentPath;
+
+    recursive_find_paths(graph, result, srcID, destID, currentPath, allPaths);
+
+    for (Path &path : allPaths)
+    {
+        std::reverse(path.begin(), path.end());
+    }
+
+    return allPaths;
+}
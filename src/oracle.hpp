@@ -0,0 +1,68 @@
+/*
+ * Mini-projet 3 : distance oracle (pruned landmark labeling)
+ */
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "pathsearch.hpp"
+
+/*-----------------  TYPES AND DATA STRUCTURES    ------------*/
+
+struct LabelEntry
+{
+    uint32_t hub;      // rank of the hub, 0 == highest degree compound
+    uint32_t distance; // number of reactions between the compound and the hub
+};
+
+/*!
+ * 2-hop distance labels on the undirected reaction graph (pruned landmark
+ * labeling, Akiba et al. 2013). Hubs are processed by decreasing degree, so
+ * the cofactors that connect everything end up in almost every label and
+ * labels stay short. distance() merges two sorted labels: O(label size).
+ * An oracle either owns its labels (build) or maps them from disk (load).
+ */
+class DistanceOracle
+{
+public:
+    DistanceOracle();
+    ~DistanceOracle();
+    DistanceOracle(DistanceOracle &&other);
+    DistanceOracle &operator=(DistanceOracle &&other);
+    DistanceOracle(const DistanceOracle &) = delete;
+    DistanceOracle &operator=(const DistanceOracle &) = delete;
+
+    static DistanceOracle build(const AdjacencyGraph &graph);
+    // throws std::runtime_error if the file cannot be written / read or is not an oracle
+    void save(const std::string &filename) const;
+    static DistanceOracle load(const std::string &filename);
+
+    // number of reactions on a shortest path, -1 if dest is not reachable
+    int distance(CompoundID src, CompoundID dest) const;
+    size_t size() const { return compounds; }
+    size_t label_entries() const { return compounds == 0 ? 0 : offsets[compounds]; }
+
+private:
+    void release();
+
+    size_t compounds;
+    const uint64_t *offsets;   // label of v: entries[offsets[v] .. offsets[v + 1])
+    const LabelEntry *entries; // sorted by hub within each label
+    std::vector<uint64_t> ownedOffsets;
+    std::vector<LabelEntry> ownedEntries;
+    void *mapping;
+    size_t mappingSize;
+};
+
+/*!
+ * @brief bfs() restricted to the compounds lying on a shortest path from start to dest
+ * Only compounds v with d(start, v) + d(v, dest) == d(start, dest) are
+ * visited; their parents and distances are the same as in bfs(), every
+ * other compound is left unreached.
+ */
+BFS bfs(const AdjacencyGraph &graph, CompoundID start, CompoundID dest, const DistanceOracle &oracle);
+
+/*!
+ * @brief find_all_shortest_paths() using the oracle to restrict the BFS
+ */
+Paths find_all_shortest_paths(const AdjacencyGraph &graph, CompoundID srcID, CompoundID destID, const DistanceOracle &oracle);
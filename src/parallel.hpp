@@ -0,0 +1,165 @@
+/*
+ * Mini-projet 3 : threading helpers
+ */
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*!
+ * @brief number of worker threads to use when the caller passes 0
+ */
+inline unsigned default_thread_count()
+{
+    unsigned n = std::thread::hardware_concurrency();
+    return n == 0 ? 1 : n;
+}
+
+/*!
+ * @brief runs body(i, worker) for every i in [0, count) on a set of threads
+ * Indices are handed out one at a time from a shared counter, so uneven
+ * work items balance themselves. The calling thread is used as worker 0.
+ * @param threads number of workers, 0 means default_thread_count()
+ */
+template <class Body>
+void parallel_for(size_t count, unsigned threads, Body &&body)
+{
+    if (threads == 0)
+    {
+        threads = default_thread_count();
+    }
+    if (threads > count)
+    {
+        threads = (unsigned)count;
+    }
+    std::atomic<size_t> next(0);
+    auto work = [&](unsigned worker)
+    {
+        for (size_t i = next++; i < count; i = next++)
+        {
+            body(i, worker);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned w = 1; w < threads; ++w)
+    {
+        pool.emplace_back(work, w);
+    }
+    work(0);
+    for (std::thread &t : pool)
+    {
+        t.join();
+    }
+}
+
+/*!
+ * Task pool with one deque per worker. A worker runs its newest task first
+ * and, when its deque is empty, steals the oldest task of another worker,
+ * so large subtrees pushed early migrate to idle threads. Tasks may push
+ * more tasks; run() returns once all of them are done.
+ */
+template <class Task>
+class WorkStealingPool
+{
+public:
+    /*!
+     * @param threads number of workers, 0 means default_thread_count()
+     */
+    explicit WorkStealingPool(unsigned threads) : pending(0), stolen(0)
+    {
+        unsigned count = threads == 0 ? default_thread_count() : threads;
+        for (unsigned w = 0; w < count; ++w)
+        {
+            deques.emplace_back(new Deque());
+        }
+    }
+
+    unsigned size() const { return (unsigned)deques.size(); }
+    // tasks run by another worker than the one that pushed them
+    size_t steals() const { return stolen.load(); }
+
+    void push(unsigned worker, Task task)
+    {
+        pending++;
+        std::lock_guard<std::mutex> guard(deques[worker]->lock);
+        deques[worker]->tasks.push_back(std::move(task));
+    }
+
+    /*!
+     * @brief calls body(task, worker) until no task is left, the calling thread being worker 0
+     */
+    template <class Body>
+    void run(Body &&body)
+    {
+        auto work = [&](unsigned worker)
+        {
+            Task task;
+            while (pending.load() > 0)
+            {
+                if (pop(worker, task) || steal(worker, task))
+                {
+                    body(task, worker);
+                    pending--;
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        };
+        std::vector<std::thread> pool;
+        for (unsigned w = 1; w < size(); ++w)
+        {
+            pool.emplace_back(work, w);
+        }
+        work(0);
+        for (std::thread &t : pool)
+        {
+            t.join();
+        }
+    }
+
+private:
+    struct Deque
+    {
+        std::mutex lock;
+        std::deque<Task> tasks;
+    };
+
+    bool pop(unsigned worker, Task &task)
+    {
+        std::lock_guard<std::mutex> guard(deques[worker]->lock);
+        if (deques[worker]->tasks.empty())
+        {
+            return false;
+        }
+        task = std::move(deques[worker]->tasks.back());
+        deques[worker]->tasks.pop_back();
+        return true;
+    }
+
+    bool steal(unsigned thief, Task &task)
+    {
+        for (unsigned i = 1; i < size(); ++i)
+        {
+            Deque &victim = *deques[(thief + i) % size()];
+            std::lock_guard<std::mutex> guard(victim.lock);
+            if (!victim.tasks.empty())
+            {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                stolen++;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::vector<std::unique_ptr<Deque>> deques;
+    std::atomic<size_t> pending;
+    std::atomic<size_t> stolen;
+};
@@ -0,0 +1,160 @@
+/*
+ * Mini-projet 3 : multi-threaded breadth-first search
+ */
+#include "parallel_bfs.hpp"
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <memory>
+#include "parallel.hpp"
+
+namespace
+{
+    // frontier slice handed to a worker at a time
+    const size_t CHUNK = 256;
+
+    size_t chunk_count(size_t size)
+    {
+        return (size + CHUNK - 1) / CHUNK;
+    }
+
+    // parallel_bfs, entering only the compounds allowed() accepts
+    template <class Allowed>
+    BFS level_synchronous_bfs(const AdjacencyGraph &graph, CompoundID start, unsigned threads, const Allowed &allowed)
+    {
+        size_t size = graph.size();
+        if (threads == 0)
+        {
+            threads = default_thread_count();
+        }
+
+        std::unique_ptr<std::atomic<int>[]> distances(new std::atomic<int>[size]);
+        std::unique_ptr<std::atomic<int>[]> parentCount(new std::atomic<int>[size]);
+        for (size_t v = 0; v < size; ++v)
+        {
+            distances[v].store(INT_MAX, std::memory_order_relaxed);
+            parentCount[v].store(0, std::memory_order_relaxed);
+        }
+
+        BFS result;
+        result.start = start;
+        result.parents.resize(size);
+        result.parents[start] = {-1};
+        distances[start].store(0);
+
+        // per worker: compounds claimed this level, and (child, parent position) edges
+        std::vector<std::vector<CompoundID>> localNext(threads);
+        std::vector<std::vector<std::pair<CompoundID, int>>> localEdges(threads);
+        // position in the next frontier of the sequential queue: first parent position, then ID
+        std::vector<long long> order(size);
+
+        std::vector<CompoundID> frontier = {start};
+        std::vector<CompoundID> next;
+        for (int level = 1; !frontier.empty(); ++level)
+        {
+            auto expand = [&](size_t chunk, unsigned worker)
+            {
+                size_t last = std::min(frontier.size(), (chunk + 1) * CHUNK);
+                for (size_t i = chunk * CHUNK; i < last; ++i)
+                {
+                    for (const std::pair<const CompoundID, ReactionID> &pair : graph[frontier[i]])
+                    {
+                        if (!allowed(pair.first))
+                        {
+                            continue;
+                        }
+                        int expected = INT_MAX;
+                        if (distances[pair.first].compare_exchange_strong(expected, level))
+                        {
+                            localNext[worker].push_back(pair.first);
+                        }
+                        else if (expected != level)
+                        {
+                            continue;
+                        }
+                        parentCount[pair.first].fetch_add(1, std::memory_order_relaxed);
+                        localEdges[worker].push_back({pair.first, (int)i});
+                    }
+                }
+            };
+            parallel_for(chunk_count(frontier.size()), threads, expand);
+
+            next.clear();
+            for (std::vector<CompoundID> &claimed : localNext)
+            {
+                next.insert(next.end(), claimed.begin(), claimed.end());
+                claimed.clear();
+            }
+
+            auto allocate = [&](size_t chunk, unsigned)
+            {
+                size_t last = std::min(next.size(), (chunk + 1) * CHUNK);
+                for (size_t j = chunk * CHUNK; j < last; ++j)
+                {
+                    result.parents[next[j]].resize(parentCount[next[j]].load(std::memory_order_relaxed));
+                    parentCount[next[j]].store(0, std::memory_order_relaxed);
+                }
+            };
+            parallel_for(chunk_count(next.size()), threads, allocate);
+
+            auto scatter = [&](size_t worker, unsigned)
+            {
+                for (const std::pair<CompoundID, int> &edge : localEdges[worker])
+                {
+                    int slot = parentCount[edge.first].fetch_add(1, std::memory_order_relaxed);
+                    result.parents[edge.first][slot] = edge.second;
+                }
+                localEdges[worker].clear();
+            };
+            parallel_for(threads, threads, scatter);
+
+            auto finish = [&](size_t chunk, unsigned)
+            {
+                size_t last = std::min(next.size(), (chunk + 1) * CHUNK);
+                for (size_t j = chunk * CHUNK; j < last; ++j)
+                {
+                    std::vector<CompoundID> &parents = result.parents[next[j]];
+                    std::sort(parents.begin(), parents.end());
+                    order[next[j]] = (long long)parents[0] * (long long)size + next[j];
+                    for (CompoundID &parent : parents)
+                    {
+                        parent = frontier[parent];
+                    }
+                }
+            };
+            parallel_for(chunk_count(next.size()), threads, finish);
+
+            auto sequentialOrder = [&](CompoundID a, CompoundID b)
+            {
+                return order[a] < order[b];
+            };
+            std::sort(next.begin(), next.end(), sequentialOrder);
+            frontier.swap(next);
+        }
+
+        result.distances.resize(size);
+        for (size_t v = 0; v < size; ++v)
+        {
+            result.distances[v] = distances[v].load(std::memory_order_relaxed);
+        }
+        return result;
+    }
+}
+
+BFS parallel_bfs(const AdjacencyGraph &graph, CompoundID start, unsigned threads)
+{
+    auto everything = [](CompoundID)
+    {
+        return true;
+    };
+    return level_synchronous_bfs(graph, start, threads, everything);
+}
+
+BFS parallel_bfs(const GraphView &view, CompoundID start, CompoundID destID, unsigned threads)
+{
+    auto allowed = [&](CompoundID compound)
+    {
+        return view.allowed(compound, start, destID);
+    };
+    return level_synchronous_bfs(*view.graph, start, threads, allowed);
+}
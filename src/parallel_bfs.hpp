@@ -0,0 +1,22 @@
+/*
+ * Mini-projet 3 : multi-threaded breadth-first search
+ */
+#pragma once
+#include "pathsearch.hpp"
+#include "graph_view.hpp"
+
+/*!
+ * @brief level-synchronous bfs() expanding each frontier across threads
+ * Distances are claimed with compare-and-swap, each thread fills its own
+ * next-frontier and parent-edge buffers, and a final sort per level puts
+ * the parents (and the next frontier) in the order the sequential queue
+ * would have produced them, so the result is identical to bfs().
+ * Works on directed graphs too, since parents are pushed, not pulled.
+ * @param threads number of workers, 0 means one per hardware thread
+ */
+BFS parallel_bfs(const AdjacencyGraph &graph, CompoundID start, unsigned threads = 0);
+
+/*!
+ * @brief same result as bfs(view, start, destID)
+ */
+BFS parallel_bfs(const GraphView &view, CompoundID start, CompoundID destID = -1, unsigned threads = 0);
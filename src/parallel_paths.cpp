@@ -0,0 +1,209 @@
+/*
+ * Mini-projet 3 : parallel shortest path enumeration
+ */
+#include "parallel_paths.hpp"
+#include <algorithm>
+#include <climits>
+#include "kinetics.hpp"
+#include "parallel.hpp"
+
+namespace
+{
+    // subtree of the walk from the destination: positions [layer, length) of suffix are fixed
+    struct EnumerationTask
+    {
+        size_t node;
+        size_t layer;
+        uint64_t first_rank;
+        Path suffix;
+    };
+
+    // walks every path from node down to the source, ranks counting up from first_rank
+    void walk_subtree(const ShortestPathDag &dag, const EnumerationTask &task, unsigned worker, const RankedPathVisitor &visit)
+    {
+        Path path = task.suffix;
+        uint64_t rank = task.first_rank;
+        std::vector<size_t> stackNode(task.layer + 1), stackNext(task.layer + 1);
+        long depth = 0;
+        stackNode[0] = task.node;
+        stackNext[0] = dag.parent_start[task.node];
+        while (depth >= 0)
+        {
+            size_t v = stackNode[depth];
+            if ((size_t)depth == task.layer)
+            {
+                visit(rank++, path.data(), worker);
+                depth--;
+            }
+            else if (stackNext[depth] < dag.parent_start[v + 1])
+            {
+                const DagEdge &edge = dag.edges[stackNext[depth]++];
+                path[task.layer - 1 - depth] = edge.reaction;
+                depth++;
+                stackNode[depth] = edge.parent;
+                stackNext[depth] = dag.parent_start[edge.parent];
+            }
+            else
+            {
+                depth--;
+            }
+        }
+    }
+
+    // consecutive ranks written by one worker
+    struct PathRun
+    {
+        uint64_t first_rank;
+        size_t count;
+        size_t offset; // in the worker's reaction buffer
+    };
+
+    struct WorkerPaths
+    {
+        std::vector<PathRun> runs;
+        std::vector<ReactionID> reactions;
+    };
+
+    struct MergeEntry
+    {
+        uint64_t first_rank;
+        unsigned worker;
+        size_t run;
+    };
+
+    struct WorkerBest
+    {
+        double rate = INT_MIN;
+        uint64_t rank = UINT64_MAX;
+        Path path;
+        CompiledPath compiled;
+        PathState state, scratch;
+    };
+
+    bool better(double rate, uint64_t rank, const WorkerBest &best)
+    {
+        return rate > best.rate || (rate == best.rate && rank < best.rank);
+    }
+}
+
+size_t for_each_path_parallel(const ShortestPathDag &dag, unsigned threads, const RankedPathVisitor &visit, uint64_t grain)
+{
+    if (dag.nodes.empty())
+    {
+        return 0;
+    }
+    WorkStealingPool<EnumerationTask> pool(threads);
+    if (grain == 0)
+    {
+        grain = std::max<uint64_t>(64, count_paths(dag) / (pool.size() * 32));
+    }
+    size_t length = path_length(dag);
+    pool.push(0, {dag.nodes.size() - 1, length, 0, Path(length)});
+
+    auto runTask = [&](const EnumerationTask &task, unsigned worker)
+    {
+        if (task.layer == 0 || dag.paths_from_source[task.node] <= grain)
+        {
+            walk_subtree(dag, task, worker, visit);
+            return;
+        }
+        // pushed last to first, so the owner continues in rank order and thieves take the far end
+        std::vector<EnumerationTask> children;
+        uint64_t rank = task.first_rank;
+        for (size_t e = dag.parent_start[task.node]; e < dag.parent_start[task.node + 1]; ++e)
+        {
+            const DagEdge &edge = dag.edges[e];
+            EnumerationTask child = {edge.parent, task.layer - 1, rank, task.suffix};
+            child.suffix[task.layer - 1] = edge.reaction;
+            rank += dag.paths_from_source[edge.parent];
+            children.push_back(std::move(child));
+        }
+        for (size_t i = children.size(); i-- > 0;)
+        {
+            pool.push(worker, std::move(children[i]));
+        }
+    };
+    pool.run(runTask);
+    return pool.steals();
+}
+
+Paths to_paths_parallel(const ShortestPathDag &dag, unsigned threads)
+{
+    unsigned workers = threads == 0 ? default_thread_count() : threads;
+    std::vector<WorkerPaths> buffers(workers);
+    size_t length = std::max(path_length(dag), 0);
+
+    auto collect = [&](uint64_t rank, const ReactionID *path, unsigned worker)
+    {
+        WorkerPaths &buffer = buffers[worker];
+        if (buffer.runs.empty() || buffer.runs.back().first_rank + buffer.runs.back().count != rank)
+        {
+            buffer.runs.push_back({rank, 0, buffer.reactions.size()});
+        }
+        buffer.runs.back().count++;
+        buffer.reactions.insert(buffer.reactions.end(), path, path + length);
+    };
+    for_each_path_parallel(dag, workers, collect);
+
+    // runs of every worker, sorted by first rank; stealing leaves a worker's own runs out of order
+    std::vector<MergeEntry> runs;
+    for (unsigned w = 0; w < workers; ++w)
+    {
+        for (size_t r = 0; r < buffers[w].runs.size(); ++r)
+        {
+            runs.push_back({buffers[w].runs[r].first_rank, w, r});
+        }
+    }
+    auto earlier = [](const MergeEntry &a, const MergeEntry &b)
+    {
+        return a.first_rank < b.first_rank;
+    };
+    std::sort(runs.begin(), runs.end(), earlier);
+
+    Paths paths;
+    paths.reserve(count_paths(dag));
+    for (const MergeEntry &entry : runs)
+    {
+        const PathRun &run = buffers[entry.worker].runs[entry.run];
+        const ReactionID *reactions = buffers[entry.worker].reactions.data() + run.offset;
+        for (size_t p = 0; p < run.count; ++p)
+        {
+            paths.emplace_back(reactions + p * length, reactions + (p + 1) * length);
+        }
+    }
+    return paths;
+}
+
+Path find_fastest_path_parallel(const Network &network, const ShortestPathDag &dag, const Concentrations &initial_concentrations,
+                                double dt, unsigned threads)
+{
+    unsigned workers = threads == 0 ? default_thread_count() : threads;
+    std::vector<WorkerBest> best(workers);
+    size_t length = std::max(path_length(dag), 0);
+
+    auto evaluate = [&](uint64_t rank, const ReactionID *path, unsigned worker)
+    {
+        WorkerBest &mine = best[worker];
+        compile_path(network, path, length, mine.compiled);
+        initial_path_state(mine.compiled, initial_concentrations, mine.state);
+        solve_ss_state(mine.compiled, mine.state, mine.scratch, dt);
+        double pathRate = compute_path_rate(mine.compiled, mine.state);
+        if (better(pathRate, rank, mine))
+        {
+            mine.rate = pathRate;
+            mine.rank = rank;
+            mine.path.assign(path, path + length);
+        }
+    };
+    for_each_path_parallel(dag, workers, evaluate);
+
+    const WorkerBest *winner = &best[0];
+    for (const WorkerBest &candidate : best)
+    {
+        if (better(candidate.rate, candidate.rank, *winner))
+        {
+            winner = &candidate;
+        }
+    }
+    return winner->path;
+}
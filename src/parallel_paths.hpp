@@ -0,0 +1,41 @@
+/*
+ * Mini-projet 3 : parallel shortest path enumeration
+ */
+#pragma once
+#include <cstdint>
+#include <functional>
+#include "dag.hpp"
+
+/*!
+ * Called once per path with its index in find_all_shortest_paths order,
+ * its reactions in source -> destination order (path_length(dag) of them)
+ * and the worker running it. Calls come from several threads at once.
+ */
+typedef std::function<void(uint64_t rank, const ReactionID *path, unsigned worker)> RankedPathVisitor;
+
+/*!
+ * @brief calls visit on every path of the DAG from a work-stealing pool
+ * The walk from the destination is split into tasks at nodes with more than
+ * grain paths from the source; smaller subtrees are walked by one worker.
+ * Each task knows the rank of its first path from the DAG path counts.
+ * @param threads number of workers, 0 means one per hardware thread
+ * @param grain largest subtree walked as one task, 0 picks one from the path count
+ * @return number of tasks stolen by another worker than the one that created them
+ */
+size_t for_each_path_parallel(const ShortestPathDag &dag, unsigned threads, const RankedPathVisitor &visit, uint64_t grain = 0);
+
+/*!
+ * @brief same list as to_paths(dag), enumerated in parallel
+ * Workers append runs of consecutive ranks to their own buffers, which are
+ * merged by rank at the end.
+ */
+Paths to_paths_parallel(const ShortestPathDag &dag, unsigned threads = 0);
+
+/*!
+ * @brief same answer as find_fastest_path on to_paths(dag), in parallel
+ * Each path is simulated by the worker that enumerates it, so steady states
+ * are computed while other subtrees are still being expanded. Equal rates
+ * are settled by rank, which gives the sequential tie-breaking.
+ */
+Path find_fastest_path_parallel(const Network &network, const ShortestPathDag &dag, const Concentrations &initial_concentrations,
+                                double dt, unsigned threads = 0);
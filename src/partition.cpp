@@ -0,0 +1,159 @@
+/*
+ * Mini-projet 3 : graph partitioning
+ */
+#include "partition.hpp"
+#include <cmath>
+#include <queue>
+
+namespace
+{
+    const unsigned UNASSIGNED = (unsigned)-1;
+
+    // neighbours of compound in each part, the parts touched are listed in touched
+    void count_neighbours(const AdjacencyGraph &graph, const std::vector<unsigned> &owner, CompoundID compound,
+                          std::vector<size_t> &counts, std::vector<unsigned> &touched)
+    {
+        for (unsigned part : touched)
+        {
+            counts[part] = 0;
+        }
+        touched.clear();
+        for (const std::pair<const CompoundID, ReactionID> &pair : graph[compound])
+        {
+            unsigned part = owner[pair.first];
+            if (part != UNASSIGNED)
+            {
+                if (counts[part] == 0)
+                {
+                    touched.push_back(part);
+                }
+                counts[part]++;
+            }
+        }
+    }
+}
+
+Partition partition_graph(const AdjacencyGraph &graph, unsigned parts, double imbalance, unsigned refinement_passes)
+{
+    Partition partition;
+    partition.parts = parts == 0 ? 1 : parts;
+    partition.owner.assign(graph.size(), UNASSIGNED);
+    partition.sizes.assign(partition.parts, 0);
+    size_t capacity = (size_t)std::ceil(imbalance * graph.size() / partition.parts);
+    if (capacity * partition.parts < graph.size())
+    {
+        capacity = (graph.size() + partition.parts - 1) / partition.parts;
+    }
+
+    std::vector<size_t> counts(partition.parts, 0);
+    std::vector<unsigned> touched;
+    auto place = [&](CompoundID compound)
+    {
+        count_neighbours(graph, partition.owner, compound, counts, touched);
+        unsigned best = UNASSIGNED;
+        double bestScore = -1;
+        for (unsigned part = 0; part < partition.parts; ++part)
+        {
+            if (partition.sizes[part] >= capacity)
+            {
+                continue;
+            }
+            double score = counts[part] * (1.0 - (double)partition.sizes[part] / capacity);
+            // ties go to the emptiest part, so isolated compounds spread out
+            if (best == UNASSIGNED || score > bestScore || (score == bestScore && partition.sizes[part] < partition.sizes[best]))
+            {
+                best = part;
+                bestScore = score;
+            }
+        }
+        partition.owner[compound] = best;
+        partition.sizes[best]++;
+    };
+
+    // BFS order keeps the neighbours of a compound close in the stream
+    std::vector<bool> queued(graph.size(), false);
+    std::queue<CompoundID> queue;
+    for (CompoundID root = 0; root < (CompoundID)graph.size(); ++root)
+    {
+        if (queued[root])
+        {
+            continue;
+        }
+        queued[root] = true;
+        queue.push(root);
+        while (!queue.empty())
+        {
+            CompoundID compound = queue.front();
+            queue.pop();
+            place(compound);
+            for (const std::pair<const CompoundID, ReactionID> &pair : graph[compound])
+            {
+                if (!queued[pair.first])
+                {
+                    queued[pair.first] = true;
+                    queue.push(pair.first);
+                }
+            }
+        }
+    }
+
+    for (unsigned pass = 0; pass < refinement_passes; ++pass)
+    {
+        size_t moves = 0;
+        for (CompoundID compound = 0; compound < (CompoundID)graph.size(); ++compound)
+        {
+            unsigned current = partition.owner[compound];
+            count_neighbours(graph, partition.owner, compound, counts, touched);
+            unsigned best = current;
+            for (unsigned part : touched)
+            {
+                if (counts[part] > counts[best] && partition.sizes[part] < capacity)
+                {
+                    best = part;
+                }
+            }
+            if (best != current && partition.sizes[current] > 1)
+            {
+                partition.owner[compound] = best;
+                partition.sizes[current]--;
+                partition.sizes[best]++;
+                moves++;
+            }
+        }
+        if (moves == 0)
+        {
+            break;
+        }
+    }
+    return partition;
+}
+
+Partition hash_partition(size_t compounds, unsigned parts)
+{
+    Partition partition;
+    partition.parts = parts == 0 ? 1 : parts;
+    partition.sizes.assign(partition.parts, 0);
+    for (size_t c = 0; c < compounds; ++c)
+    {
+        partition.owner.push_back((unsigned)(c % partition.parts));
+        partition.sizes[c % partition.parts]++;
+    }
+    return partition;
+}
+
+size_t edge_cut(const AdjacencyGraph &graph, const Partition &partition)
+{
+    size_t cut = 0;
+    for (CompoundID compound = 0; compound < (CompoundID)graph.size(); ++compound)
+    {
+        for (const std::pair<const CompoundID, ReactionID> &pair : graph[compound])
+        {
+            // each reaction is seen from both ends
+            if (compound < pair.first && partition.owner[compound] != partition.owner[pair.first])
+            {
+                cut++;
+            }
+        }
+    }
+    return cut;
+}
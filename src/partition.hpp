@@ -0,0 +1,38 @@
+/*
+ * Mini-projet 3 : graph partitioning
+ */
+#pragma once
+#include <vector>
+#include "pathsearch.hpp"
+
+/*-----------------  TYPES AND DATA STRUCTURES    ------------*/
+
+// Assignment of every compound to one of parts shards
+struct Partition
+{
+    unsigned parts;
+    // vector index == CompoundID
+    std::vector<unsigned> owner;
+    // vector index == part
+    std::vector<size_t> sizes;
+};
+
+/*!
+ * @brief splits the compounds into parts of at most imbalance * compounds / parts
+ * compounds each, keeping as many reactions as possible inside a part
+ * Compounds are streamed in BFS order and placed with linear deterministic
+ * greedy (most neighbours already in the part, discounted by its fill), then
+ * refinement passes move boundary compounds to the part holding more of
+ * their neighbours while the balance allows it.
+ */
+Partition partition_graph(const AdjacencyGraph &graph, unsigned parts, double imbalance = 1.05, unsigned refinement_passes = 4);
+
+/*!
+ * @brief compound c goes to part c % parts, the baseline of partition_graph
+ */
+Partition hash_partition(size_t compounds, unsigned parts);
+
+/*!
+ * @brief number of reactions whose two compounds are in different parts
+ */
+size_t edge_cut(const AdjacencyGraph &graph, const Partition &partition);
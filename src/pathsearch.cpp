@@ -6,6 +6,7 @@
 #include <iomanip>
 #include "utils.hpp"
 #include "pathsearch.hpp"
+#include "kinetics.hpp"
 #include <cmath>
 #include <array>
 #include <queue>
@@ -35,6 +36,20 @@ CompoundID find_compoundID(const Network &network, CompoundName vertex)
     return compoundID;
 }
 
+KineticTable build_kinetic_table(const Network &network)
+{
+    KineticTable table;
+    for (const Reaction &reaction : network.reactions)
+    {
+        table.V_plus.push_back(reaction.V_plus);
+        table.V_minus.push_back(reaction.V_minus);
+        table.inv_K_S.push_back(1.0 / reaction.K_S);
+        table.inv_K_P.push_back(1.0 / reaction.K_P);
+    }
+
+    return table;
+}
+
 AdjacencyGraph build_adjacency_graph(const Network &network)
 {
     AdjacencyGraph graph(network.compounds.size());
@@ -86,8 +101,8 @@ BFS bfs(const AdjacencyGraph &adjacency_graph, CompoundID start)
 ReactionID find_reactionID(const AdjacencyGraph &adjacency_graph, CompoundID index1, CompoundID index2)
 {
     ReactionID reactionID = -1;
-    std::map<CompoundID, ReactionID> map = adjacency_graph[index1];
-    std::map<CompoundID, ReactionID>::iterator it = map.find(index2);
+    const std::map<CompoundID, ReactionID> &map = adjacency_graph[index1];
+    std::map<CompoundID, ReactionID>::const_iterator it = map.find(index2);
     if (it != map.end())
     {
         reactionID = it->second;
@@ -104,6 +119,10 @@ Path find_shortest_path(const AdjacencyGraph &graph, CompoundID srcID, CompoundI
 {
     BFS result = bfs(graph, srcID);
     Path path;
+    if (result.distances[destID] == INT_MAX)
+    {
+        return path;
+    }
     CompoundID currentNode = destID;
     CompoundID firstParent = result.parents[currentNode][0];
     while (firstParent != -1)
@@ -163,7 +182,7 @@ std::vector<CompoundID> compute_coumpound_path(const Network &network, const Pat
     std::vector<CompoundID> compound_path;
     if (path.size() == 1)
     {
-        Reaction reaction = network.reactions[path[0]];
+        const Reaction &reaction = network.reactions[path[0]];
         compound_path.push_back(reaction.compounds.first);
         compound_path.push_back(reaction.compounds.second);
     }
@@ -171,8 +190,8 @@ std::vector<CompoundID> compute_coumpound_path(const Network &network, const Pat
     {
         for (size_t i = 0; i < path.size() - 1; ++i)
         {
-            Reaction reaction = network.reactions[path[i]];
-            Reaction next = network.reactions[path[i + 1]];
+            const Reaction &reaction = network.reactions[path[i]];
+            const Reaction &next = network.reactions[path[i + 1]];
             CompoundID left = reaction.compounds.first;
             CompoundID right = reaction.compounds.second;
             if (left == next.compounds.first || left == next.compounds.second)
@@ -193,8 +212,8 @@ std::vector<CompoundID> compute_coumpound_path(const Network &network, const Pat
             }
         }
 
-        Reaction reaction = network.reactions[path[path.size() - 1]];
-        Reaction prev = network.reactions[path[path.size() - 2]];
+        const Reaction &reaction = network.reactions[path[path.size() - 1]];
+        const Reaction &prev = network.reactions[path[path.size() - 2]];
         CompoundID left = reaction.compounds.first;
         CompoundID right = reaction.compounds.second;
         if (left == prev.compounds.first || left == prev.compounds.second)
@@ -210,18 +229,19 @@ std::vector<CompoundID> compute_coumpound_path(const Network &network, const Pat
     return compound_path;
 }
 
-Concentrations euler_implicite(const Network &network, const Path &path, const Concentrations c_in, double dt)
+// One Euler step written over the values of c_out, which must hold the same compounds as c_in,
+// so iterating does not rebuild a map (or the compound path) at every step
+static void euler_step_in_place(const Network &network, const Path &path, const std::vector<CompoundID> &compound_path,
+                                const Concentrations &c_in, double dt, std::vector<double> &rates, Concentrations &c_out)
 {
-    std::vector<double> rates;
-    std::vector<CompoundID> compound_path = compute_coumpound_path(network, path);
+    rates.clear();
     for (size_t i = 0; i < path.size(); ++i)
     {
         rates.push_back(michaelis_reversible_rate(network.reactions[path[i]], c_in.find(compound_path[i])->second, c_in.find(compound_path[i + 1])->second));
     }
 
-    Concentrations c_out;
-    size_t i = 0;
-    for (auto it = c_in.begin(); it != c_in.end(); it++)
+    auto out = c_out.begin();
+    for (auto it = c_in.begin(); it != c_in.end(); it++, out++)
     {
         double rateOfChange;
         if (it->first == compound_path[0])
@@ -234,17 +254,25 @@ Concentrations euler_implicite(const Network &network, const Path &path, const C
         }
         else
         {
-            rateOfChange = rates[i] - rates[i + 1];
-            i++;
+            // the map is ordered by ID, not by position along the path
+            size_t i = std::find(compound_path.begin(), compound_path.end(), it->first) - compound_path.begin();
+            rateOfChange = rates[i - 1] - rates[i];
         }
         double newConcentration = it->second + dt * rateOfChange;
         if (newConcentration < 0)
         {
             newConcentration = 0.0;
         }
-        c_out.insert({it->first, newConcentration});
+        out->second = newConcentration;
     }
+}
 
+Concentrations euler_implicite(const Network &network, const Path &path, const Concentrations &c_in, double dt)
+{
+    std::vector<double> rates;
+    rates.reserve(path.size());
+    Concentrations c_out = c_in;
+    euler_step_in_place(network, path, compute_coumpound_path(network, path), c_in, dt, rates, c_out);
     return c_out;
 }
 
@@ -267,10 +295,18 @@ bool checkStable(const Concentrations &c_in, const Concentrations &c_out)
 
 Concentrations compute_ss_concentration(const Network &network, const Path &path, const Concentrations &initial_concentrations, double dt)
 {
+    if (dt == AUTO_DT)
+    {
+        // the map-based steps below take a fixed dt, solve_ss_state chooses it
+        CompiledPath compiled = compile_path(network, path);
+        PathState state = initial_path_state(compiled, initial_concentrations);
+        solve_ss_state(compiled, state, dt);
+        return to_concentrations(compiled, state);
+    }
     Concentrations c_in, c_out;
     for (size_t i = 0; i < path.size(); ++i)
     {
-        Reaction reaction = network.reactions[path[i]];
+        const Reaction &reaction = network.reactions[path[i]];
         CompoundID left = reaction.compounds.first;
         CompoundID right = reaction.compounds.second;
         if (c_in.find(left) == c_in.end())
@@ -283,12 +319,16 @@ Concentrations compute_ss_concentration(const Network &network, const Path &path
         }
     }
 
-    c_out = euler_implicite(network, path, c_in, dt);
+    std::vector<CompoundID> compound_path = compute_coumpound_path(network, path);
+    std::vector<double> rates;
+    rates.reserve(path.size());
+    c_out = c_in;
+    euler_step_in_place(network, path, compound_path, c_in, dt, rates, c_out);
     bool stable = checkStable(c_in, c_out);
     while (!stable)
     {
-        c_in = c_out;
-        c_out = euler_implicite(network, path, c_in, dt);
+        c_in.swap(c_out);
+        euler_step_in_place(network, path, compound_path, c_in, dt, rates, c_out);
         stable = checkStable(c_in, c_out);
     }
     return c_out;
@@ -310,17 +350,17 @@ double compute_path_rate(const Network &network, const Path &path, const Concent
 Path find_fastest_path(const Network &network, const Paths &paths, const Concentrations &initial_concentrations, double dt)
 {
     double maxPathRate = INT_MIN;
-    Path bestPath;
-    for (Path path : paths)
+    const Path *bestPath = nullptr;
+    for (const Path &path : paths)
     {
         Concentrations ss_concentrations = compute_ss_concentration(network, path, initial_concentrations, dt);
         double pathRate = compute_path_rate(network, path, ss_concentrations);
         if (pathRate > maxPathRate)
         {
             maxPathRate = pathRate;
-            bestPath = path;
+            bestPath = &path;
         }
     }
 
-    return bestPath;
+    return bestPath ? *bestPath : Path();
 }
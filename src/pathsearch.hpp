@@ -12,6 +12,8 @@
 const double V_IN = 5.0;
 const double V_OUT = 1.0;
 const double DELTA = 1e-8;
+// pass as dt to let the steady-state solvers choose the time step (see solve_ss_state_auto)
+const double AUTO_DT = 0.0;
 
 /*-----------------  TYPES AND DATA STRUCTURES    ------------*/
 
@@ -30,6 +32,17 @@ struct Reaction
 
 typedef std::vector<std::map<CompoundID, ReactionID>> b;
 
+// Kinetic parameters of all reactions as parallel arrays (structure of arrays),
+// with the Michaelis constants stored as reciprocals so the rate law needs one division
+struct KineticTable
+{
+    // vector index == ReactionID
+    std::vector<double> V_plus;
+    std::vector<double> V_minus;
+    std::vector<double> inv_K_S;
+    std::vector<double> inv_K_P;
+};
+
 struct Network
 {
     // the compounds are well ordered
@@ -37,6 +50,8 @@ struct Network
     std::vector<CompoundName> compounds;
     // vector index == ReactionID
     std::vector<Reaction> reactions;
+    // derived from reactions by build_kinetic_table(), rebuild it after editing reactions
+    KineticTable kinetics;
 };
 typedef std::vector<std::map<CompoundID, ReactionID>> AdjacencyGraph;
 
@@ -59,6 +74,11 @@ typedef std::map<CompoundID, double> Concentrations;
  */
 CompoundID find_compoundID(const Network &network, CompoundName name);
 
+/*!
+ * @brief builds the structure-of-arrays kinetic table of a network's reactions
+ */
+KineticTable build_kinetic_table(const Network &network);
+
 /*!
  * @brief builds the adjacency graph of a network
  */
@@ -84,6 +104,7 @@ BFS bfs(const AdjacencyGraph &graph, CompoundID start);
  * @brief finds a shortest path between a source to a destination compound using breadth-first search
  * @param srcID  Id of the source compound
  * @param destID Id of the destination compound
+ * @return an empty path if the destination is unreachable
  */
 Path find_shortest_path(const AdjacencyGraph &graph, CompoundID srcID, CompoundID destID); // ~30 lines
 
@@ -132,7 +153,7 @@ std::vector<CompoundID> compute_coumpound_path(const Network &network, const Pat
  * @param dt The time period
  * @return The new concentrations computed
  */
-Concentrations euler_implicite(const Network &network, const Path &path, const Concentrations c_in, double dt);
+Concentrations euler_implicite(const Network &network, const Path &path, const Concentrations &c_in, double dt);
 
 /*!
  * @brief Checks if a pair of old and new concentrations are stable or not
@@ -145,6 +166,7 @@ bool checkStable(const Concentrations &c_in, const Concentrations &c_out);
 /*!
  * @brief computes steady state concentrations in a single path : applies euler_implicite until convergence
  * @param initial_concentrations intitial concentrations in the network's compounds
+ * @param dt the time step, or AUTO_DT to pick it from the kinetic parameters and concentrations
  * @return the steady state concentrations in the compounds of the given path
  */
 Concentrations compute_ss_concentration(const Network &network, const Path &path, const Concentrations &initial_concentrations, double dt = 1e-3);
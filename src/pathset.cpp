@@ -0,0 +1,320 @@
+/*
+ * Mini-projet 3 : flat path storage
+ */
+#include "pathset.hpp"
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include "kinetics.hpp"
+
+//==================================================================
+//                          SCRATCH ARENA
+//==================================================================
+
+ScratchArena::ScratchArena(size_t blockSize) : blockSize(blockSize), current(0), offset(0) {}
+
+void *ScratchArena::allocate_bytes(size_t bytes, size_t alignment)
+{
+    while (true)
+    {
+        if (current < blocks.size())
+        {
+            uintptr_t base = reinterpret_cast<uintptr_t>(blocks[current].data.get());
+            uintptr_t start = (base + offset + alignment - 1) & ~(uintptr_t)(alignment - 1);
+            if (start + bytes <= base + blocks[current].size)
+            {
+                offset = start + bytes - base;
+                return reinterpret_cast<void *>(start);
+            }
+            current++;
+            offset = 0;
+        }
+        else
+        {
+            size_t size = std::max(blockSize, bytes + alignment);
+            blocks.push_back({std::unique_ptr<char[]>(new char[size]), size});
+        }
+    }
+}
+
+void ScratchArena::reset()
+{
+    current = 0;
+    offset = 0;
+}
+
+size_t ScratchArena::capacity() const
+{
+    size_t total = 0;
+    for (const Block &block : blocks)
+    {
+        total += block.size;
+    }
+    return total;
+}
+
+//==================================================================
+//                             PATH SET
+//==================================================================
+
+PathSet::PathSet() : stride(0), count(0) {}
+
+void PathSet::clear()
+{
+    buffer.clear();
+    offsets.clear();
+    stride = 0;
+    count = 0;
+}
+
+void PathSet::reserve(size_t paths, size_t reactions)
+{
+    buffer.reserve(reactions);
+    if (!fixed_stride())
+    {
+        offsets.reserve(paths + 1);
+    }
+}
+
+ReactionID *PathSet::append(size_t length)
+{
+    if (count == 0)
+    {
+        stride = length;
+    }
+    else if (fixed_stride() && length != stride)
+    {
+        // first path of a different length: switch to explicit offsets
+        offsets.reserve(count + 2);
+        for (size_t i = 0; i <= count; ++i)
+        {
+            offsets.push_back(i * stride);
+        }
+    }
+    size_t start = buffer.size();
+    buffer.resize(start + length);
+    count++;
+    if (!fixed_stride())
+    {
+        offsets.push_back(buffer.size());
+    }
+    return buffer.data() + start;
+}
+
+void PathSet::push_back(const ReactionID *reactions, size_t length)
+{
+    std::copy(reactions, reactions + length, append(length));
+}
+
+void PathSet::push_back(const Path &path)
+{
+    push_back(path.data(), path.size());
+}
+
+PathView PathSet::operator[](size_t i) const
+{
+    if (fixed_stride())
+    {
+        return {buffer.data() + i * stride, stride};
+    }
+    return {buffer.data() + offsets[i], offsets[i + 1] - offsets[i]};
+}
+
+Paths PathSet::to_paths() const
+{
+    Paths paths;
+    paths.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        paths.push_back((*this)[i].to_path());
+    }
+    return paths;
+}
+
+//==================================================================
+//                      ENUMERATION AND RANKING
+//==================================================================
+
+namespace
+{
+    // the search of find_all_shortest_paths, entering only the compounds allowed() accepts
+    template <class Allowed>
+    void collect_shortest_paths(const AdjacencyGraph &graph, CompoundID srcID, CompoundID destID, PathSet &paths, ScratchArena &arena,
+                                const Allowed &allowed)
+    {
+        arena.reset();
+        paths.clear();
+        size_t size = graph.size();
+        size_t edges = 0;
+        for (const auto &neighbours : graph)
+        {
+            edges += neighbours.size();
+        }
+
+        int *distances = arena.allocate<int>(size);
+        CompoundID *queue = arena.allocate<CompoundID>(size);
+        std::fill(distances, distances + size, -1);
+        // BFS tree edges child <- parent, in the order bfs() appends them to BFS::parents
+        CompoundID *edgeChild = arena.allocate<CompoundID>(edges);
+        CompoundID *edgeParent = arena.allocate<CompoundID>(edges);
+        ReactionID *edgeReaction = arena.allocate<ReactionID>(edges);
+        size_t edgeCount = 0;
+
+        size_t head = 0, tail = 0;
+        distances[srcID] = 0;
+        queue[tail++] = srcID;
+        while (head < tail)
+        {
+            CompoundID currentNode = queue[head++];
+            // nothing beyond the destination's layer can be on a shortest path
+            if (distances[destID] != -1 && distances[currentNode] >= distances[destID])
+            {
+                break;
+            }
+            for (const std::pair<const CompoundID, ReactionID> &pair : graph[currentNode])
+            {
+                if (!allowed(pair.first))
+                {
+                    continue;
+                }
+                if (distances[pair.first] == -1)
+                {
+                    distances[pair.first] = distances[currentNode] + 1;
+                    queue[tail++] = pair.first;
+                }
+                if (distances[pair.first] == distances[currentNode] + 1)
+                {
+                    edgeChild[edgeCount] = pair.first;
+                    edgeParent[edgeCount] = currentNode;
+                    edgeReaction[edgeCount] = pair.second;
+                    edgeCount++;
+                }
+            }
+        }
+        if (distances[destID] == -1)
+        {
+            return;
+        }
+
+        // CSR parent lists, stable so each list keeps the discovery order
+        size_t *parentStart = arena.allocate<size_t>(size + 1);
+        std::fill(parentStart, parentStart + size + 1, 0);
+        for (size_t e = 0; e < edgeCount; ++e)
+        {
+            parentStart[edgeChild[e] + 1]++;
+        }
+        for (size_t v = 0; v < size; ++v)
+        {
+            parentStart[v + 1] += parentStart[v];
+        }
+        size_t *fill = arena.allocate<size_t>(size);
+        std::copy(parentStart, parentStart + size, fill);
+        CompoundID *parents = arena.allocate<CompoundID>(edgeCount);
+        ReactionID *reactions = arena.allocate<ReactionID>(edgeCount);
+        for (size_t e = 0; e < edgeCount; ++e)
+        {
+            size_t slot = fill[edgeChild[e]]++;
+            parents[slot] = edgeParent[e];
+            reactions[slot] = edgeReaction[e];
+        }
+
+        // number of shortest paths reaching each node, to size the output once
+        size_t *pathCounts = arena.allocate<size_t>(size);
+        for (size_t i = 0; i < tail; ++i)
+        {
+            CompoundID v = queue[i];
+            pathCounts[v] = v == srcID ? 1 : 0;
+            for (size_t k = parentStart[v]; k < parentStart[v + 1]; ++k)
+            {
+                pathCounts[v] += pathCounts[parents[k]];
+            }
+        }
+        size_t length = distances[destID];
+        paths.reserve(pathCounts[destID], pathCounts[destID] * length);
+
+        // depth-first walk dest -> src, filling the current path from its end
+        CompoundID *stackNode = arena.allocate<CompoundID>(length + 1);
+        size_t *stackNext = arena.allocate<size_t>(length + 1);
+        ReactionID *current = arena.allocate<ReactionID>(length);
+        long depth = 0;
+        stackNode[0] = destID;
+        stackNext[0] = parentStart[destID];
+        while (depth >= 0)
+        {
+            CompoundID v = stackNode[depth];
+            if ((size_t)depth == length)
+            {
+                paths.push_back(current, length);
+                depth--;
+            }
+            else if (stackNext[depth] < parentStart[v + 1])
+            {
+                size_t k = stackNext[depth]++;
+                current[length - 1 - depth] = reactions[k];
+                depth++;
+                stackNode[depth] = parents[k];
+                stackNext[depth] = parentStart[parents[k]];
+            }
+            else
+            {
+                depth--;
+            }
+        }
+    }
+}
+
+void find_all_shortest_paths(const AdjacencyGraph &graph, CompoundID srcID, CompoundID destID, PathSet &paths, ScratchArena &arena)
+{
+    auto everything = [](CompoundID)
+    {
+        return true;
+    };
+    collect_shortest_paths(graph, srcID, destID, paths, arena, everything);
+}
+
+void find_all_shortest_paths(const GraphView &view, CompoundID srcID, CompoundID destID, PathSet &paths, ScratchArena &arena)
+{
+    auto allowed = [&](CompoundID compound)
+    {
+        return view.allowed(compound, srcID, destID);
+    };
+    collect_shortest_paths(*view.graph, srcID, destID, paths, arena, allowed);
+}
+
+PathView find_fastest_path(const Network &network, const PathSet &paths, const Concentrations &initial_concentrations, double dt)
+{
+    SteadyStateWorkspace workspace;
+    return find_fastest_path(network, paths, initial_concentrations, dt, workspace);
+}
+
+PathView find_fastest_path(const Network &network, const PathSet &paths, const Concentrations &initial_concentrations, double dt,
+                           SteadyStateWorkspace &workspace)
+{
+    double maxPathRate = INT_MIN;
+    PathView bestPath = {nullptr, 0};
+    for (size_t i = 0; i < paths.size(); ++i)
+    {
+        PathView path = paths[i];
+        double pathRate = steady_state_rate(network, path.data, path.length, initial_concentrations, dt, workspace);
+        if (pathRate > maxPathRate)
+        {
+            maxPathRate = pathRate;
+            bestPath = path;
+        }
+    }
+    return bestPath;
+}
+
+PathView find_fastest_path(const AdjacencyGraph &graph, const Network &network, CompoundID srcID, CompoundID destID,
+                           const Concentrations &initial_concentrations, double dt, QueryWorkspace &workspace)
+{
+    find_all_shortest_paths(graph, srcID, destID, workspace.paths, workspace.arena);
+    return find_fastest_path(network, workspace.paths, initial_concentrations, dt, workspace.solver);
+}
+
+PathView find_fastest_path(const GraphView &view, const Network &network, CompoundID srcID, CompoundID destID,
+                           const Concentrations &initial_concentrations, double dt, QueryWorkspace &workspace)
+{
+    find_all_shortest_paths(view, srcID, destID, workspace.paths, workspace.arena);
+    return find_fastest_path(network, workspace.paths, initial_concentrations, dt, workspace.solver);
+}
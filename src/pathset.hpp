@@ -0,0 +1,138 @@
+/*
+ * Mini-projet 3 : flat path storage
+ */
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "kinetics.hpp"
+#include "pathsearch.hpp"
+#include "graph_view.hpp"
+
+/*-----------------  TYPES AND DATA STRUCTURES    ------------*/
+
+/*!
+ * Bump allocator for per-query scratch memory. Blocks are kept on reset(),
+ * so a query that fits in the memory of the previous ones does not touch
+ * the heap. Only meant for trivially destructible types.
+ */
+class ScratchArena
+{
+public:
+    explicit ScratchArena(size_t blockSize = 1 << 16);
+
+    template <class T>
+    T *allocate(size_t count)
+    {
+        return static_cast<T *>(allocate_bytes(count * sizeof(T), alignof(T)));
+    }
+
+    // forgets every allocation, keeping the blocks for the next query
+    void reset();
+    size_t capacity() const;
+
+private:
+    void *allocate_bytes(size_t bytes, size_t alignment);
+
+    struct Block
+    {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+    std::vector<Block> blocks;
+    size_t blockSize;
+    size_t current; // block being filled
+    size_t offset;  // first free byte in the current block
+};
+
+// Non-owning view of one path of a PathSet
+struct PathView
+{
+    const ReactionID *data;
+    size_t length;
+
+    const ReactionID *begin() const { return data; }
+    const ReactionID *end() const { return data + length; }
+    ReactionID operator[](size_t i) const { return data[i]; }
+    bool empty() const { return length == 0; }
+    Path to_path() const { return Path(begin(), end()); }
+};
+
+/*!
+ * All the paths of a query in one contiguous buffer of reaction IDs.
+ * As long as every path has the same length (always the case for shortest
+ * paths) path i starts at i * stride and no offset table is kept; the first
+ * path of a different length switches the set to an explicit offset array.
+ * clear() keeps the capacity, so a PathSet reused across queries stops
+ * allocating once it has seen the largest one.
+ */
+class PathSet
+{
+public:
+    PathSet();
+
+    void clear();
+    void reserve(size_t paths, size_t reactions);
+
+    // appends a path of the given length and returns where to write its reactions
+    ReactionID *append(size_t length);
+    void push_back(const ReactionID *reactions, size_t length);
+    void push_back(const Path &path);
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    bool fixed_stride() const { return offsets.empty(); }
+    PathView operator[](size_t i) const;
+    const std::vector<ReactionID> &reactions() const { return buffer; }
+
+    Paths to_paths() const;
+
+private:
+    std::vector<ReactionID> buffer;
+    std::vector<size_t> offsets; // count + 1 entries, empty while the stride is fixed
+    size_t stride;
+    size_t count;
+};
+
+/*!
+ * @brief finds all shortest paths from srcID to destID into a PathSet
+ * Same paths in the same order as find_all_shortest_paths, written directly
+ * in source -> destination order. The BFS, the parent lists and the DFS stack
+ * live in the arena, which is reset at the start of the call.
+ */
+void find_all_shortest_paths(const AdjacencyGraph &graph, CompoundID srcID, CompoundID destID, PathSet &paths, ScratchArena &arena);
+// same paths as find_all_shortest_paths(view, srcID, destID)
+void find_all_shortest_paths(const GraphView &view, CompoundID srcID, CompoundID destID, PathSet &paths, ScratchArena &arena);
+
+/*!
+ * @brief fastest path of a PathSet, with the same tie-breaking as find_fastest_path
+ * @return a view into paths, empty if paths is empty
+ */
+PathView find_fastest_path(const Network &network, const PathSet &paths, const Concentrations &initial_concentrations, double dt);
+
+/*!
+ * @brief same as above, solving every path in the caller's workspace
+ */
+PathView find_fastest_path(const Network &network, const PathSet &paths, const Concentrations &initial_concentrations, double dt,
+                           SteadyStateWorkspace &workspace);
+
+/*!
+ * Everything a fastest-path query needs between two compounds. A workspace
+ * reused across queries stops allocating once it has served the largest one.
+ */
+struct QueryWorkspace
+{
+    ScratchArena arena;
+    PathSet paths;
+    SteadyStateWorkspace solver;
+};
+
+/*!
+ * @brief fastest of the shortest paths from srcID to destID
+ * Same path as find_fastest_path(network, find_all_shortest_paths(graph, srcID, destID), ...).
+ * @return a view into workspace.paths, valid until the next query
+ */
+PathView find_fastest_path(const AdjacencyGraph &graph, const Network &network, CompoundID srcID, CompoundID destID,
+                           const Concentrations &initial_concentrations, double dt, QueryWorkspace &workspace);
+PathView find_fastest_path(const GraphView &view, const Network &network, CompoundID srcID, CompoundID destID,
+                           const Concentrations &initial_concentrations, double dt, QueryWorkspace &workspace);
@@ -0,0 +1,67 @@
+/*
+ * Mini-projet 3 : seedable random numbers
+ */
+#pragma once
+#include <cstdint>
+
+/*!
+ * Splittable SplitMix64 generator (same scheme as Java's SplittableRandom).
+ * A generator is two 64 bit words, next() is a handful of multiplies and
+ * split() derives a statistically independent stream, so parallel work can
+ * get one reproducible stream per task from a single seed.
+ */
+class SplitMix64
+{
+public:
+    explicit SplitMix64(uint64_t seed) : state(seed), gamma(GOLDEN_GAMMA) {}
+
+    uint64_t next()
+    {
+        state += gamma;
+        return mix64(state);
+    }
+
+    // uniform in [0, 1)
+    double next_double()
+    {
+        return (next() >> 11) * (1.0 / 9007199254740992.0); // 2^-53
+    }
+
+    // uniform in [low, high)
+    double next_double(double low, double high)
+    {
+        return low + (high - low) * next_double();
+    }
+
+    SplitMix64 split()
+    {
+        uint64_t seed = next();
+        state += gamma;
+        return SplitMix64(seed, mix_gamma(state));
+    }
+
+private:
+    static const uint64_t GOLDEN_GAMMA = 0x9e3779b97f4a7c15ULL;
+
+    SplitMix64(uint64_t seed, uint64_t gamma) : state(seed), gamma(gamma) {}
+
+    static uint64_t mix64(uint64_t z)
+    {
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    // gammas must be odd and have enough bit transitions to give a good stream
+    static uint64_t mix_gamma(uint64_t z)
+    {
+        z = (z ^ (z >> 33)) * 0xff51afd7ed558ccdULL;
+        z = (z ^ (z >> 33)) * 0xc4ceb9fe1a85ec53ULL;
+        z = (z ^ (z >> 33)) | 1ULL;
+        int transitions = __builtin_popcountll(z ^ (z >> 1));
+        return transitions < 24 ? z ^ 0xaaaaaaaaaaaaaaaaULL : z;
+    }
+
+    uint64_t state;
+    uint64_t gamma;
+};
@@ -0,0 +1,49 @@
+/*
+ * Mini-projet 3 : batched rate law kernels
+ */
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "pathsearch.hpp"
+
+/*!
+ * @brief evaluates michaelis_reversible_rate for count (reaction, S, P) triples
+ * Parameters are gathered from the kinetic table by reaction ID. The AVX2/FMA
+ * kernel (4 triples per instruction) is used when the CPU supports it, the
+ * portable scalar kernel otherwise. Results may differ from the scalar rate
+ * function in the last bits (reciprocal constants, fused multiply-add).
+ * @param rates output, count values
+ */
+void michaelis_reversible_rate_batch(const KineticTable &table, const ReactionID *reactions,
+                                     const double *S, const double *P, double *rates, size_t count);
+
+/*!
+ * @brief the portable kernel, whatever the CPU
+ */
+void michaelis_reversible_rate_batch_scalar(const KineticTable &table, const ReactionID *reactions,
+                                            const double *S, const double *P, double *rates, size_t count);
+
+/*!
+ * @brief true if the AVX2/FMA kernel can run on this CPU (and was compiled in)
+ */
+bool has_avx2_rate_kernel();
+
+/*!
+ * @brief the AVX2/FMA kernel, only callable when has_avx2_rate_kernel()
+ */
+void michaelis_reversible_rate_batch_avx2(const KineticTable &table, const ReactionID *reactions,
+                                          const double *S, const double *P, double *rates, size_t count);
+
+/*!
+ * @brief name of the kernel picked by michaelis_reversible_rate_batch ("avx2" or "scalar")
+ */
+std::string rate_kernel_name();
+
+/*!
+ * @brief rates of every reaction of the network in one batch, each reaction
+ * oriented as stored (S = compounds.first, P = compounds.second)
+ * @param concentrations vector index == CompoundID
+ * @param rates output, vector index == ReactionID
+ */
+void compute_network_rates(const Network &network, const std::vector<double> &concentrations, std::vector<double> &rates);
@@ -0,0 +1,291 @@
+/*
+ * Mini-projet 3 : cache-friendly renumbering
+ */
+#include "reorder.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <numeric>
+
+namespace
+{
+    std::vector<size_t> degrees(const AdjacencyGraph &graph)
+    {
+        std::vector<size_t> degree(graph.size());
+        for (size_t v = 0; v < graph.size(); ++v)
+        {
+            degree[v] = graph[v].size();
+        }
+        return degree;
+    }
+
+    // breadth-first visit order of every component; roots are tried in the
+    // given order and neighbours sorted by increasing degree if byDegree
+    std::vector<CompoundID> breadth_first_order(const AdjacencyGraph &graph, const std::vector<CompoundID> &roots, bool byDegree)
+    {
+        std::vector<size_t> degree = degrees(graph);
+        std::vector<bool> seen(graph.size(), false);
+        std::vector<CompoundID> order;
+        order.reserve(graph.size());
+        std::vector<CompoundID> neighbours;
+        auto lowerDegree = [&](CompoundID a, CompoundID b)
+        {
+            return degree[a] < degree[b] || (degree[a] == degree[b] && a < b);
+        };
+        for (CompoundID root : roots)
+        {
+            if (seen[root])
+            {
+                continue;
+            }
+            seen[root] = true;
+            order.push_back(root);
+            for (size_t head = order.size() - 1; head < order.size(); ++head)
+            {
+                neighbours.clear();
+                for (const std::pair<const CompoundID, ReactionID> &pair : graph[order[head]])
+                {
+                    if (!seen[pair.first])
+                    {
+                        seen[pair.first] = true;
+                        neighbours.push_back(pair.first);
+                    }
+                }
+                if (byDegree)
+                {
+                    std::sort(neighbours.begin(), neighbours.end(), lowerDegree);
+                }
+                order.insert(order.end(), neighbours.begin(), neighbours.end());
+            }
+        }
+        return order;
+    }
+}
+
+Renumbering compute_renumbering(const Network &network, CompoundOrdering ordering)
+{
+    AdjacencyGraph graph = build_adjacency_graph(network);
+    size_t size = graph.size();
+    std::vector<size_t> degree = degrees(graph);
+
+    std::vector<CompoundID> roots(size);
+    std::iota(roots.begin(), roots.end(), 0);
+    Renumbering mapping;
+    switch (ordering)
+    {
+    case ORDER_IDENTITY:
+        mapping.compound_to_original = roots;
+        break;
+    case ORDER_BFS:
+        mapping.compound_to_original = breadth_first_order(graph, roots, false);
+        break;
+    case ORDER_RCM:
+    {
+        auto lowerDegree = [&](CompoundID a, CompoundID b)
+        {
+            return degree[a] < degree[b] || (degree[a] == degree[b] && a < b);
+        };
+        std::sort(roots.begin(), roots.end(), lowerDegree);
+        mapping.compound_to_original = breadth_first_order(graph, roots, true);
+        std::reverse(mapping.compound_to_original.begin(), mapping.compound_to_original.end());
+        break;
+    }
+    case ORDER_DEGREE:
+    {
+        auto higherDegree = [&](CompoundID a, CompoundID b)
+        {
+            return degree[a] > degree[b] || (degree[a] == degree[b] && a < b);
+        };
+        std::sort(roots.begin(), roots.end(), higherDegree);
+        mapping.compound_to_original = roots;
+        break;
+    }
+    }
+    mapping.compound_to_internal.resize(size);
+    for (size_t i = 0; i < size; ++i)
+    {
+        mapping.compound_to_internal[mapping.compound_to_original[i]] = (CompoundID)i;
+    }
+
+    // reactions follow their lowest internal compound, so a compound's reactions are close together
+    size_t reactions = network.reactions.size();
+    mapping.reaction_to_original.resize(reactions);
+    std::iota(mapping.reaction_to_original.begin(), mapping.reaction_to_original.end(), 0);
+    if (ordering != ORDER_IDENTITY)
+    {
+        auto internalEnds = [&](ReactionID r)
+        {
+            CompoundID a = mapping.compound_to_internal[network.reactions[r].compounds.first];
+            CompoundID b = mapping.compound_to_internal[network.reactions[r].compounds.second];
+            return std::make_pair(std::min(a, b), std::max(a, b));
+        };
+        auto byCompounds = [&](ReactionID a, ReactionID b)
+        {
+            return internalEnds(a) < internalEnds(b);
+        };
+        std::stable_sort(mapping.reaction_to_original.begin(), mapping.reaction_to_original.end(), byCompounds);
+    }
+    mapping.reaction_to_internal.resize(reactions);
+    for (size_t i = 0; i < reactions; ++i)
+    {
+        mapping.reaction_to_internal[mapping.reaction_to_original[i]] = (ReactionID)i;
+    }
+    return mapping;
+}
+
+ReorderedNetwork reorder_network(const Network &network, CompoundOrdering ordering)
+{
+    ReorderedNetwork reordered;
+    reordered.mapping = compute_renumbering(network, ordering);
+    const Renumbering &mapping = reordered.mapping;
+    for (CompoundID original : mapping.compound_to_original)
+    {
+        reordered.network.compounds.push_back(network.compounds[original]);
+    }
+    for (ReactionID original : mapping.reaction_to_original)
+    {
+        // keep the stored direction, compute_coumpound_path depends on it
+        Reaction reaction = network.reactions[original];
+        reaction.compounds.first = mapping.compound_to_internal[reaction.compounds.first];
+        reaction.compounds.second = mapping.compound_to_internal[reaction.compounds.second];
+        reordered.network.reactions.push_back(reaction);
+    }
+    reordered.network.kinetics = build_kinetic_table(reordered.network);
+    reordered.graph = build_adjacency_graph(reordered.network);
+    return reordered;
+}
+
+double mean_id_gap(const Network &network)
+{
+    if (network.reactions.empty())
+    {
+        return 0;
+    }
+    double total = 0;
+    for (const Reaction &reaction : network.reactions)
+    {
+        total += std::abs(reaction.compounds.first - reaction.compounds.second);
+    }
+    return total / network.reactions.size();
+}
+
+std::string to_string(CompoundOrdering ordering)
+{
+    switch (ordering)
+    {
+    case ORDER_IDENTITY:
+        return "identity";
+    case ORDER_BFS:
+        return "bfs";
+    case ORDER_RCM:
+        return "rcm";
+    case ORDER_DEGREE:
+        return "degree";
+    }
+    return "";
+}
+
+//==================================================================
+//                          ID TRANSLATION
+//==================================================================
+
+Path internal_path(const Renumbering &mapping, const Path &path)
+{
+    Path translated;
+    translated.reserve(path.size());
+    for (ReactionID reaction : path)
+    {
+        translated.push_back(mapping.reaction_to_internal[reaction]);
+    }
+    return translated;
+}
+
+Path original_path(const Renumbering &mapping, const Path &path)
+{
+    Path translated;
+    translated.reserve(path.size());
+    for (ReactionID reaction : path)
+    {
+        translated.push_back(mapping.reaction_to_original[reaction]);
+    }
+    return translated;
+}
+
+Concentrations internal_concentrations(const Renumbering &mapping, const Concentrations &concentrations)
+{
+    Concentrations translated;
+    for (const std::pair<const CompoundID, double> &pair : concentrations)
+    {
+        translated[mapping.compound_to_internal[pair.first]] = pair.second;
+    }
+    return translated;
+}
+
+Concentrations original_concentrations(const Renumbering &mapping, const Concentrations &concentrations)
+{
+    Concentrations translated;
+    for (const std::pair<const CompoundID, double> &pair : concentrations)
+    {
+        translated[mapping.compound_to_original[pair.first]] = pair.second;
+    }
+    return translated;
+}
+
+BFS original_bfs(const Renumbering &mapping, const BFS &result)
+{
+    size_t size = result.distances.size();
+    BFS translated;
+    translated.start = mapping.compound_to_original[result.start];
+    translated.parents.resize(size);
+    translated.distances.resize(size);
+    for (size_t i = 0; i < size; ++i)
+    {
+        CompoundID original = mapping.compound_to_original[i];
+        translated.distances[original] = result.distances[i];
+        std::vector<CompoundID> &parents = translated.parents[original];
+        parents.reserve(result.parents[i].size());
+        for (CompoundID parent : result.parents[i])
+        {
+            parents.push_back(parent == -1 ? -1 : mapping.compound_to_original[parent]);
+        }
+    }
+    return translated;
+}
+
+//==================================================================
+//                     QUERIES WITH ORIGINAL IDS
+//==================================================================
+
+BFS bfs(const ReorderedNetwork &reordered, CompoundID start)
+{
+    return original_bfs(reordered.mapping, bfs(reordered.graph, reordered.mapping.compound_to_internal[start]));
+}
+
+Path find_shortest_path(const ReorderedNetwork &reordered, CompoundID srcID, CompoundID destID)
+{
+    const Renumbering &mapping = reordered.mapping;
+    return original_path(mapping, find_shortest_path(reordered.graph, mapping.compound_to_internal[srcID], mapping.compound_to_internal[destID]));
+}
+
+Paths find_all_shortest_paths(const ReorderedNetwork &reordered, CompoundID srcID, CompoundID destID)
+{
+    const Renumbering &mapping = reordered.mapping;
+    Paths paths = find_all_shortest_paths(reordered.graph, mapping.compound_to_internal[srcID], mapping.compound_to_internal[destID]);
+    for (Path &path : paths)
+    {
+        path = original_path(mapping, path);
+    }
+    return paths;
+}
+
+Path find_fastest_path(const ReorderedNetwork &reordered, const Paths &paths, const Concentrations &initial_concentrations, double dt)
+{
+    const Renumbering &mapping = reordered.mapping;
+    Paths internal;
+    internal.reserve(paths.size());
+    for (const Path &path : paths)
+    {
+        internal.push_back(internal_path(mapping, path));
+    }
+    Path best = find_fastest_path(reordered.network, internal, internal_concentrations(mapping, initial_concentrations), dt);
+    return original_path(mapping, best);
+}
@@ -0,0 +1,93 @@
+/*
+ * Mini-projet 3 : cache-friendly renumbering
+ */
+#pragma once
+#include <string>
+#include <vector>
+#include "pathsearch.hpp"
+
+/*-----------------  TYPES AND DATA STRUCTURES    ------------*/
+
+enum CompoundOrdering
+{
+    ORDER_IDENTITY,
+    // breadth-first from the first compound of each component
+    ORDER_BFS,
+    // reverse Cuthill-McKee: breadth-first from a low-degree compound, neighbours by increasing degree, reversed
+    ORDER_RCM,
+    // hubs first, so the cofactors most traversals touch share cache lines
+    ORDER_DEGREE
+};
+
+// Bidirectional mapping between the IDs of the file and the internal ones
+struct Renumbering
+{
+    // vector index == original CompoundID
+    std::vector<CompoundID> compound_to_internal;
+    // vector index == internal CompoundID
+    std::vector<CompoundID> compound_to_original;
+    // vector index == original ReactionID
+    std::vector<ReactionID> reaction_to_internal;
+    // vector index == internal ReactionID
+    std::vector<ReactionID> reaction_to_original;
+};
+
+// A network stored with internal IDs, queried with original ones
+struct ReorderedNetwork
+{
+    Network network;
+    AdjacencyGraph graph;
+    Renumbering mapping;
+};
+
+///------------- Renumbering -------------
+
+/*!
+ * @brief computes a compound order and sorts the reactions by their internal compounds
+ */
+Renumbering compute_renumbering(const Network &network, CompoundOrdering ordering);
+
+/*!
+ * @brief permutes the compounds and reactions of a network and rebuilds its graph
+ */
+ReorderedNetwork reorder_network(const Network &network, CompoundOrdering ordering);
+
+/*!
+ * @brief mean |a - b| over the reactions a <-> b, a locality measure of a numbering
+ */
+double mean_id_gap(const Network &network);
+
+std::string to_string(CompoundOrdering ordering);
+
+///------------- ID translation -------------
+
+Path internal_path(const Renumbering &mapping, const Path &path);
+Path original_path(const Renumbering &mapping, const Path &path);
+Concentrations internal_concentrations(const Renumbering &mapping, const Concentrations &concentrations);
+Concentrations original_concentrations(const Renumbering &mapping, const Concentrations &concentrations);
+
+/*!
+ * @brief translates a bfs() result computed on internal IDs to original IDs
+ * Parents of a compound are listed in internal order.
+ */
+BFS original_bfs(const Renumbering &mapping, const BFS &result);
+
+///------------- Queries with original IDs -------------
+
+BFS bfs(const ReorderedNetwork &reordered, CompoundID start);
+
+/*!
+ * @brief a shortest path, maybe another one than on the original numbering
+ * since ties are broken in internal order
+ */
+Path find_shortest_path(const ReorderedNetwork &reordered, CompoundID srcID, CompoundID destID);
+
+/*!
+ * @brief the same set of paths as on the original numbering, in internal order
+ */
+Paths find_all_shortest_paths(const ReorderedNetwork &reordered, CompoundID srcID, CompoundID destID);
+
+/*!
+ * @brief same result as find_fastest_path() on the original network
+ */
+Path find_fastest_path(const ReorderedNetwork &reordered, const Paths &paths, const Concentrations &initial_concentrations, double dt);
@@ -0,0 +1,164 @@
+/*
+ * Mini-projet 3 : mixed precision path screening
+ */
+#include "screening.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <map>
+
+template <class Real>
+void screen_path_rates(const Network &network, const PathSet &paths, const Concentrations &initial_concentrations, double dt,
+                       double tolerance, size_t max_iterations, std::vector<double> &rates, std::vector<bool> &converged)
+{
+    rates.assign(paths.size(), 0.0);
+    converged.assign(paths.size(), false);
+    // lanes run paths of one length
+    std::map<size_t, std::vector<size_t>> byLength;
+    for (size_t i = 0; i < paths.size(); ++i)
+    {
+        byLength[paths[i].length].push_back(i);
+    }
+
+    PathLanes<Real> lanes;
+    SteadyStateWorkspace workspace;
+    Real stable[PathLanes<Real>::WIDTH];
+    bool automatic = dt == AUTO_DT;
+    // vector index == lane
+    Real laneDt[PathLanes<Real>::WIDTH];
+    std::fill(laneDt, laneDt + PathLanes<Real>::WIDTH, (Real)dt);
+    for (const std::pair<const size_t, std::vector<size_t>> &group : byLength)
+    {
+        if (group.first == 0)
+        {
+            continue; // no reaction, no rate
+        }
+        lanes.reset(group.first);
+        // vector index == lane: index in paths (SIZE_MAX when idle) and steps run
+        size_t owner[PathLanes<Real>::WIDTH], iterations[PathLanes<Real>::WIDTH];
+        size_t nextPath = 0, active = 0;
+        auto fill = [&](size_t lane)
+        {
+            if (nextPath == group.second.size())
+            {
+                owner[lane] = SIZE_MAX;
+                lanes.idle(lane);
+                return;
+            }
+            owner[lane] = group.second[nextPath++];
+            iterations[lane] = 0;
+            PathView path = paths[owner[lane]];
+            compile_path(network, path.data, path.length, workspace.compiled);
+            initial_path_state(workspace.compiled, initial_concentrations, workspace.state);
+            lanes.load(lane, workspace.compiled, workspace.state);
+            active++;
+        };
+        for (size_t lane = 0; lane < PathLanes<Real>::WIDTH; ++lane)
+        {
+            fill(lane);
+        }
+        while (active > 0)
+        {
+            for (size_t lane = 0; automatic && lane < PathLanes<Real>::WIDTH; ++lane)
+            {
+                if (owner[lane] != SIZE_MAX && iterations[lane] % AUTO_DT_REESTIMATE_EVERY == 0)
+                {
+                    laneDt[lane] = Real(1) / lanes.spectral_bound(lane);
+                }
+            }
+            lanes.step(laneDt, (Real)tolerance, stable);
+            for (size_t lane = 0; lane < PathLanes<Real>::WIDTH; ++lane)
+            {
+                if (owner[lane] == SIZE_MAX)
+                {
+                    continue;
+                }
+                iterations[lane]++;
+                if (stable[lane] != 0 || iterations[lane] >= max_iterations)
+                {
+                    rates[owner[lane]] = lanes.path_rate(lane);
+                    converged[owner[lane]] = stable[lane] != 0;
+                    active--;
+                    fill(lane);
+                }
+            }
+        }
+    }
+}
+
+template void screen_path_rates<float>(const Network &, const PathSet &, const Concentrations &, double, double, size_t,
+                                       std::vector<double> &, std::vector<bool> &);
+template void screen_path_rates<double>(const Network &, const PathSet &, const Concentrations &, double, double, size_t,
+                                        std::vector<double> &, std::vector<bool> &);
+
+PathView find_fastest_path_screened(const Network &network, const PathSet &paths, const Concentrations &initial_concentrations,
+                                    double dt, const ScreeningOptions &options, ScreeningStats *stats)
+{
+    std::map<size_t, size_t> groupSizes;
+    for (size_t i = 0; i < paths.size(); ++i)
+    {
+        groupSizes[paths[i].length]++;
+    }
+    // vector index == index in paths
+    std::vector<bool> screenedPath(paths.size());
+    PathSet toScreen;
+    for (size_t i = 0; i < paths.size(); ++i)
+    {
+        screenedPath[i] = groupSizes[paths[i].length] >= options.min_group;
+        if (screenedPath[i])
+        {
+            toScreen.push_back(paths[i].data, paths[i].length);
+        }
+    }
+    std::vector<double> screened;
+    std::vector<bool> converged;
+    screen_path_rates<float>(network, toScreen, initial_concentrations, dt, options.tolerance, options.max_iterations, screened,
+                             converged);
+
+    double leader = 0;
+    bool found = false;
+    for (size_t j = 0; j < toScreen.size(); ++j)
+    {
+        if (converged[j] && (!found || screened[j] > leader))
+        {
+            leader = screened[j];
+            found = true;
+        }
+    }
+    double threshold = leader - options.margin * std::fabs(leader);
+
+    // same scan as find_fastest_path, over the paths solved in double only
+    SteadyStateWorkspace workspace;
+    double maxPathRate = INT_MIN;
+    PathView bestPath = {nullptr, 0};
+    size_t direct = 0, refined = 0, unconverged = 0;
+    for (size_t i = 0, j = 0; i < paths.size(); ++i)
+    {
+        if (screenedPath[i])
+        {
+            bool kept = !converged[j] || screened[j] >= threshold;
+            unconverged += !converged[j];
+            j++;
+            if (!kept)
+            {
+                continue;
+            }
+            refined++;
+        }
+        else
+        {
+            direct++;
+        }
+        PathView path = paths[i];
+        double pathRate = steady_state_rate(network, path.data, path.length, initial_concentrations, dt, workspace);
+        if (pathRate > maxPathRate)
+        {
+            maxPathRate = pathRate;
+            bestPath = path;
+        }
+    }
+    if (stats)
+    {
+        *stats = {paths.size(), direct, refined, unconverged};
+    }
+    return bestPath;
+}
@@ -0,0 +1,214 @@
+/*
+ * Mini-projet 3 : mixed precision path screening
+ */
+#pragma once
+#include <climits>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include "kinetics.hpp"
+#include "pathset.hpp"
+
+/*!
+ * Euler solver for WIDTH paths of the same length at once, one path per lane.
+ * Parameters and state are stored lane-minor (structure of arrays), so every
+ * loop over lanes is a straight vector loop. Real is float for screening,
+ * which fits twice the lanes of double in a vector register. With Real =
+ * double and tolerance = DELTA the arithmetic is the one of euler_step and
+ * checkStable, and each lane gives the rate of steady_state_rate.
+ * Lanes are independent: a lane whose path is stable can be loaded with the
+ * next path while the others keep iterating.
+ */
+template <class Real>
+struct PathLanes
+{
+    static constexpr size_t WIDTH = 32 / sizeof(Real);
+
+    size_t length; // reactions per path
+    // vector index == step * WIDTH + lane
+    std::vector<Real> V_plus, V_minus, K_S, K_P;
+    // vector index == compound * WIDTH + lane
+    std::vector<Real> state, next;
+
+    // idles every lane, for paths of length reactions
+    void reset(size_t reactions)
+    {
+        length = reactions;
+        V_plus.resize(length * WIDTH);
+        V_minus.resize(length * WIDTH);
+        K_S.resize(length * WIDTH);
+        K_P.resize(length * WIDTH);
+        state.resize((length + 1) * WIDTH);
+        next.resize((length + 1) * WIDTH);
+        for (size_t lane = 0; lane < WIDTH; ++lane)
+        {
+            idle(lane);
+        }
+    }
+
+    // an idle lane holds a path that stays finite: no flux, every compound at 1
+    void idle(size_t lane)
+    {
+        for (size_t k = 0; k < length; ++k)
+        {
+            V_plus[k * WIDTH + lane] = V_minus[k * WIDTH + lane] = Real(0);
+            K_S[k * WIDTH + lane] = K_P[k * WIDTH + lane] = Real(1);
+        }
+        for (size_t k = 0; k <= length; ++k)
+        {
+            state[k * WIDTH + lane] = Real(1);
+        }
+    }
+
+    // puts a compiled path and its initial state in a lane
+    void load(size_t lane, const CompiledPath &path, const PathState &initial)
+    {
+        for (size_t k = 0; k < length; ++k)
+        {
+            V_plus[k * WIDTH + lane] = (Real)path.steps[k].V_plus;
+            V_minus[k * WIDTH + lane] = (Real)path.steps[k].V_minus;
+            K_S[k * WIDTH + lane] = (Real)path.steps[k].K_S;
+            K_P[k * WIDTH + lane] = (Real)path.steps[k].K_P;
+        }
+        for (size_t k = 0; k <= length; ++k)
+        {
+            state[k * WIDTH + lane] = (Real)initial[k];
+        }
+    }
+
+    static Real rate(Real vPlus, Real vMinus, Real kS, Real kP, Real S, Real P)
+    {
+        return (vPlus * (S / kS) - vMinus * (P / kP)) / (1 + S / kS + P / kP);
+    }
+
+    // jacobian_spectral_bound of the current state of a lane
+    Real spectral_bound(size_t lane) const
+    {
+        Real bound = 0, previousDP = 0;
+        for (size_t k = 0; k <= length; ++k)
+        {
+            Real dS = 0, dP = 0;
+            if (k < length)
+            {
+                size_t i = k * WIDTH + lane;
+                Real S = state[i], P = state[i + WIDTH];
+                Real forward = V_plus[i] / K_S[i], backward = V_minus[i] / K_P[i];
+                Real denominator = Real(1) + S / K_S[i] + P / K_P[i];
+                dS = (forward * (Real(1) + P / K_P[i]) + backward * P / K_S[i]) / (denominator * denominator);
+                dP = (backward * (Real(1) + S / K_S[i]) + forward * S / K_P[i]) / (denominator * denominator);
+            }
+            Real column = Real(2) * (dS + previousDP) + (k == 0 ? Real(V_IN) : Real(0)) + (k == length ? Real(V_OUT) : Real(0));
+            bound = column > bound ? column : bound;
+            previousDP = dP;
+        }
+        return bound;
+    }
+
+    /*!
+     * @brief one Euler step of every lane
+     * @param dt WIDTH values, the time step of each lane
+     * @param stable output, WIDTH values: non zero if no compound of the lane
+     * changed by tolerance or more (relative), as checkStable
+     */
+    void step(const Real *dt, Real tolerance, Real *stable)
+    {
+        Real incoming[WIDTH] = {};
+        for (size_t k = 0; k < length; ++k)
+        {
+            const Real *c = &state[k * WIDTH];
+            const Real *p = &state[(k + 1) * WIDTH];
+            Real *out = &next[k * WIDTH];
+            for (size_t lane = 0; lane < WIDTH; ++lane)
+            {
+                size_t i = k * WIDTH + lane;
+                Real outgoing = rate(V_plus[i], V_minus[i], K_S[i], K_P[i], c[lane], p[lane]);
+                Real rateOfChange = (k == 0 ? Real(V_IN) * (1 - c[lane]) : incoming[lane]) - outgoing;
+                Real newConcentration = c[lane] + dt[lane] * rateOfChange;
+                out[lane] = newConcentration < 0 ? Real(0) : newConcentration;
+                incoming[lane] = outgoing;
+            }
+        }
+        const Real *c = &state[length * WIDTH];
+        Real *out = &next[length * WIDTH];
+        for (size_t lane = 0; lane < WIDTH; ++lane)
+        {
+            Real newConcentration = c[lane] + dt[lane] * (incoming[lane] - c[lane] * Real(V_OUT));
+            out[lane] = newConcentration < 0 ? Real(0) : newConcentration;
+            stable[lane] = 1;
+        }
+        for (size_t k = 0; k <= length; ++k)
+        {
+            const Real *before = &state[k * WIDTH];
+            const Real *after = &next[k * WIDTH];
+            for (size_t lane = 0; lane < WIDTH; ++lane)
+            {
+                // written as checkStable, so that a NaN (0 / 0) is stable
+                stable[lane] = std::fabs(after[lane] - before[lane]) / after[lane] >= tolerance ? Real(0) : stable[lane];
+            }
+        }
+        state.swap(next);
+    }
+
+    // compute_path_rate of the current state of a lane
+    Real path_rate(size_t lane) const
+    {
+        Real minRate = (Real)INT_MAX;
+        for (size_t k = 0; k < length; ++k)
+        {
+            size_t i = k * WIDTH + lane;
+            Real r = rate(V_plus[i], V_minus[i], K_S[i], K_P[i], state[i], state[i + WIDTH]);
+            minRate = r < minRate ? r : minRate;
+        }
+        return minRate;
+    }
+};
+
+struct ScreeningOptions
+{
+    // candidates screened within margin * |leader| of the leader are re-solved in double
+    double margin;
+    // relative change per step under which a float lane is stable
+    double tolerance;
+    // steps after which a lane is given up and always re-solved
+    size_t max_iterations;
+    // paths of a length shared by fewer candidates go straight to the double
+    // solver: screening them leaves most lanes idle and solves the leaders twice
+    size_t min_group;
+};
+
+const ScreeningOptions DEFAULT_SCREENING = {1e-2, 1e-7, 1000000, 2 * PathLanes<float>::WIDTH};
+
+struct ScreeningStats
+{
+    size_t candidates;
+    size_t direct;      // solved in double only, their group being too small
+    size_t refined;     // screened, then re-solved in double
+    size_t unconverged; // lanes given up by the screening
+};
+
+/*!
+ * @brief steady-state rate of every path of a set, solved in lanes of Real
+ * Paths are grouped by length; each group streams through the lanes, a
+ * stable lane taking the next path of the group. A path still moving after
+ * max_iterations steps is reported as not converged with the rate of its
+ * last state. With dt = AUTO_DT each lane takes the step of
+ * solve_ss_state_auto from its own spectral_bound.
+ * @param rates output, vector index == index in paths
+ * @param converged output, vector index == index in paths
+ */
+template <class Real>
+void screen_path_rates(const Network &network, const PathSet &paths, const Concentrations &initial_concentrations, double dt,
+                       double tolerance, size_t max_iterations, std::vector<double> &rates, std::vector<bool> &converged);
+
+/*!
+ * @brief find_fastest_path in two stages
+ * Paths whose length is shared by at least options.min_group candidates are
+ * screened in float lanes; only the leader and the paths whose screened rate
+ * lies within options.margin of it (or did not converge) are re-solved with
+ * the double solver, along with the paths of smaller groups. The answer is
+ * the one of find_fastest_path as long as the screening error stays under
+ * half the margin.
+ * @param stats if not null, receives how many paths were solved in double
+ */
+PathView find_fastest_path_screened(const Network &network, const PathSet &paths, const Concentrations &initial_concentrations,
+                                    double dt, const ScreeningOptions &options = DEFAULT_SCREENING, ScreeningStats *stats = nullptr);
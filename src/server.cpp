@@ -0,0 +1,606 @@
+/*
+ * Mini-projet 3 : query daemon
+ */
+#include "server.hpp"
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <fstream>
+#include <poll.h>
+#include <sstream>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include "anytime.hpp"
+#include "dag.hpp"
+#include "kinetics.hpp"
+#include "parallel.hpp"
+#include "utils.hpp"
+
+//==================================================================
+//                            REGISTRY
+//==================================================================
+
+namespace
+{
+    std::shared_ptr<const LoadedNetwork> load_network(const std::string &name, const std::string &network_file,
+                                                      const std::string &concentrations_file)
+    {
+        std::ifstream networkStream(network_file);
+        if (!networkStream)
+        {
+            throw std::runtime_error("cannot read " + network_file);
+        }
+        std::ifstream concentrationsStream(concentrations_file);
+        if (!concentrationsStream)
+        {
+            throw std::runtime_error("cannot read " + concentrations_file);
+        }
+        auto loaded = std::make_shared<LoadedNetwork>();
+        loaded->name = name;
+        loaded->network_file = network_file;
+        loaded->concentrations_file = concentrations_file;
+        loaded->network = read_network(networkStream);
+        loaded->graph = build_indexed_graph(loaded->network);
+        loaded->concentrations = read_initial_concentrations(loaded->network, concentrationsStream);
+        for (size_t i = 0; i < loaded->network.compounds.size(); ++i)
+        {
+            loaded->ids[loaded->network.compounds[i]] = (CompoundID)i;
+        }
+        return loaded;
+    }
+}
+
+void NetworkRegistry::load(const std::string &name, const std::string &network_file, const std::string &concentrations_file)
+{
+    // parse outside the lock, queries keep running on the other networks
+    std::shared_ptr<const LoadedNetwork> loaded = load_network(name, network_file, concentrations_file);
+    std::lock_guard<std::mutex> lock(mutex);
+    networks[name] = loaded;
+}
+
+void NetworkRegistry::reload(const std::string &name)
+{
+    std::shared_ptr<const LoadedNetwork> current = get(name);
+    if (!current)
+    {
+        throw std::runtime_error("unknown network " + name);
+    }
+    load(name, current->network_file, current->concentrations_file);
+}
+
+std::shared_ptr<const LoadedNetwork> NetworkRegistry::get(const std::string &name) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = networks.find(name);
+    return it == networks.end() ? nullptr : it->second;
+}
+
+std::vector<std::string> NetworkRegistry::names() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::string> result;
+    for (const auto &entry : networks)
+    {
+        result.push_back(entry.first);
+    }
+    return result;
+}
+
+//==================================================================
+//                            PROTOCOL
+//==================================================================
+
+namespace
+{
+    void append_path(std::ostringstream &out, const Path &path)
+    {
+        for (ReactionID r : path)
+        {
+            out << " " << r;
+        }
+    }
+
+    CompoundID lookup(const LoadedNetwork &loaded, const std::string &name)
+    {
+        auto it = loaded.ids.find(name);
+        if (it == loaded.ids.end())
+        {
+            throw std::runtime_error("unknown compound " + name);
+        }
+        return it->second;
+    }
+}
+
+std::string answer_query(NetworkRegistry &registry, const std::string &request)
+{
+    std::istringstream in(request);
+    std::vector<std::string> words;
+    std::string word;
+    while (in >> word)
+    {
+        words.push_back(word);
+    }
+    if (words.empty())
+    {
+        return "ERR empty request";
+    }
+
+    try
+    {
+        std::ostringstream out;
+        out << "OK";
+        const std::string &command = words[0];
+        if (command == "ping")
+        {
+            out << " pong";
+        }
+        else if (command == "list")
+        {
+            for (const std::string &name : registry.names())
+            {
+                out << " " << name;
+            }
+        }
+        else if (command == "load" && words.size() == 4)
+        {
+            registry.load(words[1], words[2], words[3]);
+            out << " loaded " << words[1];
+        }
+        else if (command == "reload" && words.size() == 2)
+        {
+            registry.reload(words[1]);
+            out << " reloaded " << words[1];
+        }
+        else if ((command == "distance" || command == "shortest" || command == "all" || command == "fastest") &&
+                 (words.size() == 4 || (command == "fastest" && words.size() == 5)))
+        {
+            std::shared_ptr<const LoadedNetwork> loaded = registry.get(words[1]);
+            if (!loaded)
+            {
+                return "ERR unknown network " + words[1];
+            }
+            CompoundID src = lookup(*loaded, words[2]);
+            CompoundID dest = lookup(*loaded, words[3]);
+            if (!same_component(loaded->graph, src, dest))
+            {
+                if (command == "distance")
+                {
+                    return "OK -1";
+                }
+                return "ERR " + words[3] + " is not reachable from " + words[2];
+            }
+            ShortestPathDag dag = build_shortest_path_dag(loaded->graph.adjacency, src, dest);
+            if (command == "distance")
+            {
+                out << " " << path_length(dag);
+            }
+            else if (count_paths(dag) == 0)
+            {
+                return "ERR " + words[3] + " is not reachable from " + words[2];
+            }
+            else if (command == "shortest")
+            {
+                append_path(out, get_path(dag, 0));
+            }
+            else if (command == "all")
+            {
+                out << " " << count_paths(dag);
+                auto appendOne = [&](const Path &path)
+                {
+                    out << " ;";
+                    append_path(out, path);
+                };
+                for_each_path(dag, appendOne);
+            }
+            else
+            {
+                double dt = words.size() == 5 ? (words[4] == "auto" ? AUTO_DT : std::stod(words[4])) : 1e-3;
+                if (!std::isfinite(dt) || dt < 0 || dt > MAX_REQUEST_DT)
+                {
+                    return "ERR dt must be in (0, " + std::to_string(MAX_REQUEST_DT) + "] or auto";
+                }
+                // a worker must not be held forever by a step that never converges
+                QueryBudget budget;
+                budget.max_path_iterations = MAX_REQUEST_PATH_ITERATIONS;
+                budget.max_total_iterations = MAX_REQUEST_ITERATIONS;
+                AnytimeResult best = find_fastest_path_anytime(loaded->network, dag, loaded->concentrations, dt, budget);
+                if (best.stats.unconverged > 0 || best.stats.stop != STOP_COMPLETED)
+                {
+                    return "ERR steady state not reached within the step budget";
+                }
+                out << " " << best.rate << " ;";
+                append_path(out, best.path);
+            }
+        }
+        else
+        {
+            return "ERR bad request: " + request;
+        }
+        return out.str();
+    }
+    catch (const std::exception &e)
+    {
+        return std::string("ERR ") + e.what();
+    }
+}
+
+//==================================================================
+//                             SERVER
+//==================================================================
+
+namespace
+{
+    struct Job
+    {
+        uint64_t connection;
+        uint64_t sequence;
+        std::string request;
+    };
+
+    struct Connection
+    {
+        int fd;
+        std::string in;
+        std::string out;
+        uint64_t nextSequence = 0; // given to the next request read
+        uint64_t nextToSend = 0;   // next response to append to out
+        std::map<uint64_t, std::string> ready;
+        bool peerClosed = false;
+    };
+
+    // Worker pool fed by the event loop; completions are handed back through a pipe
+    class WorkerPool
+    {
+    public:
+        WorkerPool(NetworkRegistry &registry, unsigned count, int wakeFd) : registry(registry), wakeFd(wakeFd), stopping(false)
+        {
+            for (unsigned i = 0; i < count; ++i)
+            {
+                threads.emplace_back(&WorkerPool::work, this);
+            }
+        }
+
+        ~WorkerPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            available.notify_all();
+            for (std::thread &t : threads)
+            {
+                t.join();
+            }
+        }
+
+        void submit(Job job)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                jobs.push_back(std::move(job));
+            }
+            available.notify_one();
+        }
+
+        std::vector<Job> take_done()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::vector<Job> result;
+            result.swap(done);
+            return result;
+        }
+
+    private:
+        void work()
+        {
+            while (true)
+            {
+                Job job;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    while (!stopping && jobs.empty())
+                    {
+                        available.wait(lock);
+                    }
+                    if (stopping)
+                    {
+                        return;
+                    }
+                    job = std::move(jobs.front());
+                    jobs.pop_front();
+                }
+                job.request = answer_query(registry, job.request);
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    done.push_back(std::move(job));
+                }
+                char byte = 0;
+                ssize_t ignored = write(wakeFd, &byte, 1);
+                (void)ignored;
+            }
+        }
+
+        NetworkRegistry &registry;
+        int wakeFd;
+        bool stopping;
+        std::mutex mutex;
+        std::condition_variable available;
+        std::deque<Job> jobs;
+        std::vector<Job> done;
+        std::vector<std::thread> threads;
+    };
+
+    void set_nonblocking(int fd)
+    {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+
+    sockaddr_un socket_address(const std::string &path)
+    {
+        sockaddr_un address;
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path))
+        {
+            throw std::runtime_error("socket path too long: " + path);
+        }
+        std::strcpy(address.sun_path, path.c_str());
+        return address;
+    }
+}
+
+QueryServer::QueryServer(NetworkRegistry &registry, const std::string &socket_path, unsigned workers)
+    : registry(registry), socket_path(socket_path), workers(workers == 0 ? default_thread_count() : workers),
+      listen_fd(-1), stopping(false)
+{
+    if (pipe(wake_pipe) != 0)
+    {
+        throw std::runtime_error("pipe: " + std::string(std::strerror(errno)));
+    }
+    set_nonblocking(wake_pipe[0]);
+    set_nonblocking(wake_pipe[1]);
+}
+
+QueryServer::~QueryServer()
+{
+    if (listen_fd >= 0)
+    {
+        close(listen_fd);
+        unlink(socket_path.c_str());
+    }
+    close(wake_pipe[0]);
+    close(wake_pipe[1]);
+}
+
+void QueryServer::listen()
+{
+    sockaddr_un address = socket_address(socket_path);
+    listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0)
+    {
+        throw std::runtime_error("socket: " + std::string(std::strerror(errno)));
+    }
+    unlink(socket_path.c_str());
+    if (bind(listen_fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || ::listen(listen_fd, 64) != 0)
+    {
+        std::string error = std::strerror(errno);
+        close(listen_fd);
+        listen_fd = -1;
+        throw std::runtime_error("cannot listen on " + socket_path + ": " + error);
+    }
+    set_nonblocking(listen_fd);
+}
+
+void QueryServer::stop()
+{
+    stopping = true;
+    char byte = 0;
+    ssize_t ignored = write(wake_pipe[1], &byte, 1);
+    (void)ignored;
+}
+
+void QueryServer::run()
+{
+    if (listen_fd < 0)
+    {
+        listen();
+    }
+    WorkerPool pool(registry, workers, wake_pipe[1]);
+    std::map<uint64_t, Connection> connections;
+    uint64_t nextConnection = 0;
+    char chunk[4096];
+
+    while (!stopping)
+    {
+        std::vector<pollfd> fds = {{wake_pipe[0], POLLIN, 0}, {listen_fd, POLLIN, 0}};
+        std::vector<uint64_t> polled;
+        for (auto &entry : connections)
+        {
+            // a closed peer with nothing to send waits for its jobs off the poll set:
+            // poll would report its hangup at once, every time
+            if (entry.second.peerClosed && entry.second.out.empty())
+            {
+                continue;
+            }
+            short events = entry.second.peerClosed ? 0 : POLLIN;
+            if (!entry.second.out.empty())
+            {
+                events |= POLLOUT;
+            }
+            fds.push_back({entry.second.fd, events, 0});
+            polled.push_back(entry.first);
+        }
+        if (poll(fds.data(), fds.size(), -1) < 0 && errno != EINTR)
+        {
+            break;
+        }
+
+        if (fds[0].revents & POLLIN)
+        {
+            while (read(wake_pipe[0], chunk, sizeof(chunk)) > 0)
+            {
+            }
+            for (Job &job : pool.take_done())
+            {
+                auto it = connections.find(job.connection);
+                if (it == connections.end())
+                {
+                    continue;
+                }
+                Connection &connection = it->second;
+                connection.ready[job.sequence] = std::move(job.request);
+                for (auto next = connection.ready.find(connection.nextToSend); next != connection.ready.end();
+                     next = connection.ready.find(connection.nextToSend))
+                {
+                    connection.out += next->second + "\n";
+                    connection.ready.erase(next);
+                    connection.nextToSend++;
+                }
+            }
+        }
+
+        if (fds[1].revents & POLLIN)
+        {
+            for (int fd = accept(listen_fd, nullptr, nullptr); fd >= 0; fd = accept(listen_fd, nullptr, nullptr))
+            {
+                set_nonblocking(fd);
+                connections[nextConnection++].fd = fd;
+            }
+        }
+
+        for (size_t i = 0; i < polled.size(); ++i)
+        {
+            Connection &connection = connections[polled[i]];
+            short revents = fds[i + 2].revents;
+            if (revents & POLLIN)
+            {
+                ssize_t n;
+                while ((n = read(connection.fd, chunk, sizeof(chunk))) > 0)
+                {
+                    connection.in.append(chunk, n);
+                }
+                if (n == 0)
+                {
+                    connection.peerClosed = true;
+                }
+                for (size_t end = connection.in.find('\n'); end != std::string::npos; end = connection.in.find('\n'))
+                {
+                    pool.submit({polled[i], connection.nextSequence++, connection.in.substr(0, end)});
+                    connection.in.erase(0, end + 1);
+                }
+            }
+            if (revents & (POLLHUP | POLLERR))
+            {
+                // nobody left to read the answers: drop them, pending ones included
+                connection.out.clear();
+                connection.ready.clear();
+                connection.peerClosed = true;
+                connection.nextToSend = connection.nextSequence;
+            }
+            if (!connection.out.empty())
+            {
+                ssize_t n = send(connection.fd, connection.out.data(), connection.out.size(), MSG_NOSIGNAL);
+                if (n > 0)
+                {
+                    connection.out.erase(0, n);
+                }
+                else if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+                {
+                    connection.out.clear();
+                    connection.peerClosed = true;
+                    connection.nextToSend = connection.nextSequence;
+                }
+            }
+        }
+
+        // a connection closed by its peer is kept until every pending answer has been sent
+        for (auto it = connections.begin(); it != connections.end();)
+        {
+            Connection &connection = it->second;
+            if (connection.peerClosed && connection.out.empty() && connection.nextToSend == connection.nextSequence)
+            {
+                close(connection.fd);
+                it = connections.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    for (auto &entry : connections)
+    {
+        close(entry.second.fd);
+    }
+}
+
+//==================================================================
+//                             CLIENT
+//==================================================================
+
+QueryClient::QueryClient(const std::string &socket_path)
+{
+    sockaddr_un address = socket_address(socket_path);
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0)
+    {
+        std::string error = std::strerror(errno);
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        throw std::runtime_error("cannot connect to " + socket_path + ": " + error);
+    }
+}
+
+QueryClient::~QueryClient()
+{
+    close(fd);
+}
+
+void QueryClient::send(const std::string &request)
+{
+    std::string line = request + "\n";
+    size_t sent = 0;
+    while (sent < line.size())
+    {
+        ssize_t n = ::send(fd, line.data() + sent, line.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0)
+        {
+            throw std::runtime_error("connection to server lost");
+        }
+        sent += n;
+    }
+}
+
+std::string QueryClient::receive()
+{
+    char chunk[4096];
+    size_t end;
+    while ((end = buffer.find('\n')) == std::string::npos)
+    {
+        ssize_t n = read(fd, chunk, sizeof(chunk));
+        if (n <= 0)
+        {
+            throw std::runtime_error("connection to server lost");
+        }
+        buffer.append(chunk, n);
+    }
+    std::string line = buffer.substr(0, end);
+    buffer.erase(0, end + 1);
+    return line;
+}
+
+std::string QueryClient::query(const std::string &request)
+{
+    send(request);
+    return receive();
+}
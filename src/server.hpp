@@ -0,0 +1,116 @@
+/*
+ * Mini-projet 3 : query daemon
+ */
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "pathsearch.hpp"
+#include "components.hpp"
+
+// largest dt a fastest request may ask for, larger steps do not converge
+const double MAX_REQUEST_DT = 0.1;
+// Euler steps a fastest request may spend on one path, then on the whole query
+const size_t MAX_REQUEST_PATH_ITERATIONS = 1000000;
+const uint64_t MAX_REQUEST_ITERATIONS = 50000000;
+
+/*-----------------  TYPES AND DATA STRUCTURES    ------------*/
+
+// A network kept in memory together with everything derived from it
+struct LoadedNetwork
+{
+    std::string name;
+    std::string network_file;
+    std::string concentrations_file;
+    Network network;
+    IndexedGraph graph;
+    Concentrations concentrations;
+    std::map<CompoundName, CompoundID> ids;
+};
+
+/*!
+ * Named networks shared by the server's workers. Queries hold a shared_ptr
+ * to the version they started with, so reload() swaps in a new version
+ * without disturbing queries in flight.
+ */
+class NetworkRegistry
+{
+public:
+    // file names are used as given (not prefixed like read_network); throws std::runtime_error
+    void load(const std::string &name, const std::string &network_file, const std::string &concentrations_file);
+    void reload(const std::string &name);
+    // null if no network has that name
+    std::shared_ptr<const LoadedNetwork> get(const std::string &name) const;
+    std::vector<std::string> names() const;
+
+private:
+    mutable std::mutex mutex;
+    std::map<std::string, std::shared_ptr<const LoadedNetwork>> networks;
+};
+
+/*!
+ * @brief answers one request line of the daemon protocol
+ * Requests (compounds are given by name):
+ *   ping | list
+ *   distance <net> <src> <dest>   -> OK <reactions>, -1 if unreachable
+ *   shortest <net> <src> <dest>   -> OK <r1> <r2> ...
+ *   all <net> <src> <dest>        -> OK <count> ; <r1> <r2> ... ; ...
+ *   fastest <net> <src> <dest> [dt] -> OK <rate> ; <r1> <r2> ...
+ *     dt in (0, MAX_REQUEST_DT], or 0 / "auto" for AUTO_DT (default 1e-3);
+ *     ERR if a steady state is not reached within the MAX_REQUEST_* steps
+ *   load <net> <network file> <concentrations file> | reload <net>
+ * @return a single line without '\n', "OK ..." or "ERR <message>"
+ */
+std::string answer_query(NetworkRegistry &registry, const std::string &request);
+
+/*!
+ * Unix domain socket server. One event loop thread multiplexes every
+ * connection with poll() and a pool of workers answers the requests.
+ * A client may pipeline requests: they are processed concurrently and
+ * the responses come back in request order.
+ */
+class QueryServer
+{
+public:
+    // workers == 0 means one per hardware thread
+    QueryServer(NetworkRegistry &registry, const std::string &socket_path, unsigned workers = 0);
+    ~QueryServer();
+
+    // binds the socket, throws std::runtime_error on failure
+    void listen();
+    // serves until stop(), calls listen() first if needed
+    void run();
+    // may be called from any thread
+    void stop();
+
+private:
+    NetworkRegistry &registry;
+    std::string socket_path;
+    unsigned workers;
+    int listen_fd;
+    int wake_pipe[2];
+    std::atomic<bool> stopping;
+};
+
+// Blocking client for the daemon protocol
+class QueryClient
+{
+public:
+    // throws std::runtime_error if the server cannot be reached
+    explicit QueryClient(const std::string &socket_path);
+    ~QueryClient();
+
+    // sends a request without waiting for its answer (pipelining)
+    void send(const std::string &request);
+    // next response, in the order the requests were sent
+    std::string receive();
+    std::string query(const std::string &request);
+
+private:
+    int fd;
+    std::string buffer;
+};
@@ -0,0 +1,849 @@
+/*
+ * Mini-projet 3 : sharded query execution
+ */
+#include "shard.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "kinetics.hpp"
+
+namespace
+{
+    enum MessageType
+    {
+        MSG_READY,
+        MSG_STOP,
+        MSG_BFS_START, // start
+        MSG_EXPAND,    // (frontier position, compound)*
+        MSG_CANDIDATES, // for each shard: count, then (position, parent, compound)*, the sender's
+                        // own candidates are only counted
+        MSG_DISCOVER,  // level, (position, parent, compound)*
+        MSG_FRONTIER,  // (position of the first parent, compound)* in frontier order
+        MSG_GATHER,
+        MSG_BFS_RESULT, // (compound, distance, parent count, parents...)*
+        MSG_NODE_QUERY, // compounds
+        MSG_NODES,      // (compound, distance, parent count, (parent, reaction, first, second)*)*
+                        // reals: (concentration, (V_plus, V_minus, K_S, K_P)*)*
+        MSG_EVALUATE,   // path count, (index, length, (reaction, first, second)*)*, compound count, compounds
+                        // reals: dt, (V_plus, V_minus, K_S, K_P)*, concentrations
+        MSG_RATES       // (index, compound count, compounds)*, reals: (rate, steady state)*
+    };
+
+    //==================================================================
+    //                          TRANSPORTS
+    //==================================================================
+
+    struct MessageQueue
+    {
+        std::mutex mutex;
+        std::condition_variable ready;
+        std::deque<Message> messages;
+        bool closed = false;
+    };
+
+    class InProcessChannel : public Channel
+    {
+    public:
+        InProcessChannel(std::shared_ptr<MessageQueue> in, std::shared_ptr<MessageQueue> out) : in(in), out(out) {}
+
+        ~InProcessChannel()
+        {
+            std::lock_guard<std::mutex> lock(out->mutex);
+            out->closed = true;
+            out->ready.notify_all();
+        }
+
+        void send(const Message &message) override
+        {
+            std::lock_guard<std::mutex> lock(out->mutex);
+            out->messages.push_back(message);
+            out->ready.notify_all();
+        }
+
+        Message receive() override
+        {
+            std::unique_lock<std::mutex> lock(in->mutex);
+            while (in->messages.empty() && !in->closed)
+            {
+                in->ready.wait(lock);
+            }
+            if (in->messages.empty())
+            {
+                throw std::runtime_error("channel closed");
+            }
+            Message message = std::move(in->messages.front());
+            in->messages.pop_front();
+            return message;
+        }
+
+    private:
+        std::shared_ptr<MessageQueue> in, out;
+    };
+
+    class SocketChannel : public Channel
+    {
+    public:
+        explicit SocketChannel(int fd) : fd(fd) {}
+
+        ~SocketChannel()
+        {
+            close(fd);
+        }
+
+        void send(const Message &message) override
+        {
+            uint64_t header[3] = {message.type, message.ints.size(), message.reals.size()};
+            write_all(header, sizeof(header));
+            write_all(message.ints.data(), message.ints.size() * sizeof(int64_t));
+            write_all(message.reals.data(), message.reals.size() * sizeof(double));
+        }
+
+        Message receive() override
+        {
+            uint64_t header[3];
+            read_all(header, sizeof(header));
+            Message message;
+            message.type = (uint32_t)header[0];
+            message.ints.resize(header[1]);
+            message.reals.resize(header[2]);
+            read_all(message.ints.data(), message.ints.size() * sizeof(int64_t));
+            read_all(message.reals.data(), message.reals.size() * sizeof(double));
+            return message;
+        }
+
+    private:
+        void write_all(const void *data, size_t size)
+        {
+            const char *bytes = static_cast<const char *>(data);
+            while (size > 0)
+            {
+                // MSG_NOSIGNAL: a dead peer is reported as an error, not a SIGPIPE
+                ssize_t written = ::send(fd, bytes, size, MSG_NOSIGNAL);
+                if (written < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if (written <= 0)
+                {
+                    throw std::runtime_error("channel closed");
+                }
+                bytes += written;
+                size -= written;
+            }
+        }
+
+        void read_all(void *data, size_t size)
+        {
+            char *bytes = static_cast<char *>(data);
+            while (size > 0)
+            {
+                ssize_t got = ::recv(fd, bytes, size, 0);
+                if (got < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if (got <= 0)
+                {
+                    throw std::runtime_error("channel closed");
+                }
+                bytes += got;
+                size -= got;
+            }
+        }
+
+        int fd;
+    };
+
+    //==================================================================
+    //                          SHARD SIDE
+    //==================================================================
+
+    // position of an owned compound in shard.compounds, -1 if another shard owns it
+    int local_index(const Shard &shard, CompoundID compound)
+    {
+        std::vector<CompoundID>::const_iterator it = std::lower_bound(shard.compounds.begin(), shard.compounds.end(), compound);
+        return it != shard.compounds.end() && *it == compound ? (int)(it - shard.compounds.begin()) : -1;
+    }
+
+    struct Candidate
+    {
+        int64_t position; // in the frontier, of parent
+        int64_t parent;
+        int64_t compound;
+    };
+
+    bool operator<(const Candidate &a, const Candidate &b)
+    {
+        return a.position != b.position ? a.position < b.position : a.compound < b.compound;
+    }
+
+    // steady state of one path, in a network made of its reactions only
+    void evaluate_path(const std::vector<Reaction> &reactions, const std::map<CompoundID, double> &concentrations, double dt,
+                       Message &reply)
+    {
+        Network local;
+        std::map<CompoundID, CompoundID> toLocal;
+        std::vector<CompoundID> toGlobal;
+        auto localize = [&](CompoundID compound)
+        {
+            std::pair<std::map<CompoundID, CompoundID>::iterator, bool> inserted = toLocal.insert({compound, (CompoundID)toGlobal.size()});
+            if (inserted.second)
+            {
+                toGlobal.push_back(compound);
+            }
+            return inserted.first->second;
+        };
+        Path path;
+        for (const Reaction &reaction : reactions)
+        {
+            Reaction copy = reaction;
+            copy.compounds = {localize(reaction.compounds.first), localize(reaction.compounds.second)};
+            path.push_back((ReactionID)local.reactions.size());
+            local.reactions.push_back(copy);
+        }
+        Concentrations initial;
+        for (size_t c = 0; c < toGlobal.size(); ++c)
+        {
+            initial[(CompoundID)c] = concentrations.find(toGlobal[c])->second;
+        }
+        CompiledPath compiled = compile_path(local, path);
+        PathState state = initial_path_state(compiled, initial);
+        solve_ss_state(compiled, state, dt);
+        reply.ints.push_back((int64_t)compiled.compounds.size());
+        reply.reals.push_back(compute_path_rate(compiled, state));
+        for (size_t i = 0; i < compiled.compounds.size(); ++i)
+        {
+            reply.ints.push_back(toGlobal[compiled.compounds[i]]);
+            reply.reals.push_back(state[i]);
+        }
+    }
+
+    //==================================================================
+    //                       COORDINATOR SIDE
+    //==================================================================
+
+    // level-synchronous BFS from start, stopping after the level that reaches stop (-1: never)
+    void run_levels(ShardCluster &cluster, CompoundID start, CompoundID stop)
+    {
+        const std::vector<unsigned> &owner = cluster.partition().owner;
+        for (unsigned s = 0; s < cluster.size(); ++s)
+        {
+            cluster.send(s, {MSG_BFS_START, {start}, {}});
+        }
+        std::vector<CompoundID> frontier = {start};
+        bool reached = start == stop;
+        for (int64_t level = 0; !frontier.empty() && !reached; ++level)
+        {
+            std::vector<Message> expand(cluster.size(), Message{MSG_EXPAND, {}, {}});
+            for (size_t position = 0; position < frontier.size(); ++position)
+            {
+                Message &message = expand[owner[frontier[position]]];
+                message.ints.push_back((int64_t)position);
+                message.ints.push_back(frontier[position]);
+            }
+            std::vector<Message> discover(cluster.size(), Message{MSG_DISCOVER, {level}, {}});
+            std::vector<bool> retained(cluster.size(), false);
+            for (unsigned s = 0; s < cluster.size(); ++s)
+            {
+                if (!expand[s].ints.empty())
+                {
+                    cluster.send(s, expand[s]);
+                }
+            }
+            for (unsigned s = 0; s < cluster.size(); ++s)
+            {
+                if (expand[s].ints.empty())
+                {
+                    continue;
+                }
+                Message candidates = cluster.receive(s);
+                size_t i = 0;
+                for (unsigned t = 0; t < cluster.size(); ++t)
+                {
+                    if (i >= candidates.ints.size())
+                    {
+                        throw std::runtime_error("short candidates message from shard " + std::to_string(s));
+                    }
+                    size_t count = (size_t)candidates.ints[i++];
+                    if (t == s)
+                    {
+                        retained[s] = count > 0;
+                        continue;
+                    }
+                    discover[t].ints.insert(discover[t].ints.end(), candidates.ints.begin() + i, candidates.ints.begin() + i + 3 * count);
+                    i += 3 * count;
+                }
+            }
+
+            for (unsigned t = 0; t < cluster.size(); ++t)
+            {
+                if (discover[t].ints.size() > 1 || retained[t])
+                {
+                    cluster.send(t, discover[t]);
+                }
+            }
+            std::vector<std::pair<int64_t, CompoundID>> next;
+            for (unsigned t = 0; t < cluster.size(); ++t)
+            {
+                if (discover[t].ints.size() <= 1 && !retained[t])
+                {
+                    continue;
+                }
+                Message found = cluster.receive(t);
+                for (size_t i = 0; i < found.ints.size(); i += 2)
+                {
+                    next.push_back({found.ints[i], (CompoundID)found.ints[i + 1]});
+                    reached = reached || found.ints[i + 1] == stop;
+                }
+            }
+            // the order in which the reference BFS queues them
+            std::sort(next.begin(), next.end());
+            frontier.clear();
+            for (const std::pair<int64_t, CompoundID> &entry : next)
+            {
+                frontier.push_back(entry.second);
+            }
+        }
+    }
+
+    struct NodeInfo
+    {
+        int distance;
+        double concentration;
+        std::vector<std::pair<CompoundID, ReactionID>> parents;
+        std::vector<Reaction> reactions; // of the parents
+    };
+
+    // the part of the BFS below destID, walked back one level per round
+    std::map<CompoundID, NodeInfo> collect_parents(ShardCluster &cluster, CompoundID destID)
+    {
+        const std::vector<unsigned> &owner = cluster.partition().owner;
+        std::map<CompoundID, NodeInfo> nodes;
+        std::vector<CompoundID> pending = {destID};
+        while (!pending.empty())
+        {
+            std::vector<Message> queries(cluster.size(), Message{MSG_NODE_QUERY, {}, {}});
+            for (CompoundID compound : pending)
+            {
+                queries[owner[compound]].ints.push_back(compound);
+            }
+            for (unsigned s = 0; s < cluster.size(); ++s)
+            {
+                if (!queries[s].ints.empty())
+                {
+                    cluster.send(s, queries[s]);
+                }
+            }
+            std::vector<CompoundID> next;
+            for (unsigned s = 0; s < cluster.size(); ++s)
+            {
+                if (queries[s].ints.empty())
+                {
+                    continue;
+                }
+                Message reply = cluster.receive(s);
+                size_t i = 0, r = 0;
+                while (i < reply.ints.size())
+                {
+                    CompoundID compound = (CompoundID)reply.ints[i++];
+                    NodeInfo &node = nodes[compound];
+                    node.distance = (int)reply.ints[i++];
+                    size_t count = (size_t)reply.ints[i++];
+                    node.concentration = reply.reals[r++];
+                    for (size_t p = 0; p < count; ++p, i += 4, r += 4)
+                    {
+                        CompoundID parent = (CompoundID)reply.ints[i];
+                        node.parents.push_back({parent, (ReactionID)reply.ints[i + 1]});
+                        node.reactions.push_back({{(CompoundID)reply.ints[i + 2], (CompoundID)reply.ints[i + 3]},
+                                                  reply.reals[r], reply.reals[r + 1], reply.reals[r + 2], reply.reals[r + 3]});
+                        if (parent != -1 && !nodes.count(parent))
+                        {
+                            next.push_back(parent);
+                        }
+                    }
+                }
+            }
+            std::sort(next.begin(), next.end());
+            next.erase(std::unique(next.begin(), next.end()), next.end());
+            pending.clear();
+            for (CompoundID compound : next)
+            {
+                if (!nodes.count(compound))
+                {
+                    pending.push_back(compound);
+                }
+            }
+        }
+        return nodes;
+    }
+
+    // same walk as recursive_find_paths, on the collected parents
+    void walk_back(const std::map<CompoundID, NodeInfo> &nodes, CompoundID src, CompoundID current, Path &path, Paths &paths)
+    {
+        if (current == src)
+        {
+            paths.push_back(path);
+            return;
+        }
+        for (const std::pair<CompoundID, ReactionID> &parent : nodes.find(current)->second.parents)
+        {
+            path.push_back(parent.second);
+            walk_back(nodes, src, parent.first, path, paths);
+            path.pop_back();
+        }
+    }
+
+    Paths shortest_paths(const std::map<CompoundID, NodeInfo> &nodes, CompoundID srcID, CompoundID destID)
+    {
+        Paths paths;
+        Path path;
+        walk_back(nodes, srcID, destID, path, paths);
+        for (Path &found : paths)
+        {
+            std::reverse(found.begin(), found.end());
+        }
+        return paths;
+    }
+}
+
+//==================================================================
+//                          CHANNELS
+//==================================================================
+
+ChannelPair make_in_process_channels()
+{
+    std::shared_ptr<MessageQueue> forward = std::make_shared<MessageQueue>();
+    std::shared_ptr<MessageQueue> backward = std::make_shared<MessageQueue>();
+    return ChannelPair(std::unique_ptr<Channel>(new InProcessChannel(backward, forward)),
+                       std::unique_ptr<Channel>(new InProcessChannel(forward, backward)));
+}
+
+ChannelPair make_socket_channels()
+{
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+    {
+        throw std::runtime_error("cannot create a socket pair");
+    }
+    return ChannelPair(std::unique_ptr<Channel>(new SocketChannel(fds[0])), std::unique_ptr<Channel>(new SocketChannel(fds[1])));
+}
+
+//==================================================================
+//                              SHARDS
+//==================================================================
+
+Shard build_shard(const Network &network, const Concentrations &initial_concentrations, const Partition &partition, unsigned id)
+{
+    Shard shard;
+    shard.id = id;
+    shard.shards = partition.parts;
+    shard.owner = partition.owner;
+    for (CompoundID compound = 0; compound < (CompoundID)partition.owner.size(); ++compound)
+    {
+        if (partition.owner[compound] == id)
+        {
+            shard.compounds.push_back(compound);
+            Concentrations::const_iterator it = initial_concentrations.find(compound);
+            shard.concentrations.push_back(it == initial_concentrations.end() ? 0.0 : it->second);
+        }
+    }
+    shard.adjacency.resize(shard.compounds.size());
+    for (ReactionID r = 0; r < (ReactionID)network.reactions.size(); ++r)
+    {
+        const Reaction &reaction = network.reactions[r];
+        int first = local_index(shard, reaction.compounds.first);
+        int second = local_index(shard, reaction.compounds.second);
+        // same rule as build_adjacency_graph: the first reaction between two compounds wins
+        if (first >= 0)
+        {
+            shard.adjacency[first].insert({reaction.compounds.second, r});
+        }
+        if (second >= 0)
+        {
+            shard.adjacency[second].insert({reaction.compounds.first, r});
+        }
+        if (first >= 0 || second >= 0)
+        {
+            shard.reactions[r] = reaction;
+        }
+    }
+    return shard;
+}
+
+void serve_shard(const Shard &shard, Channel &channel)
+{
+    // BFS state of the owned compounds
+    std::vector<int> distances(shard.compounds.size(), INT_MAX);
+    std::vector<std::vector<CompoundID>> parents(shard.compounds.size());
+    std::vector<Candidate> retained;
+
+    channel.send({MSG_READY, {}, {}});
+    while (true)
+    {
+        Message message = channel.receive();
+        Message reply = {MSG_READY, {}, {}};
+        switch (message.type)
+        {
+        case MSG_STOP:
+            return;
+        case MSG_BFS_START:
+        {
+            std::fill(distances.begin(), distances.end(), INT_MAX);
+            for (std::vector<CompoundID> &list : parents)
+            {
+                list.clear();
+            }
+            int start = local_index(shard, (CompoundID)message.ints[0]);
+            if (start >= 0)
+            {
+                distances[start] = 0;
+                parents[start] = {-1};
+            }
+            continue; // no reply
+        }
+        case MSG_EXPAND:
+        {
+            // candidates owned here wait for MSG_DISCOVER instead of a round trip
+            std::vector<std::vector<int64_t>> outgoing(shard.shards);
+            retained.clear();
+            for (size_t i = 0; i < message.ints.size(); i += 2)
+            {
+                CompoundID compound = (CompoundID)message.ints[i + 1];
+                for (const std::pair<const CompoundID, ReactionID> &pair : shard.adjacency[local_index(shard, compound)])
+                {
+                    if (shard.owner[pair.first] == shard.id)
+                    {
+                        retained.push_back({message.ints[i], compound, pair.first});
+                        continue;
+                    }
+                    std::vector<int64_t> &to = outgoing[shard.owner[pair.first]];
+                    to.push_back(message.ints[i]);
+                    to.push_back(compound);
+                    to.push_back(pair.first);
+                }
+            }
+            reply.type = MSG_CANDIDATES;
+            for (unsigned t = 0; t < shard.shards; ++t)
+            {
+                reply.ints.push_back(t == shard.id ? (int64_t)retained.size() : (int64_t)outgoing[t].size() / 3);
+                reply.ints.insert(reply.ints.end(), outgoing[t].begin(), outgoing[t].end());
+            }
+            break;
+        }
+        case MSG_DISCOVER:
+        {
+            int level = (int)message.ints[0];
+            std::vector<Candidate> candidates;
+            candidates.swap(retained);
+            for (size_t i = 1; i < message.ints.size(); i += 3)
+            {
+                candidates.push_back({message.ints[i], message.ints[i + 1], message.ints[i + 2]});
+            }
+            // frontier order: the parents of a compound in the order the reference BFS meets them
+            std::sort(candidates.begin(), candidates.end());
+            reply.type = MSG_FRONTIER;
+            for (const Candidate &candidate : candidates)
+            {
+                int local = local_index(shard, (CompoundID)candidate.compound);
+                if (distances[local] == INT_MAX)
+                {
+                    distances[local] = level + 1;
+                    parents[local] = {(CompoundID)candidate.parent};
+                    reply.ints.push_back(candidate.position);
+                    reply.ints.push_back(candidate.compound);
+                }
+                else if (distances[local] == level + 1)
+                {
+                    parents[local].push_back((CompoundID)candidate.parent);
+                }
+            }
+            break;
+        }
+        case MSG_GATHER:
+            reply.type = MSG_BFS_RESULT;
+            for (size_t i = 0; i < shard.compounds.size(); ++i)
+            {
+                reply.ints.push_back(shard.compounds[i]);
+                reply.ints.push_back(distances[i]);
+                reply.ints.push_back((int64_t)parents[i].size());
+                reply.ints.insert(reply.ints.end(), parents[i].begin(), parents[i].end());
+            }
+            break;
+        case MSG_NODE_QUERY:
+            reply.type = MSG_NODES;
+            for (int64_t value : message.ints)
+            {
+                CompoundID compound = (CompoundID)value;
+                int local = local_index(shard, compound);
+                reply.ints.push_back(compound);
+                reply.ints.push_back(distances[local]);
+                reply.ints.push_back((int64_t)parents[local].size());
+                reply.reals.push_back(shard.concentrations[local]);
+                for (CompoundID parent : parents[local])
+                {
+                    std::map<CompoundID, ReactionID>::const_iterator edge = shard.adjacency[local].find(parent);
+                    ReactionID reaction = edge == shard.adjacency[local].end() ? -1 : edge->second;
+                    Reaction parameters = reaction == -1 ? Reaction{{-1, -1}, 0, 0, 0, 0} : shard.reactions.find(reaction)->second;
+                    reply.ints.insert(reply.ints.end(), {parent, reaction, parameters.compounds.first, parameters.compounds.second});
+                    reply.reals.insert(reply.reals.end(), {parameters.V_plus, parameters.V_minus, parameters.K_S, parameters.K_P});
+                }
+            }
+            break;
+        case MSG_EVALUATE:
+        {
+            double dt = message.reals[0];
+            size_t i = 0, r = 1;
+            size_t count = (size_t)message.ints[i++];
+            std::vector<std::pair<int64_t, std::vector<Reaction>>> paths;
+            for (size_t p = 0; p < count; ++p)
+            {
+                int64_t index = message.ints[i++];
+                size_t length = (size_t)message.ints[i++];
+                std::vector<Reaction> reactions;
+                for (size_t k = 0; k < length; ++k, i += 3, r += 4)
+                {
+                    reactions.push_back({{(CompoundID)message.ints[i + 1], (CompoundID)message.ints[i + 2]},
+                                         message.reals[r], message.reals[r + 1], message.reals[r + 2], message.reals[r + 3]});
+                }
+                paths.push_back({index, reactions});
+            }
+            std::map<CompoundID, double> concentrations;
+            size_t compounds = (size_t)message.ints[i++];
+            for (size_t c = 0; c < compounds; ++c)
+            {
+                concentrations[(CompoundID)message.ints[i++]] = message.reals[r++];
+            }
+            reply.type = MSG_RATES;
+            for (const std::pair<int64_t, std::vector<Reaction>> &path : paths)
+            {
+                reply.ints.push_back(path.first);
+                evaluate_path(path.second, concentrations, dt, reply);
+            }
+            break;
+        }
+        default:
+            throw std::runtime_error("unexpected message " + std::to_string(message.type));
+        }
+        channel.send(reply);
+    }
+}
+
+//==================================================================
+//                          COORDINATOR
+//==================================================================
+
+ShardCluster::ShardCluster(const Network &network, const Concentrations &initial_concentrations, const Partition &partition,
+                           TransportKind transport)
+    : parts(partition), traffic({0, 0})
+{
+    for (unsigned id = 0; id < partition.parts; ++id)
+    {
+        if (transport == TRANSPORT_IN_PROCESS)
+        {
+            ChannelPair ends = make_in_process_channels();
+            std::shared_ptr<Channel> shardEnd(std::move(ends.second));
+            auto run = [&network, &initial_concentrations, &partition, id, shardEnd]()
+            {
+                // the shard is built before MSG_READY, while the caller still holds the network
+                serve_shard(build_shard(network, initial_concentrations, partition, id), *shardEnd);
+            };
+            threads.emplace_back(run);
+            channels.push_back(std::move(ends.first));
+        }
+        else
+        {
+            ChannelPair ends = make_socket_channels();
+            pid_t pid = fork();
+            if (pid < 0)
+            {
+                throw std::runtime_error("cannot fork shard " + std::to_string(id));
+            }
+            if (pid == 0)
+            {
+                // the child keeps only its own end
+                channels.clear();
+                ends.first.reset();
+                int status = 0;
+                try
+                {
+                    serve_shard(build_shard(network, initial_concentrations, partition, id), *ends.second);
+                }
+                catch (const std::exception &)
+                {
+                    status = 1;
+                }
+                _exit(status);
+            }
+            processes.push_back(pid);
+            channels.push_back(std::move(ends.first));
+        }
+    }
+    for (unsigned id = 0; id < size(); ++id)
+    {
+        receive(id); // MSG_READY
+    }
+}
+
+ShardCluster::~ShardCluster()
+{
+    for (std::unique_ptr<Channel> &channel : channels)
+    {
+        try
+        {
+            channel->send({MSG_STOP, {}, {}});
+        }
+        catch (const std::exception &)
+        {
+            // already gone
+        }
+    }
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+    for (pid_t pid : processes)
+    {
+        int status;
+        waitpid(pid, &status, 0);
+    }
+}
+
+void ShardCluster::send(unsigned shard, const Message &message)
+{
+    traffic.messages++;
+    traffic.values += message.ints.size() + message.reals.size();
+    channels[shard]->send(message);
+}
+
+Message ShardCluster::receive(unsigned shard)
+{
+    Message message = channels[shard]->receive();
+    traffic.messages++;
+    traffic.values += message.ints.size() + message.reals.size();
+    return message;
+}
+
+//==================================================================
+//                       DISTRIBUTED QUERIES
+//==================================================================
+
+BFS distributed_bfs(ShardCluster &cluster, CompoundID start)
+{
+    run_levels(cluster, start, -1);
+    BFS result;
+    result.start = start;
+    result.distances.assign(cluster.partition().owner.size(), INT_MAX);
+    result.parents.resize(cluster.partition().owner.size());
+    for (unsigned s = 0; s < cluster.size(); ++s)
+    {
+        cluster.send(s, {MSG_GATHER, {}, {}});
+    }
+    for (unsigned s = 0; s < cluster.size(); ++s)
+    {
+        Message reply = cluster.receive(s);
+        size_t i = 0;
+        while (i < reply.ints.size())
+        {
+            CompoundID compound = (CompoundID)reply.ints[i++];
+            result.distances[compound] = (int)reply.ints[i++];
+            size_t count = (size_t)reply.ints[i++];
+            result.parents[compound].assign(reply.ints.begin() + i, reply.ints.begin() + i + count);
+            i += count;
+        }
+    }
+    return result;
+}
+
+Paths distributed_shortest_paths(ShardCluster &cluster, CompoundID srcID, CompoundID destID)
+{
+    run_levels(cluster, srcID, destID);
+    return shortest_paths(collect_parents(cluster, destID), srcID, destID);
+}
+
+ShardedFastestPath distributed_fastest_path(ShardCluster &cluster, CompoundID srcID, CompoundID destID, double dt)
+{
+    run_levels(cluster, srcID, destID);
+    std::map<CompoundID, NodeInfo> nodes = collect_parents(cluster, destID);
+    Paths paths = shortest_paths(nodes, srcID, destID);
+    ShardedFastestPath answer = {Path(), 0.0, Concentrations(), paths.size()};
+    if (paths.empty() || paths[0].empty())
+    {
+        return answer;
+    }
+
+    std::map<ReactionID, Reaction> reactions;
+    for (const std::pair<const CompoundID, NodeInfo> &node : nodes)
+    {
+        for (size_t p = 0; p < node.second.parents.size(); ++p)
+        {
+            reactions[node.second.parents[p].second] = node.second.reactions[p];
+        }
+    }
+    // paths are dealt out round robin, every shard gets the concentrations of the whole DAG
+    std::vector<Message> batches(cluster.size(), Message{MSG_EVALUATE, {0}, {dt}});
+    for (size_t index = 0; index < paths.size(); ++index)
+    {
+        Message &batch = batches[index % cluster.size()];
+        batch.ints[0]++;
+        batch.ints.push_back((int64_t)index);
+        batch.ints.push_back((int64_t)paths[index].size());
+        for (ReactionID r : paths[index])
+        {
+            const Reaction &reaction = reactions[r];
+            batch.ints.insert(batch.ints.end(), {r, reaction.compounds.first, reaction.compounds.second});
+            batch.reals.insert(batch.reals.end(), {reaction.V_plus, reaction.V_minus, reaction.K_S, reaction.K_P});
+        }
+    }
+    for (unsigned s = 0; s < cluster.size(); ++s)
+    {
+        batches[s].ints.push_back((int64_t)nodes.size());
+        for (const std::pair<const CompoundID, NodeInfo> &node : nodes)
+        {
+            batches[s].ints.push_back(node.first);
+            batches[s].reals.push_back(node.second.concentration);
+        }
+        if (batches[s].ints[0] > 0)
+        {
+            cluster.send(s, batches[s]);
+        }
+    }
+
+    int64_t best = -1;
+    for (unsigned s = 0; s < cluster.size(); ++s)
+    {
+        if (batches[s].ints[0] == 0)
+        {
+            continue;
+        }
+        Message reply = cluster.receive(s);
+        size_t i = 0, r = 0;
+        while (i < reply.ints.size())
+        {
+            int64_t index = reply.ints[i++];
+            size_t count = (size_t)reply.ints[i++];
+            double rate = reply.reals[r++];
+            if (best == -1 || rate > answer.rate || (rate == answer.rate && index < best))
+            {
+                best = index;
+                answer.rate = rate;
+                answer.ss_concentrations.clear();
+                for (size_t c = 0; c < count; ++c)
+                {
+                    answer.ss_concentrations[(CompoundID)reply.ints[i + c]] = reply.reals[r + c];
+                }
+            }
+            i += count;
+            r += count;
+        }
+    }
+    answer.path = paths[best];
+    return answer;
+}
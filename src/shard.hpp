@@ -0,0 +1,152 @@
+/*
+ * Mini-projet 3 : sharded query execution
+ */
+#pragma once
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <sys/types.h>
+#include "partition.hpp"
+#include "pathsearch.hpp"
+
+/*-----------------  TYPES AND DATA STRUCTURES    ------------*/
+
+// Unit of exchange between the coordinator and a shard
+struct Message
+{
+    uint32_t type;
+    std::vector<int64_t> ints;
+    std::vector<double> reals;
+};
+
+/*!
+ * One end of a two-way link. The coordinator holds one channel per shard and
+ * each shard the other end, so a new transport (shared memory, TCP between
+ * machines) only has to move Messages.
+ */
+class Channel
+{
+public:
+    virtual ~Channel() {}
+    virtual void send(const Message &message) = 0;
+    // blocks until a message arrives, throws std::runtime_error if the other end is gone
+    virtual Message receive() = 0;
+};
+
+typedef std::pair<std::unique_ptr<Channel>, std::unique_ptr<Channel>> ChannelPair;
+
+/*!
+ * @brief two connected ends passing Messages between threads of one process
+ */
+ChannelPair make_in_process_channels();
+
+/*!
+ * @brief two connected ends over a Unix socketpair, usable across fork()
+ * throws std::runtime_error if the sockets cannot be created
+ */
+ChannelPair make_socket_channels();
+
+/*!
+ * The part of a network owned by one shard: the adjacency rows and initial
+ * concentrations of its compounds and the reactions touching them. Only the
+ * compound -> shard table is global.
+ */
+struct Shard
+{
+    unsigned id;
+    unsigned shards; // parts of the partition, some possibly owning no compound
+    std::vector<unsigned> owner; // vector index == CompoundID
+    std::vector<CompoundID> compounds; // owned, sorted
+    // vector index == position in compounds
+    std::vector<std::map<CompoundID, ReactionID>> adjacency;
+    std::vector<double> concentrations;
+    std::map<ReactionID, Reaction> reactions;
+};
+
+/*!
+ * @brief extracts the shard id of a partitioned network
+ */
+Shard build_shard(const Network &network, const Concentrations &initial_concentrations, const Partition &partition, unsigned id);
+
+/*!
+ * @brief answers the coordinator's messages until it sends the stop message
+ */
+void serve_shard(const Shard &shard, Channel &channel);
+
+enum TransportKind
+{
+    TRANSPORT_IN_PROCESS, // one thread per shard
+    TRANSPORT_SOCKET      // one forked process per shard
+};
+
+// Traffic seen by the coordinator
+struct ClusterStats
+{
+    size_t messages;
+    size_t values; // ints and reals, in both directions
+};
+
+/*!
+ * Coordinator side of a set of shards. Each shard builds its own part of the
+ * network, then serves level-synchronous traversals: the coordinator sends
+ * every frontier compound to its owner, routes the discovered neighbours that
+ * another shard owns to it and merges the next frontier in the order of the
+ * reference BFS. The destructor stops the shards.
+ */
+class ShardCluster
+{
+public:
+    ShardCluster(const Network &network, const Concentrations &initial_concentrations, const Partition &partition,
+                 TransportKind transport);
+    ~ShardCluster();
+    ShardCluster(const ShardCluster &) = delete;
+    ShardCluster &operator=(const ShardCluster &) = delete;
+
+    unsigned size() const { return (unsigned)channels.size(); }
+    const Partition &partition() const { return parts; }
+    const ClusterStats &stats() const { return traffic; }
+
+    void send(unsigned shard, const Message &message);
+    Message receive(unsigned shard);
+
+private:
+    Partition parts;
+    std::vector<std::unique_ptr<Channel>> channels;
+    std::vector<std::thread> threads;
+    std::vector<pid_t> processes;
+    ClusterStats traffic;
+};
+
+// Answer of find_fastest_path on a cluster
+struct ShardedFastestPath
+{
+    Path path; // empty if no shortest path exists
+    double rate;
+    Concentrations ss_concentrations; // of the compounds of path
+    size_t paths;                     // shortest paths evaluated
+};
+
+///------------- Distributed queries -------------
+
+/*!
+ * @brief same BFS as bfs(graph, start), gathered from the shards
+ */
+BFS distributed_bfs(ShardCluster &cluster, CompoundID start);
+
+/*!
+ * @brief same paths in the same order as find_all_shortest_paths
+ * The traversal stops at the level of destID, then the paths are walked back
+ * from destID asking each compound's owner for its parents.
+ */
+Paths distributed_shortest_paths(ShardCluster &cluster, CompoundID srcID, CompoundID destID);
+
+/*!
+ * @brief fastest shortest path from srcID to destID
+ * The paths are dealt out to the shards, which solve their steady states
+ * locally; the coordinator keeps the fastest, ties going to the first in
+ * find_all_shortest_paths order like find_fastest_path.
+ */
+ShardedFastestPath distributed_fastest_path(ShardCluster &cluster, CompoundID srcID, CompoundID destID, double dt);
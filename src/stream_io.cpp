@@ -0,0 +1,415 @@
+/*
+ * Mini-projet 3 : streaming output and path set files
+ */
+#include "stream_io.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+
+//==================================================================
+//                          OUTPUT SINK
+//==================================================================
+
+OutputSink::OutputSink(std::ostream &out, size_t capacity)
+    : buffer(std::max<size_t>(capacity, 64)), used(0), stream(&out), text(nullptr) {}
+
+OutputSink::OutputSink(std::string &out, size_t capacity)
+    : buffer(std::max<size_t>(capacity, 64)), used(0), stream(nullptr), text(&out) {}
+
+OutputSink::~OutputSink()
+{
+    flush();
+}
+
+void OutputSink::flush()
+{
+    if (used == 0)
+    {
+        return;
+    }
+    if (stream)
+    {
+        stream->write(buffer.data(), used);
+    }
+    else
+    {
+        text->append(buffer.data(), used);
+    }
+    used = 0;
+}
+
+char *OutputSink::reserve(size_t bytes)
+{
+    if (used + bytes > buffer.size())
+    {
+        flush();
+    }
+    return buffer.data() + used;
+}
+
+void OutputSink::write(const char *data, size_t size)
+{
+    if (size > buffer.size() - used)
+    {
+        flush();
+        if (size > buffer.size())
+        {
+            // too large to be worth copying into the buffer
+            if (stream)
+            {
+                stream->write(data, size);
+            }
+            else
+            {
+                text->append(data, size);
+            }
+            return;
+        }
+    }
+    std::memcpy(buffer.data() + used, data, size);
+    used += size;
+}
+
+OutputSink &OutputSink::operator<<(const char *text)
+{
+    write(text, std::strlen(text));
+    return *this;
+}
+
+void OutputSink::write_int(long long value)
+{
+    char *first = reserve(24);
+    used = std::to_chars(first, buffer.data() + buffer.size(), value).ptr - buffer.data();
+}
+
+void OutputSink::write_double(double value)
+{
+    char *first = reserve(32);
+    used = std::to_chars(first, buffer.data() + buffer.size(), value).ptr - buffer.data();
+}
+
+void OutputSink::write_double(double value, int precision)
+{
+    // %g of a double needs at most precision + 8 characters ("-1.", exponent up to "e-308")
+    char *first = reserve(precision + 32);
+    used = std::to_chars(first, buffer.data() + buffer.size(), value, std::chars_format::general, precision).ptr - buffer.data();
+}
+
+//==================================================================
+//                          TEXT WRITERS
+//==================================================================
+
+namespace
+{
+    template <class Reactions>
+    void write_reactions(OutputSink &out, const Reactions &path)
+    {
+        out << "Reactions: ";
+        for (ReactionID r : path)
+        {
+            out.write_int(r);
+            out.put(' ');
+        }
+        out.put('\n');
+    }
+}
+
+void write_path(OutputSink &out, const Path &path)
+{
+    write_reactions(out, path);
+}
+
+void write_paths(OutputSink &out, const Paths &paths)
+{
+    for (size_t i = 0; i < paths.size(); ++i)
+    {
+        out << "Path Number " << i + 1 << " - ";
+        write_reactions(out, paths[i]);
+    }
+}
+
+void write_paths(OutputSink &out, const PathSet &paths)
+{
+    for (size_t i = 0; i < paths.size(); ++i)
+    {
+        out << "Path Number " << i + 1 << " - ";
+        write_reactions(out, paths[i]);
+    }
+}
+
+void write_bfs(OutputSink &out, const BFS &result)
+{
+    out << "start:" << result.start << '\n';
+    for (size_t i = 0; i < result.parents.size(); ++i)
+    {
+        out << "Node" << i << ": {";
+        for (CompoundID parent : result.parents[i])
+        {
+            out << parent << ' ';
+        }
+        out << "}, distance : " << result.distances[i] << '\n';
+    }
+}
+
+void write_concentrations(OutputSink &out, const Concentrations &concentrations)
+{
+    for (const std::pair<const CompoundID, double> &element : concentrations)
+    {
+        out << element.first << " = " << element.second << '\n';
+    }
+}
+
+void write_ranking(OutputSink &out, const Network &network, const PathRanking &ranking)
+{
+    out << "rank\trate\treactions\tsteady_state\n";
+    for (size_t r = 0; r < ranking.size(); ++r)
+    {
+        const RankedPath &entry = ranking[r];
+        out << r + 1 << '\t' << entry.rate << '\t';
+        for (size_t i = 0; i < entry.path.size(); ++i)
+        {
+            if (i)
+            {
+                out.put(' ');
+            }
+            out.write_int(entry.path[i]);
+        }
+        out.put('\t');
+        bool first = true;
+        for (const std::pair<const CompoundID, double> &pair : entry.ss_concentrations)
+        {
+            if (!first)
+            {
+                out.put(',');
+            }
+            out << network.compounds[pair.first] << '=' << pair.second;
+            first = false;
+        }
+        out.put('\n');
+    }
+}
+
+//==================================================================
+//                          PATH SET FILES
+//==================================================================
+
+namespace
+{
+    const char BINARY_MAGIC[4] = {'P', 'S', 'B', '1'};
+
+    void put_varint(OutputSink &out, uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            out.put((char)(value | 0x80));
+            value >>= 7;
+        }
+        out.put((char)value);
+    }
+
+    // reads straight from the stream buffer, istream::get() costs a sentry per byte
+    uint64_t get_varint(std::streambuf &in)
+    {
+        uint64_t value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7)
+        {
+            int byte = in.sbumpc();
+            if (byte == std::char_traits<char>::eof())
+            {
+                throw std::runtime_error("truncated binary path set");
+            }
+            value |= (uint64_t)(byte & 0x7f) << shift;
+            if (!(byte & 0x80))
+            {
+                return value;
+            }
+        }
+        throw std::runtime_error("malformed varint in binary path set");
+    }
+
+    uint64_t zigzag(int64_t value)
+    {
+        return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+    }
+
+    int64_t unzigzag(uint64_t value)
+    {
+        return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+    }
+
+    // parses the space separated reactions of [first, last) at the end of paths
+    void parse_reactions(const char *first, const char *last, PathSet &paths, std::vector<ReactionID> &reactions)
+    {
+        reactions.clear();
+        while (first != last)
+        {
+            if (*first == ' ' || *first == '\r')
+            {
+                first++;
+                continue;
+            }
+            ReactionID reaction;
+            std::from_chars_result parsed = std::from_chars(first, last, reaction);
+            if (parsed.ec != std::errc())
+            {
+                throw std::runtime_error("expected a reaction ID in path set, got " + std::string(first, last));
+            }
+            reactions.push_back(reaction);
+            first = parsed.ptr;
+        }
+        paths.push_back(reactions.data(), reactions.size());
+    }
+
+    void read_paths_text(std::istream &in, PathSet &paths)
+    {
+        std::string line;
+        std::vector<ReactionID> reactions;
+        const std::string marker = "Reactions:";
+        while (std::getline(in, line))
+        {
+            if (line.empty())
+            {
+                continue;
+            }
+            size_t start = line.find(marker);
+            if (start == std::string::npos)
+            {
+                throw std::runtime_error("expected \"" + marker + "\" in path set line " + line);
+            }
+            start += marker.size();
+            parse_reactions(line.data() + start, line.data() + line.size(), paths, reactions);
+        }
+    }
+
+    void read_paths_csv(std::istream &in, PathSet &paths)
+    {
+        std::string line;
+        if (!std::getline(in, line) || line.compare(0, 14, "path,reactions") != 0)
+        {
+            throw std::runtime_error("missing path,reactions header in CSV path set");
+        }
+        std::vector<ReactionID> reactions;
+        while (std::getline(in, line))
+        {
+            if (line.empty())
+            {
+                continue;
+            }
+            size_t comma = line.find(',');
+            if (comma == std::string::npos)
+            {
+                throw std::runtime_error("expected path,reactions in CSV line " + line);
+            }
+            parse_reactions(line.data() + comma + 1, line.data() + line.size(), paths, reactions);
+        }
+    }
+
+    void read_paths_binary(std::istream &in, PathSet &paths)
+    {
+        char magic[sizeof(BINARY_MAGIC)];
+        if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, BINARY_MAGIC, sizeof(magic)) != 0)
+        {
+            throw std::runtime_error("not a binary path set");
+        }
+        std::streambuf &buffer = *in.rdbuf();
+        uint64_t count = get_varint(buffer);
+        std::vector<ReactionID> previous, current;
+        for (uint64_t p = 0; p < count; ++p)
+        {
+            uint64_t length = get_varint(buffer);
+            uint64_t shared = get_varint(buffer);
+            if (shared > length || shared > previous.size())
+            {
+                throw std::runtime_error("malformed binary path set");
+            }
+            current.assign(previous.begin(), previous.begin() + shared);
+            int64_t reaction = shared ? current.back() : 0;
+            for (uint64_t i = shared; i < length; ++i)
+            {
+                reaction += unzigzag(get_varint(buffer));
+                current.push_back((ReactionID)reaction);
+            }
+            paths.push_back(current.data(), current.size());
+            previous.swap(current);
+        }
+    }
+}
+
+void write_paths_csv(OutputSink &out, const PathSet &paths)
+{
+    out << "path,reactions\n";
+    for (size_t i = 0; i < paths.size(); ++i)
+    {
+        PathView path = paths[i];
+        out.write_int((long long)i + 1);
+        out.put(',');
+        for (size_t k = 0; k < path.length; ++k)
+        {
+            if (k)
+            {
+                out.put(' ');
+            }
+            out.write_int(path[k]);
+        }
+        out.put('\n');
+    }
+}
+
+void write_paths_binary(OutputSink &out, const PathSet &paths)
+{
+    out.write(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    put_varint(out, paths.size());
+    PathView previous = {nullptr, 0};
+    for (size_t i = 0; i < paths.size(); ++i)
+    {
+        PathView path = paths[i];
+        size_t shared = 0;
+        while (shared < path.length && shared < previous.length && path[shared] == previous[shared])
+        {
+            shared++;
+        }
+        put_varint(out, path.length);
+        put_varint(out, shared);
+        int64_t reaction = shared ? path[shared - 1] : 0;
+        for (size_t k = shared; k < path.length; ++k)
+        {
+            put_varint(out, zigzag((int64_t)path[k] - reaction));
+            reaction = path[k];
+        }
+        previous = path;
+    }
+}
+
+void write_paths(OutputSink &out, const PathSet &paths, PathFormat format)
+{
+    switch (format)
+    {
+    case FORMAT_TEXT:
+        write_paths(out, paths);
+        break;
+    case FORMAT_CSV:
+        write_paths_csv(out, paths);
+        break;
+    case FORMAT_BINARY:
+        write_paths_binary(out, paths);
+        break;
+    }
+}
+
+void read_paths(std::istream &in, PathSet &paths, PathFormat format)
+{
+    paths.clear();
+    switch (format)
+    {
+    case FORMAT_TEXT:
+        read_paths_text(in, paths);
+        break;
+    case FORMAT_CSV:
+        read_paths_csv(in, paths);
+        break;
+    case FORMAT_BINARY:
+        read_paths_binary(in, paths);
+        break;
+    }
+}
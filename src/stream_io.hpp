@@ -0,0 +1,135 @@
+/*
+ * Mini-projet 3 : streaming output and path set files
+ */
+#pragma once
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "pathsearch.hpp"
+#include "pathset.hpp"
+#include "topk.hpp"
+
+/*-----------------  TYPES AND DATA STRUCTURES    ------------*/
+
+/*!
+ * Buffered output formatting numbers with std::to_chars. Results are written
+ * piece by piece into a fixed buffer that is handed to the target whenever
+ * it fills up, so dumping millions of paths never holds more than the
+ * buffer in memory. The destructor flushes.
+ */
+class OutputSink
+{
+public:
+    explicit OutputSink(std::ostream &out, size_t capacity = 1 << 16);
+    // appends to a string, used by the to_string() overloads
+    explicit OutputSink(std::string &out, size_t capacity = 1 << 12);
+    ~OutputSink();
+    OutputSink(const OutputSink &) = delete;
+    OutputSink &operator=(const OutputSink &) = delete;
+
+    void write(const char *data, size_t size);
+    void write(const std::string &text) { write(text.data(), text.size()); }
+    void put(char c)
+    {
+        if (used == buffer.size())
+        {
+            flush();
+        }
+        buffer[used++] = c;
+    }
+    void write_int(long long value);
+    // shortest text that reads back to the same double
+    void write_double(double value);
+    // same text as std::ostream with this precision (6 is the stream default)
+    void write_double(double value, int precision);
+    void flush();
+
+    OutputSink &operator<<(const char *text);
+    OutputSink &operator<<(const std::string &text)
+    {
+        write(text);
+        return *this;
+    }
+    OutputSink &operator<<(char c)
+    {
+        put(c);
+        return *this;
+    }
+    OutputSink &operator<<(int value)
+    {
+        write_int(value);
+        return *this;
+    }
+    OutputSink &operator<<(long value)
+    {
+        write_int(value);
+        return *this;
+    }
+    OutputSink &operator<<(unsigned long value)
+    {
+        write_int((long long)value);
+        return *this;
+    }
+    OutputSink &operator<<(double value)
+    {
+        write_double(value, 6);
+        return *this;
+    }
+
+private:
+    // makes room for at least bytes characters
+    char *reserve(size_t bytes);
+
+    std::vector<char> buffer;
+    size_t used;
+    std::ostream *stream;
+    std::string *text;
+};
+
+enum PathFormat
+{
+    FORMAT_TEXT,  // "Path Number i - Reactions: ..." lines, as to_string(Paths)
+    FORMAT_CSV,   // "path,reactions" header, then "i,r1 r2 ..." rows
+    FORMAT_BINARY // varint-delta encoding, see write_paths_binary
+};
+
+///------------- Text writers -------------
+// Same text as the matching to_string() overload of utils.hpp, which now use them.
+
+void write_path(OutputSink &out, const Path &path);
+void write_paths(OutputSink &out, const Paths &paths);
+void write_paths(OutputSink &out, const PathSet &paths);
+void write_bfs(OutputSink &out, const BFS &result);
+void write_concentrations(OutputSink &out, const Concentrations &concentrations);
+
+/*!
+ * @brief the TSV of write_ranking(network, ranking, std::ostream &)
+ */
+void write_ranking(OutputSink &out, const Network &network, const PathRanking &ranking);
+
+///------------- Path set files -------------
+
+/*!
+ * @brief one row per path: path index (from 1), then the reactions separated by spaces
+ */
+void write_paths_csv(OutputSink &out, const PathSet &paths);
+
+/*!
+ * @brief compact binary path set
+ * "PSB1", then the number of paths and, for each path, its length, the length
+ * of the prefix it shares with the previous path and the zigzag-encoded
+ * differences between consecutive reactions of the rest, all as LEB128
+ * varints. Paths out of one DAG share long prefixes and neighbouring
+ * reaction IDs, so most paths take a few bytes.
+ */
+void write_paths_binary(OutputSink &out, const PathSet &paths);
+
+void write_paths(OutputSink &out, const PathSet &paths, PathFormat format);
+
+/*!
+ * @brief reads a path set written by write_paths / write_paths_csv / write_paths_binary
+ * @param paths cleared, then filled in file order
+ * throws std::runtime_error on a malformed input
+ */
+void read_paths(std::istream &in, PathSet &paths, PathFormat format);
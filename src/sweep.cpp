@@ -0,0 +1,236 @@
+/*
+ * Mini-projet 3 : kinetic parameter sweeps
+ */
+#include "sweep.hpp"
+#include <climits>
+#include <map>
+#include <mutex>
+#include "kinetics.hpp"
+#include "parallel.hpp"
+
+namespace
+{
+    void set_parameter(Reaction &reaction, KineticParameter parameter, double value)
+    {
+        switch (parameter)
+        {
+        case PARAM_V_PLUS:
+            reaction.V_plus = value;
+            break;
+        case PARAM_V_MINUS:
+            reaction.V_minus = value;
+            break;
+        case PARAM_K_S:
+            reaction.K_S = value;
+            break;
+        case PARAM_K_P:
+            reaction.K_P = value;
+            break;
+        }
+    }
+
+    // A swept parameter occurring in a candidate path
+    struct Override
+    {
+        size_t path;
+        size_t step;
+        size_t axis;
+    };
+
+    // Releases points to the callback in grid order, whatever order they complete in
+    class OrderedEmitter
+    {
+    public:
+        explicit OrderedEmitter(const SweepCallback &emit) : emit(emit), next(0) {}
+
+        void push(SweepPoint point)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending.insert({point.index, std::move(point)});
+            for (auto it = pending.find(next); it != pending.end(); it = pending.find(next))
+            {
+                emit(it->second);
+                pending.erase(it);
+                next++;
+            }
+        }
+
+    private:
+        const SweepCallback &emit;
+        std::mutex mutex;
+        std::map<size_t, SweepPoint> pending;
+        size_t next;
+    };
+}
+
+std::string to_string(KineticParameter parameter)
+{
+    switch (parameter)
+    {
+    case PARAM_V_PLUS:
+        return "V_plus";
+    case PARAM_V_MINUS:
+        return "V_minus";
+    case PARAM_K_S:
+        return "K_S";
+    case PARAM_K_P:
+        return "K_P";
+    }
+    return "?";
+}
+
+size_t sweep_grid_size(const std::vector<SweepAxis> &axes)
+{
+    size_t size = 1;
+    for (const SweepAxis &axis : axes)
+    {
+        size *= axis.values.size();
+    }
+    return size;
+}
+
+void sweep_parameters(const Network &network, const Paths &paths, const Concentrations &initial_concentrations,
+                      const std::vector<SweepAxis> &axes, const SweepCallback &emit, double dt, unsigned threads)
+{
+    size_t total = sweep_grid_size(axes);
+    if (total == 0)
+    {
+        return;
+    }
+    size_t lineLength = axes.empty() ? 1 : axes.back().values.size();
+    size_t lines = total / lineLength;
+
+    // lineStride[a] == distance between lines one step apart on axis a (a < last axis)
+    std::vector<size_t> lineStride(axes.empty() ? 0 : axes.size() - 1, 1);
+    for (size_t a = lineStride.size(); a-- > 1;)
+    {
+        lineStride[a - 1] = lineStride[a] * axes[a].values.size();
+    }
+
+    std::vector<CompiledPath> compiled;
+    std::vector<PathState> cold;
+    std::vector<Override> overrides;
+    for (size_t p = 0; p < paths.size(); ++p)
+    {
+        compiled.push_back(compile_path(network, paths[p]));
+        cold.push_back(initial_path_state(compiled.back(), initial_concentrations));
+        for (size_t s = 0; s < paths[p].size(); ++s)
+        {
+            for (size_t a = 0; a < axes.size(); ++a)
+            {
+                if (axes[a].reaction == paths[p][s])
+                {
+                    overrides.push_back({p, s, a});
+                }
+            }
+        }
+    }
+
+    // steady states of the first point of each solved line, used as warm starts
+    std::vector<std::vector<PathState>> lineSeeds(lines);
+    std::vector<bool> seeded(lines, false);
+    std::mutex seedMutex;
+
+    unsigned workers = threads == 0 ? default_thread_count() : threads;
+    std::vector<std::vector<CompiledPath>> workerPaths(workers);
+    OrderedEmitter emitter(emit);
+
+    auto solveLine = [&](size_t line, unsigned worker)
+    {
+        std::vector<CompiledPath> &local = workerPaths[worker];
+        if (local.size() != compiled.size())
+        {
+            local = compiled;
+        }
+
+        std::vector<PathState> states = cold;
+        {
+            std::lock_guard<std::mutex> lock(seedMutex);
+            size_t rest = line;
+            for (size_t a = lineStride.size(); a-- > 0;)
+            {
+                size_t coord = (rest / lineStride[a]) % axes[a].values.size();
+                if (coord > 0 && seeded[line - lineStride[a]])
+                {
+                    states = lineSeeds[line - lineStride[a]];
+                    break;
+                }
+            }
+        }
+
+        for (size_t j = 0; j < lineLength; ++j)
+        {
+            SweepPoint point;
+            point.index = line * lineLength + j;
+            point.values.resize(axes.size());
+            size_t rest = point.index;
+            for (size_t a = axes.size(); a-- > 0;)
+            {
+                point.values[a] = axes[a].values[rest % axes[a].values.size()];
+                rest /= axes[a].values.size();
+            }
+            for (const Override &o : overrides)
+            {
+                set_parameter(local[o.path].steps[o.step], axes[o.axis].parameter, point.values[o.axis]);
+            }
+
+            point.bestPath = -1;
+            point.rate = INT_MIN;
+            point.iterations = 0;
+            for (size_t p = 0; p < local.size(); ++p)
+            {
+                point.iterations += solve_ss_state(local[p], states[p], dt);
+                double pathRate = compute_path_rate(local[p], states[p]);
+                if (pathRate > point.rate)
+                {
+                    point.rate = pathRate;
+                    point.bestPath = (int)p;
+                }
+            }
+
+            if (j == 0)
+            {
+                std::lock_guard<std::mutex> lock(seedMutex);
+                lineSeeds[line] = states;
+                seeded[line] = true;
+            }
+            emitter.push(std::move(point));
+        }
+    };
+    parallel_for(lines, workers, solveLine);
+}
+
+void sweep_parameters(const Network &network, const Paths &paths, const Concentrations &initial_concentrations,
+                      const std::vector<SweepAxis> &axes, std::ostream &out, double dt, unsigned threads)
+{
+    out << "point";
+    for (const SweepAxis &axis : axes)
+    {
+        out << "\tR" << axis.reaction << "." << to_string(axis.parameter);
+    }
+    out << "\tpath\trate\n";
+
+    auto writeRow = [&](const SweepPoint &point)
+    {
+        out << point.index;
+        for (double value : point.values)
+        {
+            out << "\t" << value;
+        }
+        out << "\t";
+        if (point.bestPath < 0)
+        {
+            out << "-";
+        }
+        else
+        {
+            const Path &path = paths[point.bestPath];
+            for (size_t i = 0; i < path.size(); ++i)
+            {
+                out << (i ? " " : "") << path[i];
+            }
+        }
+        out << "\t" << point.rate << "\n";
+    };
+    sweep_parameters(network, paths, initial_concentrations, axes, writeRow, dt, threads);
+}
@@ -0,0 +1,65 @@
+/*
+ * Mini-projet 3 : kinetic parameter sweeps
+ */
+#pragma once
+#include <functional>
+#include <iostream>
+#include <vector>
+#include "pathsearch.hpp"
+
+/*-----------------  TYPES AND DATA STRUCTURES    ------------*/
+
+enum KineticParameter
+{
+    PARAM_V_PLUS,
+    PARAM_V_MINUS,
+    PARAM_K_S,
+    PARAM_K_P
+};
+
+// One dimension of the grid: the values taken by one parameter of one reaction
+struct SweepAxis
+{
+    ReactionID reaction;
+    KineticParameter parameter;
+    std::vector<double> values;
+};
+
+struct SweepPoint
+{
+    size_t index;               // row-major position in the grid, last axis varies fastest
+    std::vector<double> values; // one value per axis
+    int bestPath;               // index in the candidate paths, -1 if none
+    double rate;                // rate of the best path
+    size_t iterations;          // Euler steps spent on this point, all paths included
+};
+
+typedef std::function<void(const SweepPoint &)> SweepCallback;
+
+/*!
+ * @brief name of a kinetic parameter as used in table headers ("V_plus", ...)
+ */
+std::string to_string(KineticParameter parameter);
+
+/*!
+ * @brief number of points of the grid spanned by the axes (1 when there are no axes)
+ */
+size_t sweep_grid_size(const std::vector<SweepAxis> &axes);
+
+/*!
+ * @brief finds the fastest path at every point of a parameter grid
+ * The candidate paths are compiled once and grid lines (runs along the last
+ * axis) are distributed across threads. Each point's steady-state solve starts
+ * from the steady state of its nearest already-solved neighbour: the previous
+ * point of the line, or the first point of an adjacent line.
+ * @param emit called once per point, serialized and in grid order
+ * @param threads number of threads, 0 means one per hardware thread
+ */
+void sweep_parameters(const Network &network, const Paths &paths, const Concentrations &initial_concentrations,
+                      const std::vector<SweepAxis> &axes, const SweepCallback &emit, double dt = 1e-3, unsigned threads = 0);
+
+/*!
+ * @brief same as above, streaming a tab-separated table (point, axis values, path, rate)
+ */
+void sweep_parameters(const Network &network, const Paths &paths, const Concentrations &initial_concentrations,
+                      const std::vector<SweepAxis> &axes, std::ostream &out, double dt = 1e-3, unsigned threads = 0);
@@ -0,0 +1,209 @@
+/*
+ * Mini-projet 3 : top-k fastest paths
+ */
+#include "topk.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+#include "kinetics.hpp"
+#include "stream_io.hpp"
+
+namespace
+{
+    bool faster(const RankedPath &a, const RankedPath &b)
+    {
+        return a.rate > b.rate || (a.rate == b.rate && a.index < b.index);
+    }
+
+    /*!
+     * The k best paths so far, as a heap with the slowest on top.
+     */
+    class BoundedRanking
+    {
+    public:
+        explicit BoundedRanking(size_t k) : k(k) {}
+
+        // rate a path must exceed to enter; rates stay strictly below their bound,
+        // so a subtree bounded by at most this cannot enter either
+        double threshold() const
+        {
+            return k > 0 && heap.size() == k ? heap.front().rate : INT_MIN;
+        }
+
+        bool accepts(double rate, uint64_t index) const
+        {
+            if (k == 0)
+            {
+                return false;
+            }
+            return heap.size() < k || rate > heap.front().rate || (rate == heap.front().rate && index < heap.front().index);
+        }
+
+        void insert(RankedPath entry)
+        {
+            if (heap.size() == k)
+            {
+                std::pop_heap(heap.begin(), heap.end(), faster);
+                heap.pop_back();
+            }
+            heap.push_back(std::move(entry));
+            std::push_heap(heap.begin(), heap.end(), faster);
+        }
+
+        PathRanking sorted()
+        {
+            std::sort(heap.begin(), heap.end(), faster);
+            return std::move(heap);
+        }
+
+    private:
+        size_t k;
+        std::vector<RankedPath> heap;
+    };
+
+    struct Evaluator
+    {
+        CompiledPath compiled;
+        PathState state, scratch;
+
+        void offer(const Network &network, const Path &path, uint64_t index, const Concentrations &initial_concentrations,
+                   double dt, BoundedRanking &ranking)
+        {
+            compile_path(network, path.data(), path.size(), compiled);
+            initial_path_state(compiled, initial_concentrations, state);
+            solve_ss_state(compiled, state, scratch, dt);
+            double pathRate = compute_path_rate(compiled, state);
+            if (ranking.accepts(pathRate, index))
+            {
+                ranking.insert({path, pathRate, index, to_concentrations(compiled, state)});
+            }
+        }
+    };
+}
+
+PathRanking find_fastest_paths(const Network &network, const ShortestPathDag &dag, const Concentrations &initial_concentrations,
+                               double dt, size_t k, DagSearchStats *stats)
+{
+    DagSearchStats counters = {0, 0};
+    BoundedRanking ranking(k);
+    if (dag.nodes.empty() || k == 0)
+    {
+        if (stats)
+        {
+            *stats = {0, k == 0 ? count_paths(dag) : 0};
+        }
+        return ranking.sorted();
+    }
+    size_t length = path_length(dag);
+    size_t size = dag.nodes.size();
+
+    // same bounds as find_fastest_path on a DAG
+    std::vector<double> bound(dag.edges.size());
+    for (size_t e = 0; e < dag.edges.size(); ++e)
+    {
+        bound[e] = network.reactions[dag.edges[e].reaction].V_plus;
+    }
+    std::vector<double> widest(size, DBL_MAX);
+    for (size_t v = 1; v < size; ++v)
+    {
+        widest[v] = -DBL_MAX;
+        for (size_t e = dag.parent_start[v]; e < dag.parent_start[v + 1]; ++e)
+        {
+            widest[v] = std::max(widest[v], std::min(bound[e], widest[dag.edges[e].parent]));
+        }
+    }
+
+    Evaluator evaluator;
+    Path current(length);
+    std::vector<size_t> stackNode(length + 1), stackNext(length + 1);
+    std::vector<double> bottleneck(length + 1);
+    // rank of the first path below each stack entry, in find_all_shortest_paths order
+    std::vector<uint64_t> rank(length + 1);
+    long depth = 0;
+    stackNode[0] = size - 1;
+    stackNext[0] = dag.parent_start[size - 1];
+    bottleneck[0] = DBL_MAX;
+    rank[0] = 0;
+    while (depth >= 0)
+    {
+        size_t v = stackNode[depth];
+        if ((size_t)depth == length)
+        {
+            evaluator.offer(network, current, rank[depth], initial_concentrations, dt, ranking);
+            counters.evaluated++;
+            depth--;
+        }
+        else if (stackNext[depth] < dag.parent_start[v + 1])
+        {
+            size_t e = stackNext[depth]++;
+            const DagEdge &edge = dag.edges[e];
+            uint64_t first = rank[depth];
+            rank[depth] += dag.paths_from_source[edge.parent];
+            double reachable = std::min(bottleneck[depth], std::min(bound[e], widest[edge.parent]));
+            if (reachable <= ranking.threshold())
+            {
+                counters.pruned += dag.paths_from_source[edge.parent];
+                continue;
+            }
+            current[length - 1 - depth] = edge.reaction;
+            depth++;
+            stackNode[depth] = edge.parent;
+            stackNext[depth] = dag.parent_start[edge.parent];
+            bottleneck[depth] = std::min(bottleneck[depth - 1], bound[e]);
+            rank[depth] = first;
+        }
+        else
+        {
+            depth--;
+        }
+    }
+
+    if (stats)
+    {
+        *stats = counters;
+    }
+    return ranking.sorted();
+}
+
+PathRanking find_fastest_paths(const Network &network, const Paths &paths, const Concentrations &initial_concentrations,
+                               double dt, size_t k, DagSearchStats *stats)
+{
+    DagSearchStats counters = {0, 0};
+    BoundedRanking ranking(k);
+    Evaluator evaluator;
+    for (size_t i = 0; i < paths.size(); ++i)
+    {
+        double bound = DBL_MAX;
+        for (ReactionID reaction : paths[i])
+        {
+            bound = std::min(bound, network.reactions[reaction].V_plus);
+        }
+        if (k == 0 || bound <= ranking.threshold())
+        {
+            counters.pruned++;
+            continue;
+        }
+        evaluator.offer(network, paths[i], i, initial_concentrations, dt, ranking);
+        counters.evaluated++;
+    }
+    if (stats)
+    {
+        *stats = counters;
+    }
+    return ranking.sorted();
+}
+
+void write_ranking(const Network &network, const PathRanking &ranking, std::ostream &out)
+{
+    OutputSink sink(out);
+    write_ranking(sink, network, ranking);
+}
+
+std::string to_string(const Network &network, const PathRanking &ranking)
+{
+    std::string text;
+    OutputSink out(text);
+    write_ranking(out, network, ranking);
+    out.flush();
+    return text;
+}
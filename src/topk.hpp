@@ -0,0 +1,48 @@
+/*
+ * Mini-projet 3 : top-k fastest paths
+ */
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "dag.hpp"
+
+/*-----------------  TYPES AND DATA STRUCTURES    ------------*/
+
+struct RankedPath
+{
+    Path path;
+    double rate;
+    // index of the path in find_all_shortest_paths order (or in the given list)
+    uint64_t index;
+    Concentrations ss_concentrations;
+};
+
+// best first; equal rates in index order
+typedef std::vector<RankedPath> PathRanking;
+
+/*!
+ * @brief the k fastest paths of the DAG
+ * A bounded heap keeps the k best paths so far; once it is full, subtrees
+ * whose V_plus bottleneck cannot beat its k-th rate are skipped. The first
+ * entry is the answer of find_fastest_path.
+ * @param stats if not null, receives how many paths were evaluated and pruned
+ */
+PathRanking find_fastest_paths(const Network &network, const ShortestPathDag &dag, const Concentrations &initial_concentrations,
+                               double dt, size_t k, DagSearchStats *stats = nullptr);
+
+/*!
+ * @brief the k fastest paths of a list
+ */
+PathRanking find_fastest_paths(const Network &network, const Paths &paths, const Concentrations &initial_concentrations,
+                               double dt, size_t k, DagSearchStats *stats = nullptr);
+
+/*!
+ * @brief writes a ranking as TSV, one line per path:
+ * rank, rate, reaction IDs (space separated), then the steady state as
+ * compound=concentration pairs (comma separated, by compound ID)
+ */
+void write_ranking(const Network &network, const PathRanking &ranking, std::ostream &out);
+
+std::string to_string(const Network &network, const PathRanking &ranking);
@@ -1,5 +1,8 @@
 #include <algorithm>
+#include <atomic>
+#include <climits>
 #include <cmath> // std::fabs
+#include <fstream>
 #include <iomanip>
 #include <iostream> // std::cerr, std::endl
 #include <limits>   // std::numeric_limits
@@ -8,6 +11,35 @@
 #include "pathsearch.hpp"
 #include "unit_test.hpp"
 #include "utils.hpp"
+#include "kinetics.hpp"
+#include "sweep.hpp"
+#include "montecarlo.hpp"
+#include "random.hpp"
+#include "pathset.hpp"
+#include "dag.hpp"
+#include "kernels.hpp"
+#include "ratelaw.hpp"
+#include "server.hpp"
+#include "oracle.hpp"
+#include "components.hpp"
+#include "parallel_bfs.hpp"
+#include "reorder.hpp"
+#include "compact_bfs.hpp"
+#include "parallel_paths.hpp"
+#include "anytime.hpp"
+#include "topk.hpp"
+#include "near_shortest.hpp"
+#include "graph_view.hpp"
+#include "alloc_tracking.hpp"
+#include "fuzz.hpp"
+#include "stream_io.hpp"
+#include "partition.hpp"
+#include "shard.hpp"
+#include "screening.hpp"
+#include "comparative.hpp"
+#include "directed.hpp"
+#include <thread>
+#include <unistd.h>
 
 using namespace std;
 
@@ -61,6 +93,32 @@ void check_equal(int expected, int computed)
     std::cerr << "   expected: " << expected << std::endl;
     std::cerr << "   computed: " << computed << std::endl;
 }
+void check_equal(bool expected, bool computed)
+{
+    if (expected == computed)
+    {
+        std::cerr << "[Passed]" << std::endl
+                  << std::endl;
+        return;
+    }
+    std::cerr << "[Failed]" << std::endl;
+    std::cerr << "   expected: " << std::boolalpha << expected << std::endl;
+    std::cerr << "   computed: " << std::boolalpha << computed << std::endl;
+}
+
+void check_equal(const std::string &expected, const std::string &computed)
+{
+    if (expected == computed)
+    {
+        std::cerr << "[Passed]" << std::endl
+                  << std::endl;
+        return;
+    }
+    std::cerr << "[Failed]" << std::endl;
+    std::cerr << "   expected: " << expected << std::endl;
+    std::cerr << "   computed: " << computed << std::endl;
+}
+
 void check_equal(const Path &expected, const Path &computed)
 {
     if (expected == computed)
@@ -291,6 +349,1525 @@ void test_find_fastest_path()
     check_equal({5, 1}, fastest_path);
 }
 
+void test_compiled_path()
+{
+    print_header("test_compiled_path");
+    Network network = read_network("data/7paths.txt");
+    Concentrations initial = read_initial_concentrations(network, "data/7paths_concentrations.txt");
+    std::cerr << "Testing with network 7paths.txt " << std::endl;
+    // compounds 6 -> 3 -> 1 -> 2: the intermediates are not in ID order
+    Path path({9, 5, 1});
+    Concentrations expected = compute_ss_concentration(network, path, initial, 1e-3);
+
+    CompiledPath compiled = compile_path(network, path);
+    PathState state = initial_path_state(compiled, initial);
+    solve_ss_state(compiled, state, 1e-3);
+    Concentrations computed = to_concentrations(compiled, state);
+    check_equal(expected[6], computed[6]);
+    check_equal(expected[3], computed[3]);
+    check_equal(expected[1], computed[1]);
+    check_equal(expected[2], computed[2]);
+    check_equal(compute_path_rate(network, path, expected), compute_path_rate(compiled, state));
+}
+
+void test_sweep_parameters()
+{
+    print_header("test_sweep_parameters");
+    Network network = read_network("data/7paths.txt");
+    Concentrations initial = read_initial_concentrations(network, "data/7paths_concentrations.txt");
+    std::cerr << "Testing with network 7paths.txt " << std::endl;
+    Paths paths({{5, 1}, {3, 4}});
+    double v = network.reactions[3].V_plus;
+    std::vector<SweepAxis> axes({{3, PARAM_V_PLUS, {v, 10 * v, 100 * v}},
+                                 {5, PARAM_K_S, {network.reactions[5].K_S, 1e3}}});
+
+    std::vector<SweepPoint> points;
+    auto collect = [&](const SweepPoint &point)
+    {
+        points.push_back(point);
+    };
+    sweep_parameters(network, paths, initial, axes, collect, 1e-2, 2);
+    check_equal(6, (int)points.size());
+    check_equal(3, (int)points[3].index);
+    // first point is the unmodified network
+    check_equal(0, points[0].bestPath);
+    Concentrations ss = compute_ss_concentration(network, paths[0], initial, 1e-2);
+    check_equal(compute_path_rate(network, paths[0], ss), points[0].rate);
+    // a very large K_S kills reaction 5, a fast reaction 3 makes the other path win
+    check_equal(1, points[5].bestPath);
+
+    std::stringstream table;
+    sweep_parameters(network, paths, initial, axes, table, 1e-2, 1);
+    std::string header;
+    std::getline(table, header);
+    check_equal(std::string("point\tR3.V_plus\tR5.K_S\tpath\trate"), header);
+}
+
+void test_p2_quantile()
+{
+    print_header("test_p2_quantile");
+    SplitMix64 rng(7);
+    P2Quantile median(0.5);
+    P2Quantile high(0.9);
+    for (int i = 0; i < 20000; ++i)
+    {
+        double x = rng.next_double();
+        median.add(x);
+        high.add(x);
+    }
+    check_equal(true, std::fabs(median.value() - 0.5) < 0.02);
+    check_equal(true, std::fabs(high.value() - 0.9) < 0.02);
+}
+
+void test_rank_paths_monte_carlo()
+{
+    print_header("test_rank_paths_monte_carlo");
+    Network network = read_network("data/7paths.txt");
+    std::cerr << "Testing with network 7paths.txt " << std::endl;
+    Paths paths({{5, 1}, {3, 4}});
+    MonteCarloOptions options;
+    options.samples = 200;
+    options.batch_size = 16;
+    options.threads = 1;
+    MonteCarloRanking single = rank_paths_monte_carlo(network, paths, options);
+    options.threads = 3;
+    MonteCarloRanking parallel = rank_paths_monte_carlo(network, paths, options);
+
+    check_equal(200, (int)(single.paths[0].wins + single.paths[1].wins));
+    // reproducible whatever the number of threads
+    check_equal((int)single.paths[0].wins, (int)parallel.paths[0].wins);
+    check_equal(single.paths[1].mean_rate, parallel.paths[1].mean_rate);
+    check_equal(single.paths[1].quantiles[1], parallel.paths[1].quantiles[1]);
+    check_equal(true, single.paths[0].quantiles[0] <= single.paths[0].quantiles[2]);
+    check_equal(true, single.paths[single.order[0]].wins >= single.paths[single.order[1]].wins);
+}
+
+void test_path_set()
+{
+    print_header("test_path_set");
+    PathSet paths;
+    paths.push_back({5, 1});
+    paths.push_back({3, 4});
+    check_equal(true, paths.fixed_stride());
+    check_equal({3, 4}, paths[1].to_path());
+    paths.push_back({0, 1, 2});
+    check_equal(false, paths.fixed_stride());
+    check_equal({{5, 1}, {3, 4}, {0, 1, 2}}, paths.to_paths());
+    paths.clear();
+    check_equal(0, (int)paths.size());
+}
+
+void test_find_all_shortest_paths_path_set()
+{
+    print_header("test_find_all_shortest_paths_path_set");
+    AdjacencyGraph graph(SEVEN_PATH_ADJACENCY);
+    PathSet paths;
+    ScratchArena arena;
+    find_all_shortest_paths(graph, 3, 2, paths, arena);
+    check_equal(find_all_shortest_paths(graph, 3, 2), paths.to_paths());
+    // every pair, reusing the same set and arena
+    bool same = true;
+    for (CompoundID src = 0; src < (CompoundID)graph.size(); ++src)
+    {
+        for (CompoundID dest = 0; dest < (CompoundID)graph.size(); ++dest)
+        {
+            find_all_shortest_paths(graph, src, dest, paths, arena);
+            same = same && paths.to_paths() == find_all_shortest_paths(graph, src, dest);
+        }
+    }
+    check_equal(true, same);
+
+    Network network = read_network("data/7paths.txt");
+    Concentrations initial = read_initial_concentrations(network, "data/7paths_concentrations.txt");
+    find_all_shortest_paths(graph, 3, 2, paths, arena);
+    check_equal({5, 1}, find_fastest_path(network, paths, initial, 1e-2).to_path());
+}
+
+void test_shortest_path_dag()
+{
+    print_header("test_shortest_path_dag");
+    AdjacencyGraph graph(SEVEN_PATH_ADJACENCY);
+    ShortestPathDag dag = build_shortest_path_dag(graph, 3, 2);
+    check_equal(2, path_length(dag));
+    check_equal(2, (int)count_paths(dag));
+    check_equal(find_all_shortest_paths(graph, 3, 2), to_paths(dag));
+    check_equal({3, 4}, get_path(dag, 1));
+
+    Network network = read_network("data/C00025-C00148.txt");
+    Concentrations initial = read_initial_concentrations(network, "data/C00025-C00148_concentrations.txt");
+    std::cerr << "Testing with network C00025-C00148.txt " << std::endl;
+    AdjacencyGraph large = build_adjacency_graph(network);
+    ShortestPathDag largeDag = build_shortest_path_dag(large, 0, 32);
+    Paths expected = find_all_shortest_paths(large, 0, 32);
+    check_equal(expected, to_paths(largeDag));
+    check_equal(expected.back(), get_path(largeDag, count_paths(largeDag) - 1));
+
+    DagSearchStats stats;
+    check_equal(find_fastest_path(network, expected, initial, 1e-2), find_fastest_path(network, largeDag, initial, 1e-2, &stats));
+    check_equal((int)count_paths(largeDag), (int)(stats.evaluated + stats.pruned));
+}
+
+void test_fixed_length_kernels()
+{
+    print_header("test_fixed_length_kernels");
+    Network network = read_network("data/7paths.txt");
+    Concentrations initial = read_initial_concentrations(network, "data/7paths_concentrations.txt");
+    std::cerr << "Testing with network 7paths.txt " << std::endl;
+    // a 10 reaction chain goes through the generic fallback
+    Network chain;
+    for (int i = 0; i <= 10; ++i)
+    {
+        chain.compounds.push_back("C" + std::to_string(i));
+        initial[100 + i] = 0.1 * i;
+    }
+    Path longPath;
+    for (int i = 0; i < 10; ++i)
+    {
+        chain.reactions.push_back({{100 + i, 101 + i}, 2.0 + i, 1.0, 0.5, 0.7});
+        longPath.push_back(i);
+    }
+    // a product stuck at 0 makes checkStable divide 0 by 0, which counts as stable
+    Network drained;
+    drained.compounds = {"A", "B"};
+    drained.reactions.push_back({{200, 201}, 0.0, 1.0, 1.0, 1.0});
+    initial[200] = 1.0;
+    initial[201] = 0.0;
+
+    std::vector<CompiledPath> paths({compile_path(network, {0}), compile_path(network, {5, 1}),
+                                     compile_path(network, {9, 5, 1}), compile_path(chain, longPath),
+                                     compile_path(drained, {0})});
+    for (const CompiledPath &path : paths)
+    {
+        PathState generic = initial_path_state(path, initial);
+        PathState fixed = generic;
+        size_t genericIterations = solve_ss_state(path, generic, 1e-2);
+        size_t fixedIterations = solve_ss_state_fixed(path, fixed, 1e-2);
+        // same arithmetic, so the results are identical, not just close
+        check_equal(true, generic == fixed && genericIterations == fixedIterations);
+        check_equal(true, compute_path_rate(path, generic) == compute_path_rate_fixed(path, fixed));
+    }
+}
+
+void test_michaelis_reversible_rate_batch()
+{
+    print_header("test_michaelis_reversible_rate_batch");
+    Network network = read_network("data/C00025-C00148.txt");
+    std::cerr << "Testing with network C00025-C00148.txt, " << rate_kernel_name() << " kernel" << std::endl;
+    std::vector<ReactionID> ids;
+    std::vector<double> S, P;
+    SplitMix64 rng(31);
+    for (int i = 0; i < 103; ++i)
+    {
+        ids.push_back((ReactionID)(rng.next() % network.reactions.size()));
+        S.push_back(rng.next_double());
+        P.push_back(rng.next_double());
+    }
+    std::vector<double> scalar(ids.size()), simd(ids.size()), best(ids.size());
+    michaelis_reversible_rate_batch_scalar(network.kinetics, ids.data(), S.data(), P.data(), scalar.data(), ids.size());
+    michaelis_reversible_rate_batch(network.kinetics, ids.data(), S.data(), P.data(), best.data(), ids.size());
+    if (has_avx2_rate_kernel())
+    {
+        michaelis_reversible_rate_batch_avx2(network.kinetics, ids.data(), S.data(), P.data(), simd.data(), ids.size());
+    }
+    else
+    {
+        simd = scalar;
+    }
+    double worst = 0.0;
+    for (size_t i = 0; i < ids.size(); ++i)
+    {
+        double expected = michaelis_reversible_rate(network.reactions[ids[i]], S[i], P[i]);
+        worst = std::max(worst, std::fabs(expected - scalar[i]));
+        worst = std::max(worst, std::fabs(expected - simd[i]));
+        worst = std::max(worst, std::fabs(expected - best[i]));
+    }
+    check_equal(true, worst < 1e-12);
+
+    std::vector<double> concentrations(network.compounds.size(), 0.5), rates;
+    compute_network_rates(network, concentrations, rates);
+    check_equal(michaelis_reversible_rate(network.reactions[7], 0.5, 0.5), rates[7]);
+}
+
+void test_answer_query()
+{
+    print_header("test_answer_query");
+    NetworkRegistry registry;
+    registry.load("seven", "../data/7paths.txt", "../data/7paths_concentrations.txt");
+    check_equal(std::string("OK seven"), answer_query(registry, "list"));
+    check_equal(std::string("OK 2"), answer_query(registry, "distance seven C01165 C00148"));
+    check_equal(std::string("OK 5 1"), answer_query(registry, "shortest seven C01165 C00148"));
+    check_equal(std::string("OK 2 ; 5 1 ; 3 4"), answer_query(registry, "all seven C01165 C00148"));
+    check_equal(true, answer_query(registry, "fastest seven C01165 C00148 1e-2").find("; 5 1") != std::string::npos);
+    // steps that cannot converge are refused instead of holding a worker
+    for (std::string dt : {"1", "-0.01", "nan", "inf"})
+    {
+        check_equal(std::string("ERR dt"), answer_query(registry, "fastest seven C01165 C00148 " + dt).substr(0, 6));
+    }
+    check_equal(true, answer_query(registry, "fastest seven C01165 C00148 auto").find("; 5 1") != std::string::npos);
+    // dt = 0.1 oscillates on this network: the step budget ends the query
+    registry.load("big", "../data/C00025-C00148.txt", "../data/C00025-C00148_concentrations.txt");
+    Network big = read_network("data/C00025-C00148.txt");
+    check_equal(std::string("ERR steady state not reached within the step budget"),
+                answer_query(registry, "fastest big " + big.compounds[0] + " " + big.compounds[32] + " 0.1"));
+    check_equal(std::string("ERR unknown compound C99999"), answer_query(registry, "shortest seven C01165 C99999"));
+    check_equal(std::string("ERR unknown network other"), answer_query(registry, "shortest other C01165 C00148"));
+}
+
+void test_query_server()
+{
+    print_header("test_query_server");
+    NetworkRegistry registry;
+    registry.load("seven", "../data/7paths.txt", "../data/7paths_concentrations.txt");
+    std::string socket = "/tmp/pathsearch-test-" + std::to_string(getpid()) + ".sock";
+    QueryServer server(registry, socket, 3);
+    server.listen();
+    std::thread loop(&QueryServer::run, &server);
+
+    QueryClient client(socket);
+    // pipelined requests, including a reload while others are in flight
+    client.send("shortest seven C01165 C00148");
+    client.send("fastest seven C01165 C00148 1e-2");
+    client.send("reload seven");
+    client.send("all seven C01165 C00148");
+    client.send("ping");
+    check_equal(std::string("OK 5 1"), client.receive());
+    check_equal(true, client.receive().find("; 5 1") != std::string::npos);
+    check_equal(std::string("OK reloaded seven"), client.receive());
+    check_equal(std::string("OK 2 ; 5 1 ; 3 4"), client.receive());
+    check_equal(std::string("OK pong"), client.receive());
+
+    QueryClient other(socket);
+    check_equal(std::string("OK 2"), other.query("distance seven C01165 C00148"));
+
+    // a client gone before its answers are ready: they are dropped, the others still get theirs
+    {
+        QueryClient gone(socket);
+        for (int i = 0; i < 8; ++i)
+        {
+            gone.send("fastest seven C01165 C00148 1e-3");
+        }
+    }
+    check_equal(std::string("OK pong"), other.query("ping"));
+    check_equal(true, other.query("fastest seven C01165 C00148 1e-2").find("; 5 1") != std::string::npos);
+
+    server.stop();
+    loop.join();
+}
+
+void test_distance_oracle()
+{
+    print_header("test_distance_oracle");
+    Network network = read_network("data/C00025-C00148.txt");
+    std::cerr << "Testing with network C00025-C00148.txt " << std::endl;
+    AdjacencyGraph graph = build_adjacency_graph(network);
+    DistanceOracle built = DistanceOracle::build(graph);
+    std::string filename = "/tmp/pathsearch-test-" + std::to_string(getpid()) + ".oracle";
+    built.save(filename);
+    DistanceOracle loaded = DistanceOracle::load(filename);
+    unlink(filename.c_str());
+    check_equal((int)graph.size(), (int)loaded.size());
+
+    bool distances = true, paths = true;
+    for (CompoundID src = 0; src < (CompoundID)graph.size(); ++src)
+    {
+        BFS result = bfs(graph, src);
+        for (CompoundID dest = 0; dest < (CompoundID)graph.size(); ++dest)
+        {
+            distances = distances && built.distance(src, dest) == result.distances[dest] && loaded.distance(src, dest) == result.distances[dest];
+            paths = paths && find_all_shortest_paths(graph, src, dest, loaded) == find_all_shortest_paths(graph, src, dest);
+        }
+    }
+    check_equal(true, distances);
+    check_equal(true, paths);
+
+    // two components: 0 - 1 and 2 - 3
+    AdjacencyGraph split({{{1, 0}}, {{0, 0}}, {{3, 1}}, {{2, 1}}});
+    DistanceOracle splitOracle = DistanceOracle::build(split);
+    check_equal(-1, splitOracle.distance(0, 3));
+    check_equal(0, (int)find_all_shortest_paths(split, 0, 3, splitOracle).size());
+}
+
+void test_components()
+{
+    print_header("test_components");
+    Network network = read_network("data/C00025-C00148.txt");
+    std::cerr << "Testing with network C00025-C00148.txt " << std::endl;
+    IndexedGraph graph = build_indexed_graph(network, 3);
+    check_equal(build_adjacency_graph(network), graph.adjacency, network);
+    ComponentIndex sequential = compute_components(graph.adjacency);
+    check_equal(true, graph.components.component == sequential.component);
+    check_equal(true, graph.components.sizes == sequential.sizes);
+
+    bool components = true, paths = true;
+    for (CompoundID src = 0; src < (CompoundID)graph.adjacency.size(); ++src)
+    {
+        BFS expected = bfs(graph.adjacency, src);
+        BFS result = bfs(graph, src);
+        components = components && result.distances == expected.distances && result.parents == expected.parents;
+        for (CompoundID dest = 0; dest < (CompoundID)graph.adjacency.size(); ++dest)
+        {
+            components = components && same_component(graph, src, dest) == (expected.distances[dest] != INT_MAX);
+            paths = paths && find_all_shortest_paths(graph, src, dest) == find_all_shortest_paths(graph.adjacency, src, dest);
+            paths = paths && find_shortest_path(graph, src, dest) == find_shortest_path(graph.adjacency, src, dest);
+        }
+    }
+    check_equal(true, components);
+    check_equal(true, paths);
+
+    // two components: 0 - 1 and 2 - 3, then edits
+    IndexedGraph split;
+    split.adjacency = AdjacencyGraph({{{1, 0}}, {{0, 0}}, {{3, 1}}, {{2, 1}}});
+    split.components = compute_components(split.adjacency);
+    check_equal(false, same_component(split, 0, 3));
+    check_equal(0, (int)find_shortest_path(split.adjacency, 0, 3).size());
+    check_equal(0, (int)find_shortest_path(split, 0, 3).size());
+    check_equal(0, (int)find_all_shortest_paths(split, 0, 3).size());
+
+    add_edge(split, 1, 2, 2);
+    check_equal(true, same_component(split, 0, 3));
+    check_equal(Path({0, 2, 1}), find_shortest_path(split, 0, 3));
+    CompoundID lone = add_compound(split);
+    check_equal(false, same_component(split, 0, lone));
+    add_edge(split, lone, 3, 3);
+    check_equal(5, (int)split.components.sizes[split.components.component[lone]]);
+
+    remove_edge(split, 1, 2);
+    check_equal(false, same_component(split, 0, 3));
+    check_equal(true, same_component(split, 2, lone));
+    check_equal(2, (int)split.components.sizes[split.components.component[0]]);
+    check_equal(3, (int)split.components.sizes[split.components.component[3]]);
+    ComponentIndex recomputed = compute_components(split.adjacency);
+    bool partition = true;
+    for (CompoundID a = 0; a <= lone; ++a)
+    {
+        for (CompoundID b = 0; b <= lone; ++b)
+        {
+            partition = partition && same_component(split, a, b) == (recomputed.component[a] == recomputed.component[b]);
+        }
+    }
+    check_equal(true, partition);
+
+    // a cycle 0 - 1 - 2 - 3 - 0: removing one of its edges keeps every label
+    add_edge(split, 1, 2, 2);
+    add_edge(split, 0, 3, 4);
+    std::vector<int> before = split.components.component;
+    remove_edge(split, 1, 2);
+    check_equal(true, split.components.component == before);
+    check_equal(5, (int)split.components.sizes[split.components.component[0]]);
+    check_equal(Path({4}), find_shortest_path(split, 0, 3));
+}
+
+void test_parallel_bfs()
+{
+    print_header("test_parallel_bfs");
+    check_equal(bfs(SEVEN_PATH_ADJACENCY, 0), parallel_bfs(SEVEN_PATH_ADJACENCY, 0, 2));
+
+    Network network = read_network("data/C00025-C00148.txt");
+    std::cerr << "Testing with network C00025-C00148.txt " << std::endl;
+    AdjacencyGraph graph = build_adjacency_graph(network);
+    bool identical = true;
+    for (unsigned threads = 1; threads <= 4; ++threads)
+    {
+        for (CompoundID src = 0; src < (CompoundID)graph.size(); ++src)
+        {
+            BFS expected = bfs(graph, src);
+            BFS result = parallel_bfs(graph, src, threads);
+            identical = identical && result.distances == expected.distances && result.parents == expected.parents;
+        }
+    }
+    check_equal(true, identical);
+}
+
+void test_reorder_network()
+{
+    print_header("test_reorder_network");
+    Network network = read_network("data/C00025-C00148.txt");
+    std::cerr << "Testing with network C00025-C00148.txt " << std::endl;
+    AdjacencyGraph graph = build_adjacency_graph(network);
+    auto sorted = [](Paths paths)
+    {
+        std::sort(paths.begin(), paths.end());
+        return paths;
+    };
+    for (CompoundOrdering ordering : {ORDER_IDENTITY, ORDER_BFS, ORDER_RCM, ORDER_DEGREE})
+    {
+        ReorderedNetwork reordered = reorder_network(network, ordering);
+        const Renumbering &mapping = reordered.mapping;
+        bool bijective = true;
+        for (CompoundID c = 0; c < (CompoundID)network.compounds.size(); ++c)
+        {
+            bijective = bijective && mapping.compound_to_original[mapping.compound_to_internal[c]] == c &&
+                        reordered.network.compounds[mapping.compound_to_internal[c]] == network.compounds[c];
+        }
+        for (ReactionID r = 0; r < (ReactionID)network.reactions.size(); ++r)
+        {
+            bijective = bijective && mapping.reaction_to_original[mapping.reaction_to_internal[r]] == r;
+        }
+        check_equal(true, bijective);
+
+        bool distances = true, paths = true;
+        for (CompoundID src = 0; src < (CompoundID)graph.size(); ++src)
+        {
+            distances = distances && bfs(reordered, src).distances == bfs(graph, src).distances;
+            for (CompoundID dest = 0; dest < (CompoundID)graph.size(); ++dest)
+            {
+                Paths expected = sorted(find_all_shortest_paths(graph, src, dest));
+                Path shortest = find_shortest_path(reordered, src, dest);
+                paths = paths && sorted(find_all_shortest_paths(reordered, src, dest)) == expected;
+                paths = paths && (expected.empty() ? shortest.empty() : std::binary_search(expected.begin(), expected.end(), shortest));
+            }
+        }
+        check_equal(true, distances);
+        check_equal(true, paths);
+    }
+
+    Network sevenPaths = read_network("data/7paths.txt");
+    Concentrations initial = read_initial_concentrations(sevenPaths, "data/7paths_concentrations.txt");
+    ReorderedNetwork reordered = reorder_network(sevenPaths, ORDER_RCM);
+    check_equal(true, original_concentrations(reordered.mapping, internal_concentrations(reordered.mapping, initial)) == initial);
+    check_equal({5, 1}, find_fastest_path(reordered, Paths({{5, 1}, {3, 4}}), initial, 1e-2));
+    Paths all = find_all_shortest_paths(build_adjacency_graph(sevenPaths), 0, 4);
+    check_equal(find_fastest_path(sevenPaths, all, initial, 1e-2), find_fastest_path(reordered, all, initial, 1e-2));
+}
+
+void test_compact_bfs()
+{
+    print_header("test_compact_bfs");
+    check_equal(bfs(SEVEN_PATH_ADJACENCY, 0), compact_bfs(SEVEN_PATH_ADJACENCY, 0).to_bfs());
+
+    Network network = read_network("data/C00025-C00148.txt");
+    std::cerr << "Testing with network C00025-C00148.txt " << std::endl;
+    AdjacencyGraph graph = build_adjacency_graph(network);
+    CompactBFS reused;
+    bool identical = true;
+    for (CompoundID src = 0; src < (CompoundID)graph.size(); ++src)
+    {
+        BFS expected = bfs(graph, src);
+        compact_bfs(graph, src, reused);
+        BFS result = reused.to_bfs();
+        identical = identical && reused.distance_bits() == 8 && result.distances == expected.distances && result.parents == expected.parents;
+        BFS roundTrip = CompactBFS::from_bfs(expected).to_bfs();
+        identical = identical && roundTrip.distances == expected.distances && roundTrip.parents == expected.parents;
+    }
+    check_equal(true, identical);
+
+    // a 300 compound chain needs 16 bit distances; compound 300 is isolated
+    AdjacencyGraph chain(301);
+    for (CompoundID c = 0; c + 1 < 300; ++c)
+    {
+        chain[c][c + 1] = c;
+        chain[c + 1][c] = c;
+    }
+    CompactBFS deep = compact_bfs(chain, 0);
+    check_equal(16, (int)deep.distance_bits());
+    check_equal(299, deep.distance(299));
+    check_equal(INT_MAX, deep.distance(300));
+    check_equal(0, (int)deep.parents(300).size());
+    check_equal(-1, deep.parents(0)[0]);
+    check_equal(298, deep.parents(299)[0]);
+    check_equal(bfs(chain, 0), deep.to_bfs());
+}
+
+void test_parallel_path_enumeration()
+{
+    print_header("test_parallel_path_enumeration");
+    Network network = read_network("data/C00025-C00148.txt");
+    Concentrations initial = read_initial_concentrations(network, "data/C00025-C00148_concentrations.txt");
+    std::cerr << "Testing with network C00025-C00148.txt " << std::endl;
+    AdjacencyGraph graph = build_adjacency_graph(network);
+    bool paths = true, fastest = true;
+    for (CompoundID src = 0; src < (CompoundID)graph.size(); ++src)
+    {
+        BFS result = bfs(graph, src);
+        for (CompoundID dest = 0; dest < (CompoundID)graph.size(); ++dest)
+        {
+            if (dest == src || result.distances[dest] == INT_MAX)
+            {
+                continue;
+            }
+            ShortestPathDag dag = build_shortest_path_dag(graph, result, dest);
+            Paths expected = find_all_shortest_paths(graph, src, dest);
+            paths = paths && to_paths_parallel(dag, 3) == expected;
+            fastest = fastest && find_fastest_path_parallel(network, dag, initial, 1e-2, 3) == find_fastest_path(network, dag, initial, 1e-2);
+        }
+    }
+    check_equal(true, paths);
+    check_equal(true, fastest);
+
+    // grain 1 splits the walk at every node, each rank is still visited once
+    ShortestPathDag dag = build_shortest_path_dag(SEVEN_PATH_ADJACENCY, 0, 4);
+    std::vector<std::atomic<int>> seen(count_paths(dag));
+    auto mark = [&](uint64_t rank, const ReactionID *, unsigned)
+    {
+        seen[rank]++;
+    };
+    for_each_path_parallel(dag, 4, mark, 1);
+    bool once = true;
+    for (std::atomic<int> &count : seen)
+    {
+        once = once && count.load() == 1;
+    }
+    check_equal(true, once);
+    check_equal(to_paths(dag), to_paths_parallel(dag, 4));
+}
+
+void test_find_fastest_path_anytime()
+{
+    print_header("test_find_fastest_path_anytime");
+    Network network = read_network("data/C00025-C00148.txt");
+    Concentrations initial = read_initial_concentrations(network, "data/C00025-C00148_concentrations.txt");
+    std::cerr << "Testing with network C00025-C00148.txt " << std::endl;
+    AdjacencyGraph graph = build_adjacency_graph(network);
+    bool same = true, complete = true;
+    for (CompoundID src = 0; src < (CompoundID)graph.size(); ++src)
+    {
+        BFS result = bfs(graph, src);
+        for (CompoundID dest = 0; dest < (CompoundID)graph.size(); ++dest)
+        {
+            if (dest == src || result.distances[dest] == INT_MAX)
+            {
+                continue;
+            }
+            ShortestPathDag dag = build_shortest_path_dag(graph, result, dest);
+            AnytimeResult anytime = find_fastest_path_anytime(network, dag, initial, 1e-2, QueryBudget());
+            same = same && anytime.path == find_fastest_path(network, dag, initial, 1e-2);
+            complete = complete && anytime.optimal && anytime.stats.stop == STOP_COMPLETED &&
+                       anytime.stats.evaluated + anytime.stats.pruned == count_paths(dag);
+        }
+    }
+    check_equal(true, same);
+    check_equal(true, complete);
+
+    Network sevenPaths = read_network("data/7paths.txt");
+    Concentrations sevenInitial = read_initial_concentrations(sevenPaths, "data/7paths_concentrations.txt");
+    Paths paths({{5, 1}, {3, 4}});
+    AnytimeResult listed = find_fastest_path_anytime(sevenPaths, paths, sevenInitial, 1e-2, QueryBudget());
+    check_equal({5, 1}, listed.path);
+    check_equal(true, listed.optimal);
+
+    ShortestPathDag dag = build_shortest_path_dag(SEVEN_PATH_ADJACENCY, 0, 4);
+    QueryBudget budget;
+    budget.max_total_iterations = 10;
+    AnytimeResult limited = find_fastest_path_anytime(sevenPaths, dag, sevenInitial, 1e-2, budget);
+    check_equal(to_string(STOP_ITERATION_BUDGET), to_string(limited.stats.stop));
+    check_equal(false, limited.optimal);
+    check_equal(10, (int)limited.stats.iterations);
+
+    budget = QueryBudget();
+    budget.max_path_iterations = 5;
+    AnytimeResult capped = find_fastest_path_anytime(sevenPaths, dag, sevenInitial, 1e-2, budget);
+    check_equal(true, capped.path.empty());
+    check_equal((int)count_paths(dag), (int)capped.stats.unconverged);
+    check_equal(false, capped.optimal);
+
+    AnytimeResult late = find_fastest_path_anytime(sevenPaths, dag, sevenInitial, 1e-2, budget_for(std::chrono::seconds(0)));
+    check_equal(to_string(STOP_DEADLINE), to_string(late.stats.stop));
+
+    // cancelled from another thread while a solve that would take hours is running
+    CancellationToken token;
+    budget = budget_for(std::chrono::seconds(10));
+    budget.max_path_iterations = std::numeric_limits<size_t>::max();
+    budget.cancellation = &token;
+    auto cancelSoon = [&]()
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        token.cancel();
+    };
+    std::thread canceller(cancelSoon);
+    AnytimeResult cancelled = find_fastest_path_anytime(sevenPaths, dag, sevenInitial, 1e-9, budget);
+    canceller.join();
+    check_equal(to_string(STOP_CANCELLED), to_string(cancelled.stats.stop));
+    check_equal(false, cancelled.optimal);
+}
+
+void test_find_fastest_paths()
+{
+    print_header("test_find_fastest_paths");
+    Network network = read_network("data/C00025-C00148.txt");
+    Concentrations initial = read_initial_concentrations(network, "data/C00025-C00148_concentrations.txt");
+    std::cerr << "Testing with network C00025-C00148.txt " << std::endl;
+    AdjacencyGraph graph = build_adjacency_graph(network);
+    const size_t k = 3;
+    bool same = true, winner = true, listed = true;
+    for (CompoundID src = 0; src < (CompoundID)graph.size(); ++src)
+    {
+        BFS result = bfs(graph, src);
+        for (CompoundID dest = 0; dest < (CompoundID)graph.size(); ++dest)
+        {
+            if (dest == src || result.distances[dest] == INT_MAX)
+            {
+                continue;
+            }
+            ShortestPathDag dag = build_shortest_path_dag(graph, result, dest);
+            Paths paths = to_paths(dag);
+            // every rate, then a stable sort: the expected ranking
+            std::vector<std::pair<double, size_t>> rates;
+            for (size_t i = 0; i < paths.size(); ++i)
+            {
+                CompiledPath compiled = compile_path(network, paths[i]);
+                PathState state = initial_path_state(compiled, initial);
+                solve_ss_state(compiled, state, 1e-2);
+                rates.push_back({-compute_path_rate(compiled, state), i});
+            }
+            std::sort(rates.begin(), rates.end());
+            PathRanking ranking = find_fastest_paths(network, dag, initial, 1e-2, k);
+            same = same && ranking.size() == std::min(k, paths.size());
+            for (size_t r = 0; same && r < ranking.size(); ++r)
+            {
+                same = ranking[r].index == rates[r].second && ranking[r].path == paths[rates[r].second] && ranking[r].rate == -rates[r].first;
+            }
+            winner = winner && ranking[0].path == find_fastest_path(network, dag, initial, 1e-2);
+            PathRanking fromList = find_fastest_paths(network, paths, initial, 1e-2, k);
+            for (size_t r = 0; listed && r < ranking.size(); ++r)
+            {
+                listed = fromList[r].path == ranking[r].path && fromList[r].ss_concentrations == ranking[r].ss_concentrations;
+            }
+        }
+    }
+    check_equal(true, same);
+    check_equal(true, winner);
+    check_equal(true, listed);
+
+    Network sevenPaths = read_network("data/7paths.txt");
+    Concentrations sevenInitial = read_initial_concentrations(sevenPaths, "data/7paths_concentrations.txt");
+    PathRanking ranking = find_fastest_paths(sevenPaths, Paths({{5, 1}, {3, 4}}), sevenInitial, 1e-2, 2);
+    check_equal(2, (int)ranking.size());
+    check_equal({5, 1}, ranking[0].path);
+    check_equal(3, (int)ranking[0].ss_concentrations.size());
+    std::stringstream out(to_string(sevenPaths, ranking));
+    std::string header, first;
+    std::getline(out, header);
+    std::getline(out, first);
+    check_equal(std::string("rank\trate\treactions\tsteady_state"), header);
+    check_equal(true, first.compare(0, 2, "1\t") == 0 && first.find("\t5 1\t") != std::string::npos);
+    check_equal(0, (int)find_fastest_paths(sevenPaths, Paths({{5, 1}, {3, 4}}), sevenInitial, 1e-2, 0).size());
+}
+
+// every simple path of at most limit reactions, by plain depth-first search
+void naive_simple_paths(const AdjacencyGraph &graph, CompoundID node, CompoundID dest, size_t limit,
+                        std::vector<bool> &onPath, Path &path, Paths &paths)
+{
+    if (node == dest)
+    {
+        paths.push_back(path);
+        return;
+    }
+    if (path.size() == limit)
+    {
+        return;
+    }
+    onPath[node] = true;
+    for (const std::pair<const CompoundID, ReactionID> &pair : graph[node])
+    {
+        if (!onPath[pair.first])
+        {
+            path.push_back(pair.second);
+            naive_simple_paths(graph, pair.first, dest, limit, onPath, path, paths);
+            path.pop_back();
+        }
+    }
+    onPath[node] = false;
+}
+
+void test_near_shortest_paths()
+{
+    print_header("test_near_shortest_paths");
+    Network network = read_network("data/C00025-C00148.txt");
+    std::cerr << "Testing with network C00025-C00148.txt " << std::endl;
+    AdjacencyGraph graph = build_adjacency_graph(network);
+    auto sorted = [](Paths paths)
+    {
+        std::sort(paths.begin(), paths.end());
+        return paths;
+    };
+    bool shortest = true, near = true;
+    for (CompoundID src = 0; src < (CompoundID)graph.size(); ++src)
+    {
+        BFS result = bfs(graph, src);
+        for (CompoundID dest = 0; dest < (CompoundID)graph.size(); ++dest)
+        {
+            if (result.distances[dest] == INT_MAX)
+            {
+                near = near && find_near_shortest_paths(graph, src, dest, 2).empty();
+                continue;
+            }
+            shortest = shortest && sorted(find_near_shortest_paths(graph, src, dest, 0)) == sorted(find_all_shortest_paths(graph, src, dest));
+            if (src % 4 == 0)
+            {
+                for (size_t slack = 1; slack <= 2; ++slack)
+                {
+                    Paths expected;
+                    Path path;
+                    std::vector<bool> onPath(graph.size(), false);
+                    naive_simple_paths(graph, src, dest, result.distances[dest] + slack, onPath, path, expected);
+                    near = near && sorted(find_near_shortest_paths(graph, src, dest, slack)) == sorted(expected);
+                }
+            }
+        }
+    }
+    check_equal(true, shortest);
+    check_equal(true, near);
+
+    // SEVEN_PATH_ADJACENCY: 0 -> 4 has 3 paths of 3 reactions and more with a detour
+    NearShortestStats stats;
+    size_t seen = 0;
+    auto firstFive = [&](const Path &)
+    {
+        return ++seen < 5;
+    };
+    uint64_t streamed = for_each_near_shortest_path(SEVEN_PATH_ADJACENCY, 0, 4, 2, firstFive, &stats);
+    check_equal(5, (int)streamed);
+    check_equal(5, (int)seen);
+    check_equal(1, (int)find_near_shortest_paths(SEVEN_PATH_ADJACENCY, 2, 2, 3).size());
+}
+
+void test_graph_view()
+{
+    print_header("test_graph_view");
+    Network network = read_network("data/C00025-C00148.txt");
+    std::cerr << "Testing with network C00025-C00148.txt " << std::endl;
+    AdjacencyGraph graph = build_adjacency_graph(network);
+
+    CompoundMask none(graph.size());
+    GraphView unfiltered = {&graph, &none};
+    check_equal(bfs(graph, 0), bfs(unfiltered, 0));
+
+    CompoundMask hubs = mask_by_degree(graph, 4);
+    check_equal(true, hubs.count() > 0 && hubs.count() < graph.size());
+    GraphView view = {&graph, &hubs};
+    Concentrations initial = read_initial_concentrations(network, "data/C00025-C00148_concentrations.txt");
+    PathSet set;
+    ScratchArena arena;
+    QueryWorkspace workspace;
+    CompactBFS compact;
+    bool same = true, engines = true;
+    for (CompoundID src = 0; src < (CompoundID)graph.size(); ++src)
+    {
+        for (CompoundID dest = 0; dest < (CompoundID)graph.size(); ++dest)
+        {
+            // the filtered graph, built by hand: masked compounds lose their links unless they are an endpoint
+            AdjacencyGraph filtered = graph;
+            for (CompoundID c = 0; c < (CompoundID)graph.size(); ++c)
+            {
+                if (hubs.excluded(c) && c != src && c != dest)
+                {
+                    for (const std::pair<const CompoundID, ReactionID> &pair : graph[c])
+                    {
+                        filtered[pair.first].erase(c);
+                    }
+                    filtered[c].clear();
+                }
+            }
+            BFS expected = bfs(filtered, src);
+            same = same && bfs(view, src, dest).distances == expected.distances;
+            Paths all = find_all_shortest_paths(view, src, dest);
+            same = same && all == find_all_shortest_paths(filtered, src, dest);
+            same = same && find_shortest_path(view, src, dest) == find_shortest_path(filtered, src, dest);
+            same = same && to_paths(build_shortest_path_dag(view, src, dest)) == all;
+            if (src % 8 == 0)
+            {
+                same = same && find_near_shortest_paths(view, src, dest, 1) == find_near_shortest_paths(filtered, src, dest, 1);
+            }
+
+            // the other engines' view overloads answer like the view's own searches
+            BFS result = bfs(view, src, dest);
+            compact_bfs(view, src, dest, compact);
+            engines = engines && parallel_bfs(view, src, dest, 2) == result && compact.to_bfs() == result;
+            find_all_shortest_paths(view, src, dest, set, arena);
+            engines = engines && set.to_paths() == all;
+            if (src % 8 == 0)
+            {
+                engines = engines && find_fastest_path(view, network, src, dest, initial, 1e-3, workspace).to_path() ==
+                                         find_fastest_path(network, all, initial, 1e-3);
+            }
+        }
+    }
+    check_equal(true, same);
+    check_equal(true, engines);
+
+    // masking the two compounds of the middle of 0 -> 4 in SEVEN_PATH_ADJACENCY leaves only 0 - 1 - 2 - 4
+    auto isMiddle = [](CompoundID c)
+    {
+        return c == 3 || c == 5;
+    };
+    CompoundMask middle = mask_by_predicate(7, isMiddle);
+    check_equal(2, (int)middle.count());
+    GraphView seven = {&SEVEN_PATH_ADJACENCY, &middle};
+    check_equal(Paths({{0, 1, 4}}), find_all_shortest_paths(seven, 0, 4));
+    // a masked endpoint can still be queried
+    check_equal(1, (int)find_all_shortest_paths(seven, 0, 3).size());
+
+    Network sevenPaths = read_network("data/7paths.txt");
+    CompoundMask named = mask_by_names(sevenPaths, {sevenPaths.compounds[3], "not a compound"});
+    check_equal(1, (int)named.count());
+    named |= middle;
+    check_equal(2, (int)named.count());
+    named.include(5);
+    check_equal(false, named.excluded(5));
+}
+
+void test_allocation_tracking()
+{
+    print_header("test_allocation_tracking");
+    uint64_t allocations;
+    {
+        AllocationScope scope;
+        int *value = new int(1);
+        delete value;
+        allocations = scope.counters().allocations;
+    }
+    check_equal(1, (int)allocations);
+
+    AdjacencyGraph seven(SEVEN_PATH_ADJACENCY);
+    ReactionID reaction;
+    {
+        AllocationScope scope;
+        reaction = find_reactionID(seven, 0, 1);
+        allocations = scope.counters().allocations;
+    }
+    check_equal(0, reaction);
+    check_equal(0, (int)allocations);
+
+    Network network = read_network("data/C00025-C00148.txt");
+    Concentrations initial = read_initial_concentrations(network, "data/C00025-C00148_concentrations.txt");
+    AdjacencyGraph graph = build_adjacency_graph(network);
+    CompoundID src = 0, dest = 32;
+    uint64_t bfsAllocations, allPathsAllocations, fastestAllocations;
+    Paths paths;
+    {
+        AllocationScope scope;
+        bfs(graph, src);
+        bfsAllocations = scope.counters().allocations;
+        paths = find_all_shortest_paths(graph, src, dest);
+        allPathsAllocations = scope.counters().allocations - bfsAllocations;
+        find_fastest_path(network, paths, initial, 1e-2);
+        fastestAllocations = scope.counters().allocations - bfsAllocations - allPathsAllocations;
+    }
+    std::cerr << "allocations per call: bfs " << bfsAllocations
+              << ", find_all_shortest_paths " << allPathsAllocations
+              << ", find_fastest_path (" << paths.size() << " paths) " << fastestAllocations << std::endl;
+
+    // one pass to warm the workspace up, a second one must not allocate
+    std::vector<std::pair<CompoundID, CompoundID>> queries;
+    Paths expected;
+    for (CompoundID from = 0; from < (CompoundID)graph.size(); from += 7)
+    {
+        for (CompoundID to = 0; to < (CompoundID)graph.size(); to += 5)
+        {
+            if (from != to)
+            {
+                queries.push_back({from, to});
+                expected.push_back(find_fastest_path(network, find_all_shortest_paths(graph, from, to), initial, 1e-2));
+            }
+        }
+    }
+    QueryWorkspace workspace;
+    bool same = true;
+    for (size_t i = 0; i < queries.size(); ++i)
+    {
+        PathView fastest = find_fastest_path(graph, network, queries[i].first, queries[i].second, initial, 1e-2, workspace);
+        same = same && fastest.to_path() == expected[i];
+    }
+    check_equal(true, same);
+    {
+        AllocationScope scope;
+        for (size_t i = 0; i < queries.size(); ++i)
+        {
+            PathView fastest = find_fastest_path(graph, network, queries[i].first, queries[i].second, initial, 1e-2, workspace);
+            same = same && std::equal(fastest.begin(), fastest.end(), expected[i].begin(), expected[i].end());
+        }
+        allocations = scope.counters().allocations;
+    }
+    check_equal(true, same);
+    check_equal(0, (int)allocations);
+}
+
+void test_differential_fuzz()
+{
+    print_header("test_differential_fuzz");
+    FuzzReport report = run_fuzz(1, 100, differential_properties());
+    for (const FuzzFailure &failure : report.failures)
+    {
+        std::cerr << failure.property << " failed on seed " << failure.original.seed << ": " << failure.message << std::endl;
+        write_case(failure.shrunk, std::cerr, std::cerr);
+    }
+    check_equal(100, (int)report.cases);
+    check_equal(0, (int)report.failures.size());
+
+    // the same seed gives the same case
+    FuzzCase c = generate_case(7);
+    check_equal(true, generate_case(7).network.reactions.size() == c.network.reactions.size() && generate_case(7).initial == c.initial);
+    std::stringstream networkFile, concentrationsFile;
+    write_case(c, networkFile, concentrationsFile);
+    Network replayed = read_network(networkFile);
+    check_equal(build_adjacency_graph(c.network), build_adjacency_graph(replayed), c.network);
+    check_equal(true, read_initial_concentrations(replayed, concentrationsFile) == c.initial);
+
+    // a property failing whenever the query has two shortest paths: every shrunk case
+    // must pass once any of its reactions is removed, and the smallest is a square
+    auto single = [](const FuzzCase &fuzzCase)
+    {
+        return find_all_shortest_paths(build_adjacency_graph(fuzzCase.network), fuzzCase.src, fuzzCase.dest).size() > 1 ? std::string("ties") : std::string();
+    };
+    FuzzReport ties = run_fuzz(1, 20, {{"single", single}});
+    check_equal(true, !ties.failures.empty());
+    bool minimal = true, square = false;
+    for (const FuzzFailure &failure : ties.failures)
+    {
+        minimal = minimal && failure.message == "ties" && failure.shrunk.network.reactions.size() < failure.original.network.reactions.size();
+        for (size_t r = 0; r < failure.shrunk.network.reactions.size(); ++r)
+        {
+            FuzzCase smaller = failure.shrunk;
+            smaller.network.reactions.erase(smaller.network.reactions.begin() + r);
+            minimal = minimal && single(smaller).empty();
+        }
+        square = square || (failure.shrunk.network.reactions.size() == 4 && failure.shrunk.network.compounds.size() == 4);
+    }
+    check_equal(true, minimal);
+    check_equal(true, square);
+}
+
+void test_stream_io()
+{
+    print_header("test_stream_io");
+    BFS small = {0, {{-1}, {0}, {0, 1}}, {0, 1, 1}};
+    check_equal(std::string("start:0\nNode0: {-1 }, distance : 0\nNode1: {0 }, distance : 1\nNode2: {0 1 }, distance : 1\n"), to_string(small));
+    check_equal(std::string("Path Number 1 - Reactions: 5 1 \nPath Number 2 - Reactions: \n"), to_string(Paths({{5, 1}, {}})));
+    check_equal(std::string("0 = 0.312\n3 = 1.23457e-07\n4 = 0\n"), to_string(Concentrations({{0, 0.312}, {3, 1.234567e-7}, {4, 0.0}})));
+
+    // a tiny buffer flushes on almost every write and must give the same text
+    std::string expected, computed;
+    {
+        OutputSink large(expected);
+        OutputSink tiny(computed, 1);
+        for (int i = -1000; i < 1000; ++i)
+        {
+            large << i << ' ' << i / 7.0 << ' ' << "text" << '\n';
+            tiny << i << ' ' << i / 7.0 << ' ' << "text" << '\n';
+        }
+    }
+    check_equal(expected, computed);
+    bool roundTrip = true;
+    for (double value : {0.1, 1.0 / 3.0, 6.02214076e23, -2.5e-310, 1e300})
+    {
+        std::string text;
+        {
+            OutputSink out(text);
+            out.write_double(value);
+        }
+        roundTrip = roundTrip && std::strtod(text.c_str(), nullptr) == value;
+    }
+    check_equal(true, roundTrip);
+
+    Network network = read_network("data/C00025-C00148.txt");
+    std::cerr << "Testing with network C00025-C00148.txt " << std::endl;
+    AdjacencyGraph graph = build_adjacency_graph(network);
+    PathSet paths;
+    for (CompoundID dest = 1; dest < (CompoundID)graph.size(); dest += 3)
+    {
+        for (const Path &path : find_all_shortest_paths(graph, 0, dest))
+        {
+            paths.push_back(path);
+        }
+    }
+    paths.push_back(Path());
+    size_t sizes[3];
+    for (PathFormat format : {FORMAT_TEXT, FORMAT_CSV, FORMAT_BINARY})
+    {
+        std::stringstream file;
+        {
+            OutputSink out(file);
+            write_paths(out, paths, format);
+        }
+        sizes[format] = file.str().size();
+        PathSet read;
+        read_paths(file, read, format);
+        check_equal(paths.to_paths(), read.to_paths());
+    }
+    std::cerr << "bytes: text " << sizes[FORMAT_TEXT] << ", csv " << sizes[FORMAT_CSV] << ", binary " << sizes[FORMAT_BINARY] << std::endl;
+    check_equal(true, sizes[FORMAT_BINARY] * 2 < sizes[FORMAT_CSV] && sizes[FORMAT_CSV] < sizes[FORMAT_TEXT]);
+
+    std::stringstream binary;
+    {
+        OutputSink out(binary);
+        write_paths_binary(out, paths);
+    }
+    std::stringstream truncated(binary.str().substr(0, binary.str().size() / 2));
+    PathSet read;
+    bool thrown = false;
+    try
+    {
+        read_paths(truncated, read, FORMAT_BINARY);
+    }
+    catch (const std::runtime_error &)
+    {
+        thrown = true;
+    }
+    check_equal(true, thrown);
+    std::stringstream notCsv("Reactions: 1 2\n");
+    thrown = false;
+    try
+    {
+        read_paths(notCsv, read, FORMAT_CSV);
+    }
+    catch (const std::runtime_error &)
+    {
+        thrown = true;
+    }
+    check_equal(true, thrown);
+}
+
+void test_sharded_queries()
+{
+    print_header("test_sharded_queries");
+    Network network = read_network("data/C00025-C00148.txt");
+    Concentrations initial = read_initial_concentrations(network, "data/C00025-C00148_concentrations.txt");
+    std::cerr << "Testing with network C00025-C00148.txt " << std::endl;
+    AdjacencyGraph graph = build_adjacency_graph(network);
+    Partition partition = partition_graph(graph, 3);
+    bool covered = partition.owner.size() == graph.size();
+    size_t total = 0;
+    for (unsigned part = 0; part < partition.parts; ++part)
+    {
+        covered = covered && partition.sizes[part] > 0 && partition.sizes[part] <= std::ceil(1.05 * graph.size() / 3);
+        total += partition.sizes[part];
+    }
+    check_equal(true, covered && total == graph.size());
+    check_equal(true, edge_cut(graph, partition) <= edge_cut(graph, hash_partition(graph.size(), 3)));
+
+    bool same = true, paths = true, fastest = true;
+    {
+        ShardCluster cluster(network, initial, partition, TRANSPORT_IN_PROCESS);
+        for (CompoundID src = 0; src < (CompoundID)graph.size(); ++src)
+        {
+            BFS expected = bfs(graph, src);
+            BFS computed = distributed_bfs(cluster, src);
+            same = same && expected.parents == computed.parents && expected.distances == computed.distances;
+            for (CompoundID dest = 0; dest < (CompoundID)graph.size(); dest += 2)
+            {
+                if (dest == src || expected.distances[dest] == INT_MAX)
+                {
+                    continue;
+                }
+                PathSet set;
+                ScratchArena arena;
+                find_all_shortest_paths(graph, src, dest, set, arena);
+                paths = paths && distributed_shortest_paths(cluster, src, dest) == set.to_paths();
+                ShardedFastestPath answer = distributed_fastest_path(cluster, src, dest, 1e-2);
+                Path path = find_fastest_path(network, set, initial, 1e-2).to_path();
+                CompiledPath compiled = compile_path(network, path);
+                PathState state = initial_path_state(compiled, initial);
+                solve_ss_state(compiled, state, 1e-2);
+                fastest = fastest && answer.path == path && answer.rate == compute_path_rate(compiled, state) && answer.paths == set.size();
+            }
+        }
+    }
+    check_equal(true, same);
+    check_equal(true, paths);
+    check_equal(true, fastest);
+
+    // the same queries across forked shard processes
+    same = true;
+    {
+        ShardCluster cluster(network, initial, partition, TRANSPORT_SOCKET);
+        for (CompoundID src = 0; src < (CompoundID)graph.size(); src += 5)
+        {
+            BFS expected = bfs(graph, src);
+            BFS computed = distributed_bfs(cluster, src);
+            same = same && expected.parents == computed.parents && expected.distances == computed.distances;
+        }
+        CompoundID dest = (CompoundID)graph.size() - 1;
+        check_equal(find_all_shortest_paths(graph, 0, dest), distributed_shortest_paths(cluster, 0, dest));
+        check_equal(true, cluster.stats().messages > 0);
+    }
+    check_equal(true, same);
+
+    // more parts than a chain has compounds: some shards own nothing
+    Network chain;
+    for (CompoundID c = 0; c < 5; ++c)
+    {
+        chain.compounds.push_back("C" + std::to_string(c));
+        if (c > 0)
+        {
+            chain.reactions.push_back({{c - 1, c}, 5.0, 1.0, 0.5, 0.5});
+        }
+    }
+    AdjacencyGraph chainGraph = build_adjacency_graph(chain);
+    Concentrations chainInitial = {{0, 1.0}, {1, 0.5}, {2, 0.5}, {3, 0.5}, {4, 0.5}};
+    same = true;
+    for (const Partition &sparse : {partition_graph(chainGraph, 4), hash_partition(5, 8)})
+    {
+        ShardCluster cluster(chain, chainInitial, sparse, TRANSPORT_IN_PROCESS);
+        for (CompoundID src = 0; src < 5; ++src)
+        {
+            BFS expected = bfs(chainGraph, src);
+            BFS computed = distributed_bfs(cluster, src);
+            same = same && expected.parents == computed.parents && expected.distances == computed.distances;
+        }
+        same = same && distributed_shortest_paths(cluster, 0, 4) == find_all_shortest_paths(chainGraph, 0, 4);
+    }
+    check_equal(true, same);
+}
+
+void test_mixed_precision_screening()
+{
+    print_header("test_mixed_precision_screening");
+    Network network = read_network("data/C00025-C00148.txt");
+    Concentrations initial = read_initial_concentrations(network, "data/C00025-C00148_concentrations.txt");
+    std::cerr << "Testing with network C00025-C00148.txt " << std::endl;
+    AdjacencyGraph graph = build_adjacency_graph(network);
+    PathSet all;
+    ScratchArena arena;
+    bool same = true, fallback = true;
+    size_t candidates = 0, refined = 0;
+    double worst = 0;
+    for (CompoundID src = 0; src < (CompoundID)graph.size(); ++src)
+    {
+        BFS result = bfs(graph, src);
+        for (CompoundID dest = 0; dest < (CompoundID)graph.size(); ++dest)
+        {
+            if (dest == src || result.distances[dest] == INT_MAX)
+            {
+                continue;
+            }
+            PathSet paths;
+            find_all_shortest_paths(graph, src, dest, paths, arena);
+            // screening every group, however small, then with the default fallback
+            ScreeningOptions everyGroup = DEFAULT_SCREENING;
+            everyGroup.min_group = 1;
+            ScreeningStats stats;
+            PathView expected = find_fastest_path(network, paths, initial, 1e-2);
+            same = same && find_fastest_path_screened(network, paths, initial, 1e-2, everyGroup, &stats).data == expected.data;
+            candidates += stats.candidates;
+            refined += stats.refined;
+            same = same && find_fastest_path_screened(network, paths, initial, 1e-2, DEFAULT_SCREENING, &stats).data == expected.data;
+            fallback = fallback && stats.direct + stats.refined <= stats.candidates &&
+                       (paths.size() >= DEFAULT_SCREENING.min_group || stats.direct == paths.size());
+            for (size_t i = 0; i < paths.size(); ++i)
+            {
+                all.push_back(paths[i].data, paths[i].length);
+            }
+        }
+    }
+    check_equal(true, same);
+    check_equal(true, fallback);
+    check_equal(true, refined < candidates);
+
+    // double lanes at DELTA reproduce the scalar solver, float lanes stay close to it
+    std::vector<double> exact, screened;
+    std::vector<bool> converged;
+    screen_path_rates<double>(network, all, initial, 1e-2, DELTA, SIZE_MAX, exact, converged);
+    screen_path_rates<float>(network, all, initial, 1e-2, DEFAULT_SCREENING.tolerance, SIZE_MAX, screened, converged);
+    SteadyStateWorkspace workspace;
+    bool bitwise = true;
+    for (size_t i = 0; i < all.size(); ++i)
+    {
+        double rate = steady_state_rate(network, all[i].data, all[i].length, initial, 1e-2, workspace);
+        bitwise = bitwise && exact[i] == rate;
+        worst = std::max(worst, std::fabs(screened[i] - rate) / std::fabs(rate));
+    }
+    std::cerr << candidates << " candidates, " << refined << " refined, worst screening error " << worst << std::endl;
+    check_equal(true, bitwise);
+    check_equal(true, worst < DEFAULT_SCREENING.margin / 2);
+
+    // a product stuck at 0 is stable at once, as in solve_ss_state
+    Network drained;
+    drained.compounds = {"A", "B"};
+    drained.reactions.push_back({{0, 1}, 0.0, 1.0, 1.0, 1.0});
+    Concentrations drainedInitial = {{0, 1.0}, {1, 0.0}};
+    PathSet single;
+    ReactionID reaction = 0;
+    single.push_back(&reaction, 1);
+    screen_path_rates<double>(drained, single, drainedInitial, 1e-2, DELTA, 10, exact, converged);
+    check_equal(true, converged[0] && exact[0] == steady_state_rate(drained, &reaction, 1, drainedInitial, 1e-2, workspace));
+    ScreeningStats stats;
+    find_fastest_path_screened(drained, single, drainedInitial, 1e-2, DEFAULT_SCREENING, &stats);
+    check_equal(0, (int)stats.unconverged);
+}
+
+void test_comparative_pipeline()
+{
+    print_header("test_comparative_pipeline");
+    std::vector<NetworkSource> sources = list_networks("../data");
+    check_equal(3, (int)sources.size());
+    check_equal(std::string("7paths C00025-C00148 basic"), sources[0].name + " " + sources[1].name + " " + sources[2].name);
+
+    // same networks as read_network, the names going through the dictionary
+    CompoundDictionary dictionary;
+    bool same = true;
+    size_t compounds = 0;
+    for (const NetworkSource &source : sources)
+    {
+        std::ifstream networkFile(source.network_file), concentrationsFile(source.concentrations_file);
+        Network network = read_network(networkFile);
+        Concentrations initial = read_initial_concentrations(network, concentrationsFile);
+        std::stringstream networkText, concentrationsText;
+        networkText << std::ifstream(source.network_file).rdbuf();
+        concentrationsText << std::ifstream(source.concentrations_file).rdbuf();
+        InternedNetwork parsed;
+        parse_interned_network(networkText.str(), concentrationsText.str(), dictionary, parsed);
+        same = same && parsed.network.compounds.size() == network.compounds.size() && parsed.concentrations == initial &&
+               parsed.network.reactions.size() == network.reactions.size();
+        for (size_t c = 0; same && c < network.compounds.size(); ++c)
+        {
+            same = dictionary.name(parsed.global_ids[c]) == network.compounds[c];
+        }
+        for (size_t r = 0; same && r < network.reactions.size(); ++r)
+        {
+            const Reaction &a = network.reactions[r], &b = parsed.network.reactions[r];
+            same = a.compounds == b.compounds && a.V_plus == b.V_plus && a.V_minus == b.V_minus && a.K_S == b.K_S && a.K_P == b.K_P;
+        }
+        compounds += network.compounds.size();
+    }
+    check_equal(true, same);
+    // C00025 and C00148 are in two of the networks
+    check_equal(true, dictionary.size() < compounds);
+
+    std::vector<ComparativeQuery> queries = {{"C00025", "C00148"}, {"C0", "C5"}, {"C00097", "C00049"}, {"C00025", "C00025"}, {"unknown", "C0"}};
+    PipelineStats stats;
+    ComparisonMatrix matrix = run_comparative_pipeline(sources, queries, dictionary, DEFAULT_PIPELINE, &stats);
+    bool expected = true;
+    for (size_t organism = 0; organism < sources.size(); ++organism)
+    {
+        std::ifstream networkFile(sources[organism].network_file), concentrationsFile(sources[organism].concentrations_file);
+        Network network = read_network(networkFile);
+        Concentrations initial = read_initial_concentrations(network, concentrationsFile);
+        AdjacencyGraph graph = build_adjacency_graph(network);
+        for (size_t q = 0; q < queries.size(); ++q)
+        {
+            size_t entry = organism * queries.size() + q;
+            CompoundID src = find_compoundID(network, queries[q].source);
+            CompoundID dest = find_compoundID(network, queries[q].destination);
+            int distance = src < 0 || dest < 0 ? INT_MAX : bfs(graph, src).distances[dest];
+            if (distance == INT_MAX)
+            {
+                expected = expected && matrix.distances[entry] == -1 && matrix.path_counts[entry] == 0 && std::isnan(matrix.rates[entry]);
+                continue;
+            }
+            Paths paths = find_all_shortest_paths(graph, src, dest);
+            expected = expected && matrix.distances[entry] == distance && matrix.path_counts[entry] == paths.size();
+            if (distance > 0)
+            {
+                Path fastest = find_fastest_path(network, paths, initial, 1e-2);
+                SteadyStateWorkspace workspace;
+                expected = expected && matrix.rates[entry] == steady_state_rate(network, fastest.data(), fastest.size(), initial, 1e-2, workspace);
+            }
+        }
+    }
+    check_equal(true, expected);
+    check_equal(true, matrix.distances[1 * queries.size()] > 0 && matrix.distances[2 * queries.size() + 1] > 0);
+    check_equal(3, (int)stats.networks);
+
+    // one network at a time gives the same matrix
+    ComparisonMatrix serial = run_comparative_pipeline(sources, queries, dictionary, {1, 1e-2}, &stats);
+    check_equal(1, (int)stats.peak_in_flight);
+    check_equal(true, serial.distances == matrix.distances && serial.path_counts == matrix.path_counts);
+
+    std::stringstream manifest("# organism, network, concentrations\nbasic basic.txt basic_concentrations.txt\n\nbroken missing.txt missing_concentrations.txt\n");
+    std::vector<NetworkSource> listed = read_manifest(manifest, "../data/");
+    check_equal(std::string("../data/basic_concentrations.txt"), listed[0].concentrations_file);
+    matrix = run_comparative_pipeline(listed, queries, dictionary);
+    check_equal(true, matrix.errors[0].empty() && !matrix.errors[1].empty());
+    std::string text;
+    {
+        OutputSink out(text);
+        write_comparison(out, matrix);
+    }
+    check_equal(3, (int)std::count(text.begin(), text.end(), '\n'));
+    check_equal(std::string("broken\t-\t-\t-"), text.substr(text.rfind("broken"), 12));
+}
+
+void test_auto_time_step()
+{
+    print_header("test_auto_time_step");
+    bool bounded = true, close = true;
+    size_t autoIterations = 0, fixedIterations = 0;
+    double worst = 0;
+    for (std::string name : {"basic", "7paths", "C00025-C00148"})
+    {
+        Network network = read_network("data/" + name + ".txt");
+        Concentrations initial = read_initial_concentrations(network, "data/" + name + "_concentrations.txt");
+        std::cerr << "Testing with network " << name << ".txt " << std::endl;
+        AdjacencyGraph graph = build_adjacency_graph(network);
+        for (CompoundID src = 0; src < (CompoundID)graph.size(); ++src)
+        {
+            BFS result = bfs(graph, src);
+            for (CompoundID dest = 0; dest < (CompoundID)graph.size(); ++dest)
+            {
+                if (result.distances[dest] == INT_MAX || result.distances[dest] == 0)
+                {
+                    continue;
+                }
+                CompiledPath compiled = compile_path(network, find_shortest_path(graph, src, dest));
+                PathState initialState = initial_path_state(compiled, initial), scratch;
+
+                // the bound covers every column sum of a finite difference Jacobian
+                PathState F(initialState.size()), shifted(initialState.size()), next(initialState.size());
+                euler_step(compiled, initialState, F, 1.0);
+                double bound = jacobian_spectral_bound(compiled, initialState);
+                for (size_t k = 0; k < initialState.size(); ++k)
+                {
+                    shifted = initialState;
+                    double h = 1e-6 * (1.0 + shifted[k]);
+                    shifted[k] += h;
+                    euler_step(compiled, shifted, next, 1.0);
+                    double column = 0;
+                    for (size_t i = 0; i < next.size(); ++i)
+                    {
+                        column += std::fabs((next[i] - shifted[i]) - (F[i] - initialState[i])) / h;
+                    }
+                    bounded = bounded && column <= bound * (1 + 1e-4);
+                }
+
+                PathState fixedState = initialState, autoState = initialState;
+                fixedIterations += solve_ss_state(compiled, fixedState, scratch, 1e-2);
+                double dt;
+                autoIterations += solve_ss_state_auto(compiled, autoState, scratch, 1.0, 16, &dt);
+                close = close && std::fabs(dt * jacobian_spectral_bound(compiled, autoState) - 1.0) < 1e-2;
+                double fixedRate = compute_path_rate(compiled, fixedState);
+                worst = std::max(worst, std::fabs(compute_path_rate(compiled, autoState) - fixedRate) / std::fabs(fixedRate));
+            }
+        }
+    }
+    std::cerr << "dt = 1e-2: " << fixedIterations << " steps, auto: " << autoIterations << " steps, worst rate difference " << worst << std::endl;
+    check_equal(true, bounded);
+    check_equal(true, close);
+    // both stop on a relative change per step under DELTA, so they stop at different distances from the steady state
+    check_equal(true, worst < 1e-3);
+    check_equal(true, autoIterations < fixedIterations);
+
+    // AUTO_DT goes through the same solver in compute_ss_concentration and find_fastest_path
+    Network network = read_network("data/basic.txt");
+    Concentrations initial = read_initial_concentrations(network, "data/basic_concentrations.txt");
+    Paths paths = find_all_shortest_paths(build_adjacency_graph(network), find_compoundID(network, "C0"), find_compoundID(network, "C5"));
+    Concentrations ss = compute_ss_concentration(network, paths[0], initial, AUTO_DT);
+    check_equal(true, std::fabs(compute_path_rate(network, paths[0], ss) -
+                                compute_path_rate(network, paths[0], compute_ss_concentration(network, paths[0], initial, 1e-2))) < 1e-3);
+    check_equal(true, find_fastest_path(network, paths, initial, AUTO_DT) == find_fastest_path(network, paths, initial, 1e-2));
+
+    // every engine takes AUTO_DT through solve_ss_state
+    network = read_network("data/C00025-C00148.txt");
+    initial = read_initial_concentrations(network, "data/C00025-C00148_concentrations.txt");
+    AdjacencyGraph graph = build_adjacency_graph(network);
+    bool engines = true, lanes = true;
+    SteadyStateWorkspace workspace;
+    for (CompoundID src = 0; src < (CompoundID)graph.size(); src += 3)
+    {
+        BFS result = bfs(graph, src);
+        for (CompoundID dest = 0; dest < (CompoundID)graph.size(); dest += 2)
+        {
+            if (dest == src || result.distances[dest] == INT_MAX)
+            {
+                continue;
+            }
+            paths = find_all_shortest_paths(graph, src, dest);
+            Path expected = find_fastest_path(network, paths, initial, AUTO_DT);
+            CompiledPath compiled = compile_path(network, expected);
+            PathState autoState = initial_path_state(compiled, initial), state = autoState, fixed = autoState, scratch;
+            solve_ss_state_auto(compiled, autoState, scratch);
+            solve_ss_state(compiled, state, AUTO_DT);
+            solve_ss_state_fixed(compiled, fixed, AUTO_DT);
+            engines = engines && state == autoState && fixed == autoState;
+
+            ShortestPathDag dag = build_shortest_path_dag(graph, src, dest);
+            PathRanking ranking = find_fastest_paths(network, dag, initial, AUTO_DT, 1);
+            PathSet set;
+            ScratchArena arena;
+            find_all_shortest_paths(graph, src, dest, set, arena);
+            engines = engines && find_fastest_path(network, dag, initial, AUTO_DT) == expected &&
+                      ranking[0].path == expected && ranking[0].rate == compute_path_rate(compiled, autoState) &&
+                      find_fastest_path_parallel(network, dag, initial, AUTO_DT, 2) == expected &&
+                      find_fastest_path_screened(network, set, initial, AUTO_DT).to_path() == expected;
+
+            std::vector<double> rates;
+            std::vector<bool> converged;
+            screen_path_rates<double>(network, set, initial, AUTO_DT, DELTA, SIZE_MAX, rates, converged);
+            for (size_t i = 0; i < set.size(); ++i)
+            {
+                lanes = lanes && rates[i] == steady_state_rate(network, set[i].data, set[i].length, initial, AUTO_DT, workspace);
+            }
+        }
+    }
+    check_equal(true, engines);
+    check_equal(true, lanes);
+}
+
+void test_directed_search_graph()
+{
+    print_header("test_directed_search_graph");
+    Network network = read_network("data/basic.txt");
+    // C0 -> C1: V+ / K_S = 5.93 / 0.90, V- / K_P = 6.97 / 0.53
+    check_equal(true, std::fabs(feasibility(network.reactions[0], true) - 0.3338) < 1e-4);
+    check_equal(true, std::fabs(feasibility(network.reactions[0], true) + feasibility(network.reactions[0], false) - 1.0) < 1e-12);
+
+    bool same = true, feasible = true, dagCounts = true;
+    size_t undirectedCandidates = 0, directedCandidates = 0;
+    for (std::string name : {"basic", "7paths", "C00025-C00148"})
+    {
+        network = read_network("data/" + name + ".txt");
+        std::cerr << "Testing with network " << name << ".txt " << std::endl;
+        AdjacencyGraph graph = build_adjacency_graph(network);
+        DirectedSearchGraph directed = build_directed_search_graph(network);
+        size_t edges = 0;
+        for (const std::map<CompoundID, ReactionID> &neighbours : graph)
+        {
+            edges += neighbours.size();
+        }
+        check_equal((int)edges, (int)count_feasible_edges(directed, 0.0));
+        check_equal(true, count_feasible_edges(directed, DEFAULT_MIN_FEASIBILITY) < edges);
+        for (CompoundID src = 0; src < (CompoundID)graph.size(); ++src)
+        {
+            for (CompoundID dest = 0; dest < (CompoundID)graph.size(); ++dest)
+            {
+                // a threshold of 0 keeps every edge: the undirected results
+                Paths all = find_all_shortest_paths(graph, src, dest);
+                same = same && find_all_shortest_paths(directed, src, dest, 0.0) == all &&
+                       find_shortest_path(directed, src, dest, 0.0) == find_shortest_path(graph, src, dest);
+
+                Paths pruned = find_all_shortest_paths(directed, src, dest);
+                BFS result = bfs(directed, src);
+                for (const Path &path : pruned)
+                {
+                    CompoundID at = src;
+                    for (ReactionID r : path)
+                    {
+                        const Reaction &reaction = network.reactions[r];
+                        bool forward = reaction.compounds.first == at;
+                        feasible = feasible && feasibility(reaction, forward) >= DEFAULT_MIN_FEASIBILITY;
+                        at = forward ? reaction.compounds.second : reaction.compounds.first;
+                    }
+                    feasible = feasible && at == dest;
+                }
+                if (result.distances[dest] != INT_MAX && src != dest)
+                {
+                    ShortestPathDag dag = build_shortest_path_dag(directed, result, dest);
+                    dagCounts = dagCounts && count_paths(dag) == pruned.size() && to_paths(dag) == pruned;
+                }
+                undirectedCandidates += all.size();
+                directedCandidates += pruned.size();
+            }
+        }
+    }
+    std::cerr << undirectedCandidates << " candidate paths, " << directedCandidates << " along feasible edges" << std::endl;
+    check_equal(true, same);
+    check_equal(true, feasible);
+    check_equal(true, dagCounts);
+    check_equal(true, directedCandidates < undirectedCandidates);
+
+    // parallel reactions: A -> B barely runs backwards, B -> A carries that flux
+    Network parallel;
+    parallel.compounds = {"A", "B"};
+    parallel.reactions.push_back({{0, 1}, 5.0, 1e-6, 1.0, 1.0});
+    parallel.reactions.push_back({{1, 0}, 5.0, 1e-6, 1.0, 1.0});
+    DirectedSearchGraph both = build_directed_search_graph(parallel);
+    check_equal(Path({0}), find_shortest_path(both, 0, 1));
+    check_equal(Path({1}), find_shortest_path(both, 1, 0));
+    check_equal(2, (int)count_feasible_edges(both, 0.99));
+    // the DAG names the reaction the search ran, not the adjacency graph's
+    check_equal(Paths({{1}}), to_paths(build_shortest_path_dag(both, bfs(both, 1), 0)));
+    check_equal(Paths({{0}}), to_paths(build_shortest_path_dag(both, bfs(both, 0), 1)));
+}
+
 // Run all of the unit tests
 void run_unit_tests(int part)
 {
@@ -316,8 +1893,41 @@ void run_unit_tests(int part)
         test_compute_path_rate();
         test_find_fastest_path();
     }
+    else if (part == 4)
+    {
+        // EXTENSIONS
+        test_compiled_path();
+        test_sweep_parameters();
+        test_p2_quantile();
+        test_rank_paths_monte_carlo();
+        test_path_set();
+        test_find_all_shortest_paths_path_set();
+        test_shortest_path_dag();
+        test_fixed_length_kernels();
+        test_michaelis_reversible_rate_batch();
+        test_answer_query();
+        test_query_server();
+        test_distance_oracle();
+        test_components();
+        test_parallel_bfs();
+        test_reorder_network();
+        test_compact_bfs();
+        test_parallel_path_enumeration();
+        test_find_fastest_path_anytime();
+        test_find_fastest_paths();
+        test_near_shortest_paths();
+        test_graph_view();
+        test_allocation_tracking();
+        test_differential_fuzz();
+        test_stream_io();
+        test_sharded_queries();
+        test_mixed_precision_screening();
+        test_comparative_pipeline();
+        test_auto_time_step();
+        test_directed_search_graph();
+    }
     else
     {
-        std::cerr << "Part should be either 1, 2, or 3. Provided part = " << part << std::endl;
+        std::cerr << "Part should be either 1, 2, 3 or 4. Provided part = " << part << std::endl;
     }
 }
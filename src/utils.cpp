@@ -6,6 +6,7 @@
 #include <assert.h>
 // #include <filesystem>
 #include <iostream>
+#include "stream_io.hpp"
 
 double get_random_value()
 {
@@ -17,55 +18,64 @@ Network read_network(std::string network_filename)
     std::ifstream file("../" + network_filename);
     // std::ifstream file(network_filename);
     Network network;
+
+    if (file)
+    {
+        network = read_network(file);
+    }
+    else
+    {
+        std::cout << "File not found: " << network_filename << std::endl;
+        assert(false);
+    }
+    return network;
+}
+
+Network read_network(std::istream &file)
+{
+    Network network;
     int cId(0);
     int rId(0);
 
     std::map<std::string, int> compoundIDs;
 
-    if (file)
+    std::string line;
+    getline(file, line);
+    while (file && line[0] != '-')
     {
-        std::string line;
+        CompoundName c(line);
+        network.compounds.push_back(c);
+        compoundIDs[c] = cId;
+        cId++;
         getline(file, line);
-        while (line[0] != '-')
-        {
-            CompoundName c(line);
-            network.compounds.push_back(c);
-            compoundIDs[c] = cId;
-            cId++;
-            getline(file, line);
-        }
-        while (getline(file, line))
+    }
+    while (getline(file, line))
+    {
+        if (!line.empty() and line[0] != '#' and line[0] != '-')
         {
-            if (!line.empty() and line[0] != '#' and line[0] != '-')
-            {
-                Reaction reac;
-                reac.compounds.first = compoundIDs.at(line);
+            Reaction reac;
+            reac.compounds.first = compoundIDs.at(line);
 
-                getline(file, line);
-                reac.compounds.second = compoundIDs.at(line);
+            getline(file, line);
+            reac.compounds.second = compoundIDs.at(line);
 
-                getline(file, line);
-                reac.V_plus = stod(line);
+            getline(file, line);
+            reac.V_plus = stod(line);
 
-                getline(file, line);
-                reac.V_minus = stod(line);
+            getline(file, line);
+            reac.V_minus = stod(line);
 
-                getline(file, line);
-                reac.K_S = stod(line);
+            getline(file, line);
+            reac.K_S = stod(line);
 
-                getline(file, line);
-                reac.K_P = stod(line);
+            getline(file, line);
+            reac.K_P = stod(line);
 
-                network.reactions.push_back(reac);
-                rId++;
-            }
+            network.reactions.push_back(reac);
+            rId++;
         }
     }
-    else
-    {
-        std::cout << "File not found: " << network_filename << std::endl;
-        assert(false);
-    }
+    network.kinetics = build_kinetic_table(network);
     return network;
 }
 
@@ -94,20 +104,11 @@ std::string to_string(const Reaction &r, bool verbose)
 
 std::string to_string(const BFS &bfs_data_structure)
 {
-    std::stringstream ss;
-    ss << "start:" << bfs_data_structure.start << "\n";
-    auto parents = bfs_data_structure.parents;
-    for (size_t i(0); i < parents.size(); ++i)
-    {
-        ss << "Node" << i << ": {";
-        for (auto parent : parents[i])
-        {
-            ss << parent << " ";
-        }
-        ss << "}, ";
-        ss << "distance : " << bfs_data_structure.distances[i] << "\n";
-    }
-    return ss.str();
+    std::string text;
+    OutputSink out(text);
+    write_bfs(out, bfs_data_structure);
+    out.flush();
+    return text;
 }
 
 std::string to_string(const Network &network, const AdjacencyGraph &graph)
@@ -149,24 +150,20 @@ std::string to_string(const Network &network, bool verbose)
 
 std::string to_string(const Path &path)
 {
-    std::stringstream ss;
-    ss << "Reactions: ";
-    for (auto r : path)
-    {
-        ss << r << " ";
-    }
-    ss << "\n";
-    return ss.str();
+    std::string text;
+    OutputSink out(text);
+    write_path(out, path);
+    out.flush();
+    return text;
 }
 
 std::string to_string(const Paths &paths)
 {
-    std::stringstream ss;
-    for (size_t i(0); i < paths.size(); ++i)
-    {
-        ss << "Path Number " << i + 1 << " - " << to_string(paths[i]);
-    }
-    return ss.str();
+    std::string text;
+    OutputSink out(text);
+    write_paths(out, paths);
+    out.flush();
+    return text;
 }
 
 std::string to_string(const Network &network, const Path &path, bool verbose)
@@ -191,7 +188,7 @@ std::string to_string(const Network &network, const Paths &paths, bool verbose)
 {
     std::stringstream ss;
     size_t k(0);
-    for (auto path : paths)
+    for (const Path &path : paths)
     {
         ss << "Path " << ++k << ":\n";
         ss << to_string(network, path, verbose);
@@ -207,44 +204,50 @@ Concentrations read_initial_concentrations(const Network &network, std::string f
 
     if (file)
     {
-        std::string line;
+        concentrations = read_initial_concentrations(network, file);
+    }
+    else
+    {
+        std::cout << "File not found: " << filename << std::endl;
+        assert(false);
+    }
+    return concentrations;
+}
 
-        while (getline(file, line))
+Concentrations read_initial_concentrations(const Network &network, std::istream &file)
+{
+    Concentrations concentrations;
+    std::string line;
+
+    while (getline(file, line))
+    {
+        if (!line.empty())
         {
-            if (!line.empty())
+            for (size_t i(0); i < line.size(); ++i)
             {
-                for (size_t i(0); i < line.size(); ++i)
+                if (line[i] == '=')
                 {
-                    if (line[i] == '=')
-                    {
-                        std::string name = line.substr(1, i - 2); // fonction remove for the '[' char
-                        double concentration = stod(line.substr(i + 1, line.size() - 1));
-                        int id = find_compoundID(network, name);
-                        if (id >= 0)
-                            concentrations[id] = concentration;
-                        //          if ( id >= 0) concentrations[id] = get_random_value();
-                        else
-                            std::cerr << "Component " << name << " does not exist." << std::endl;
-                        break;
-                    }
+                    std::string name = line.substr(1, i - 2); // fonction remove for the '[' char
+                    double concentration = stod(line.substr(i + 1, line.size() - 1));
+                    int id = find_compoundID(network, name);
+                    if (id >= 0)
+                        concentrations[id] = concentration;
+                    //          if ( id >= 0) concentrations[id] = get_random_value();
+                    else
+                        std::cerr << "Component " << name << " does not exist." << std::endl;
+                    break;
                 }
             }
         }
     }
-    else
-    {
-        std::cout << "File not found: " << filename << std::endl;
-        assert(false);
-    }
     return concentrations;
 }
 
 std::string to_string(const Concentrations &concentrations)
 {
-    std::stringstream ss;
-    for (auto element : concentrations)
-    {
-        ss << element.first << " = " << element.second << std::endl;
-    }
-    return ss.str();
+    std::string text;
+    OutputSink out(text);
+    write_concentrations(out, concentrations);
+    out.flush();
+    return text;
 }
@@ -12,6 +12,8 @@
 
 //------------- General utilities ----------
 Network read_network(std::string network_filename);
+// parses a network from an open stream (read_network opens "../" + network_filename)
+Network read_network(std::istream &file);
 
 //------------- Part 1 -------------
 // Various helper function to print the datst structures
@@ -29,3 +31,4 @@ std::string to_string(const Concentrations &concentrations);
 //------------- Part 2 -------------
 // helper function to read the concentrations from a file
 Concentrations read_initial_concentrations(const Network &network, std::string initial_concentration_filename);
+Concentrations read_initial_concentrations(const Network &network, std::istream &file);